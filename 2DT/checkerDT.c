@@ -5,6 +5,7 @@
 
 #include <assert.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include "dynarray.h"
 #include "checkerDT.h"
@@ -129,12 +130,13 @@ static boolean CheckerDT_treeCheck(Node_T n, size_t *numNodes) {
    return TRUE;
 }
 
-/* see checkerDT.h for specification */
-boolean CheckerDT_isValid(boolean isInit, Node_T root, size_t count) {
-    size_t numNodes;
-    boolean treeIsValid;
-
-    numNodes = 0;
+/*
+   Returns TRUE if the top-level state of the hierarchy, given by
+   isInit, root and count as for CheckerDT_isValid, is consistent
+   without looking below the root, or FALSE otherwise.
+*/
+static boolean CheckerDT_stateCheck(boolean isInit, Node_T root,
+                                    size_t count) {
     /* Sample check on a top-level data structure invariant:
        if the DT is not initialized, its count should be 0. */
     if (!isInit) {
@@ -169,6 +171,17 @@ boolean CheckerDT_isValid(boolean isInit, Node_T root, size_t count) {
         }
     }
 
+    return TRUE;
+}
+
+/* see checkerDT.h for specification */
+boolean CheckerDT_isValid(boolean isInit, Node_T root, size_t count) {
+    size_t numNodes;
+    boolean treeIsValid;
+
+    numNodes = 0;
+    if (!CheckerDT_stateCheck(isInit, root, count))
+        return FALSE;
 
     /* Now checks invariants recursively at each node from the root. */
     treeIsValid = CheckerDT_treeCheck(root, &numNodes);
@@ -185,3 +198,164 @@ boolean CheckerDT_isValid(boolean isInit, Node_T root, size_t count) {
 
     return TRUE;
 }
+
+/*
+   Walks up from n to the root, checking that each node on the way is
+   valid, is shorter-pathed than the one below it, and holds the one
+   below it as a child where its path sorts. Returns FALSE if a broken
+   invariant is found, including not reaching root, and TRUE
+   otherwise.
+*/
+static boolean CheckerDT_ancestorsCheck(Node_T n, Node_T root) {
+   Node_T parent;
+   size_t id;
+   int found;
+
+   assert(n != NULL);
+
+   while(n != root) {
+      if(!CheckerDT_Node_isValid(n))
+         return FALSE;
+      parent = Node_getParent(n);
+      if(parent == NULL) {
+         fprintf(stderr, "Ancestors of a node do not reach the root\n");
+         return FALSE;
+      }
+      /* paths shorten on the way up, so this walk cannot cycle */
+      if(strlen(Node_getPath(parent)) >= strlen(Node_getPath(n))) {
+         fprintf(stderr, "P's path is not shorter than C's path\n");
+         return FALSE;
+      }
+      found = Node_hasChild(parent, Node_getPath(n), &id);
+      /* if found is -1, there is no memory to check the link with */
+      if(found == 0 || (found == 1 && Node_getChild(parent, id) != n)) {
+         fprintf(stderr, "Node is not a child of its parent\n");
+         return FALSE;
+      }
+      n = parent;
+   }
+
+   return CheckerDT_Node_isValid(n);
+}
+
+/*
+   Checks the children of parent with identifiers id - 1, id and
+   id + 1, those of them that exist: each must be non-NULL and have
+   parent as its parent, and their paths must increase. Returns FALSE
+   if a broken invariant is found and TRUE otherwise.
+*/
+static boolean CheckerDT_siblingsCheck(Node_T parent, size_t id) {
+   Node_T child;
+   Node_T lastChild = NULL;
+   size_t numChildren = Node_getNumChildren(parent);
+   size_t c;
+
+   for(c = (id > 0) ? id - 1 : 0; c <= id + 1 && c < numChildren; c++) {
+      child = Node_getChild(parent, c);
+      if(child == NULL) {
+         fprintf(stderr, "Null Child.\n");
+         return FALSE;
+      }
+      if(Node_getParent(child) != parent) {
+         fprintf(stderr, "Parent of child is not current node.\n");
+         return FALSE;
+      }
+      if(lastChild != NULL &&
+         strcmp(Node_getPath(lastChild), Node_getPath(child)) >= 0) {
+         fprintf(stderr, "Children are not in alphabetical order.\n");
+         return FALSE;
+      }
+      lastChild = child;
+   }
+
+   return TRUE;
+}
+
+/* see checkerDT.h for specification */
+boolean CheckerDT_isValidAround(boolean isInit, Node_T root,
+                                size_t count, Node_T parent,
+                                const char* path, boolean inserted) {
+   const char* ppath;
+   const char* rest;
+   char* childPath;
+   size_t i;
+   size_t id;
+   size_t numNodes = 0;
+   int found;
+   boolean result;
+
+   if(!CheckerDT_stateCheck(isInit, root, count))
+      return FALSE;
+   if(path == NULL)
+      return TRUE;
+
+   /* a new root is a hierarchy of new nodes, so is checked whole */
+   if(parent == NULL) {
+      if(!inserted)
+         return TRUE;
+      if(root == NULL) {
+         fprintf(stderr, "Inserted a root, but root is NULL\n");
+         return FALSE;
+      }
+      i = strlen(Node_getPath(root));
+      if(strncmp(Node_getPath(root), path, i)) {
+         fprintf(stderr, "Root's path is not a prefix of the path\n");
+         return FALSE;
+      }
+      if(!CheckerDT_treeCheck(root, &numNodes))
+         return FALSE;
+      if(numNodes != count) {
+         fprintf(stderr,
+                 "The number of nodes is not equal to the count.\n");
+         return FALSE;
+      }
+      return TRUE;
+   }
+
+   if(!CheckerDT_ancestorsCheck(parent, root))
+      return FALSE;
+
+   /* the changed child of parent is named by the component of path
+      just below parent's path */
+   ppath = Node_getPath(parent);
+   i = strlen(ppath);
+   if(strncmp(path, ppath, i) || path[i] != '/') {
+      fprintf(stderr, "P's path is not a prefix of the path\n");
+      return FALSE;
+   }
+   rest = strchr(path + i + 1, '/');
+   if(rest == NULL)
+      rest = path + strlen(path);
+   childPath = malloc((size_t)(rest - path) + 1);
+   if(childPath == NULL)
+      return TRUE;
+   memcpy(childPath, path, (size_t)(rest - path));
+   childPath[rest - path] = '\0';
+   found = Node_hasChild(parent, childPath, &id);
+   free(childPath);
+   if(found == -1)
+      return TRUE;
+
+   if(!CheckerDT_siblingsCheck(parent, id))
+      return FALSE;
+
+   if(!inserted) {
+      if(found == 1) {
+         fprintf(stderr, "Removed node is still a child of P\n");
+         return FALSE;
+      }
+      return TRUE;
+   }
+   if(found == 0) {
+      fprintf(stderr, "Inserted node is not a child of P\n");
+      return FALSE;
+   }
+
+   /* every node below the inserted child is new */
+   result = CheckerDT_treeCheck(Node_getChild(parent, id), &numNodes);
+   if(numNodes > count) {
+      fprintf(stderr, "There are more new nodes than the count.\n");
+      return FALSE;
+   }
+   return result;
+}
@@ -24,4 +24,24 @@ boolean CheckerDT_Node_isValid(Node_T n);
 */
 boolean CheckerDT_isValid(boolean isInit, Node_T root, size_t count);
 
+/*
+   Returns TRUE if the hierarchy is in a valid state around the node
+   with path path, which the last operation inserted (if inserted is
+   TRUE) or removed (if FALSE) along with its descendants, as a child
+   of parent, or as the root if parent is NULL, or FALSE otherwise.
+   If path is NULL, the last operation changed nothing.
+
+   Unlike CheckerDT_isValid, checks only what the operation could
+   have broken, in time proportional to the depth of parent and the
+   number of nodes inserted: the top-level state, parent and its
+   ancestors, the order of the children of parent on either side of
+   where path was inserted or removed, and the inserted nodes.  So it
+   cannot confirm that count is the number of nodes in the hierarchy,
+   and a full check with CheckerDT_isValid should still be made from
+   time to time.
+*/
+boolean CheckerDT_isValidAround(boolean isInit, Node_T root,
+                                size_t count, Node_T parent,
+                                const char* path, boolean inserted);
+
 #endif
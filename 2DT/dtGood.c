@@ -22,6 +22,31 @@ static Node_T root;
 /* a counter of the number of nodes in the hierarchy */
 static size_t count;
 
+#ifndef NDEBUG
+
+/* The number of checks between full checks of the hierarchy. */
+enum { DT_FULL_CHECK_PERIOD = 1024 };
+
+/* the number of checks made so far, for checking only */
+static size_t checks;
+
+/*
+   Returns TRUE if the hierarchy is valid around the node with path
+   path that the last operation inserted (if inserted is TRUE) or
+   removed (if FALSE) as a child of parent, as CheckerDT_isValidAround
+   determines, or FALSE otherwise. Every DT_FULL_CHECK_PERIOD calls,
+   starting with the first, checks the whole hierarchy instead.
+*/
+static boolean DT_isValid(Node_T parent, const char* path,
+                          boolean inserted) {
+   if(checks++ % DT_FULL_CHECK_PERIOD == 0)
+      return CheckerDT_isValid(isInitialized, root, count);
+   return CheckerDT_isValidAround(isInitialized, root, count,
+                                  parent, path, inserted);
+}
+
+#endif
+
 /*
    Starting at the parameter curr, traverses as far down
    the hierarchy as possible while still matching the path
@@ -189,14 +214,14 @@ int DT_insertPath(char* path) {
    Node_T curr;
    int result;
 
-   assert(CheckerDT_isValid(isInitialized,root,count));
+   assert(DT_isValid(NULL, NULL, FALSE));
    assert(path != NULL);
 
    if(!isInitialized)
       return INITIALIZATION_ERROR;
    curr = DT_traversePath(path);
    result = DT_insertRestOfPath(path, curr);
-   assert(CheckerDT_isValid(isInitialized,root,count));
+   assert(DT_isValid(curr, result == SUCCESS ? path : NULL, TRUE));
    return result;
 }
 
@@ -205,7 +230,7 @@ boolean DT_containsPath(char* path) {
    Node_T curr;
    boolean result;
 
-   assert(CheckerDT_isValid(isInitialized,root,count));
+   assert(DT_isValid(NULL, NULL, FALSE));
    assert(path != NULL);
 
    if(!isInitialized)
@@ -221,7 +246,7 @@ boolean DT_containsPath(char* path) {
    else
       result = TRUE;
 
-   assert(CheckerDT_isValid(isInitialized,root,count));
+   assert(DT_isValid(NULL, NULL, FALSE));
    return result;
 }
 
@@ -259,9 +284,10 @@ static int DT_rmPathAt(char* path, Node_T curr) {
 /* see bdt.h for specification */
 int DT_rmPath(char* path) {
    Node_T curr;
+   Node_T parent = NULL;
    int result;
 
-   assert(CheckerDT_isValid(isInitialized,root,count));
+   assert(DT_isValid(NULL, NULL, FALSE));
    assert(path != NULL);
 
    if(!isInitialized)
@@ -270,35 +296,38 @@ int DT_rmPath(char* path) {
    curr = DT_traversePath(path);
    if(curr == NULL)
       result =  NO_SUCH_PATH;
-   else
+   else {
+      parent = Node_getParent(curr);
       result = DT_rmPathAt(path, curr);
+   }
 
-   assert(CheckerDT_isValid(isInitialized,root,count));
+   assert(DT_isValid(parent, result == SUCCESS ? path : NULL, FALSE));
+   (void) parent;
    return result;
 }
 
 
 /* see dt.h for specification */
 int DT_init(void) {
-   assert(CheckerDT_isValid(isInitialized,root,count));
+   assert(DT_isValid(NULL, NULL, FALSE));
    if(isInitialized)
       return INITIALIZATION_ERROR;
    isInitialized = 1;
    root = NULL;
    count = 0;
-   assert(CheckerDT_isValid(isInitialized,root,count));
+   assert(DT_isValid(NULL, NULL, FALSE));
    return SUCCESS;
 }
 
 /* see dt.h for specification */
 int DT_destroy(void) {
-   assert(CheckerDT_isValid(isInitialized,root,count));
+   assert(DT_isValid(NULL, NULL, FALSE));
    if(!isInitialized)
       return INITIALIZATION_ERROR;
    DT_removePathFrom(root);
    root = NULL;
    isInitialized = 0;
-   assert(CheckerDT_isValid(isInitialized,root,count));
+   assert(DT_isValid(NULL, NULL, FALSE));
    return SUCCESS;
 }
 
@@ -352,7 +381,7 @@ char* DT_toString(void) {
    size_t totalStrlen = 1;
    char* result = NULL;
 
-   assert(CheckerDT_isValid(isInitialized,root,count));
+   assert(DT_isValid(NULL, NULL, FALSE));
 
    if(!isInitialized)
       return NULL;
@@ -365,7 +394,7 @@ char* DT_toString(void) {
    result = malloc(totalStrlen);
    if(result == NULL) {
       DynArray_free(nodes);
-      assert(CheckerDT_isValid(isInitialized,root,count));
+      assert(DT_isValid(NULL, NULL, FALSE));
       return NULL;
    }
    *result = '\0';
@@ -373,6 +402,6 @@ char* DT_toString(void) {
    DynArray_map(nodes, (void (*)(void *, void*)) DT_strcatAccumulate, (void *) result);
 
    DynArray_free(nodes);
-   assert(CheckerDT_isValid(isInitialized,root,count));
+   assert(DT_isValid(NULL, NULL, FALSE));
    return result;
 }
@@ -0,0 +1,397 @@
+/*--------------------------------------------------------------------*/
+/* allocator.c                                                        */
+/* Author: Alina Chen and Nickolas Casalinuovo                        */
+/*--------------------------------------------------------------------*/
+
+#include "allocator.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*--------------------------------------------------------------------*/
+
+/* The alignment of every block a BumpAllocator hands out, that of
+   malloc on the platforms this is built for. */
+
+enum { BUMP_ALIGN = 16 };
+
+/* The default number of bytes a BumpAllocator takes from malloc at
+   a time. */
+
+enum { BUMP_BLOCK_SIZE = 1 << 20 };
+
+/*--------------------------------------------------------------------*/
+
+/* A CountingAllocator consists of its Allocator, the Allocator it
+   passes requests on to, and its counters. */
+
+struct CountingAllocator
+{
+   /* The Allocator whose context is this CountingAllocator. */
+   struct Allocator sAllocator;
+
+   /* The Allocator that supplies the memory. */
+   const struct Allocator *psBase;
+
+   /* The counters reported by CountingAllocator_getCounts. */
+   struct AllocatorCounts sCounts;
+};
+
+/* A block of memory taken from malloc by a BumpAllocator.  Its
+   bytes follow it, starting BUMP_HEADER bytes from its start. */
+
+struct BumpBlock
+{
+   /* The block taken before this one, or NULL if there is none. */
+   struct BumpBlock *psNext;
+};
+
+/* The bytes before the memory of a BumpBlock, enough to hold it and
+   keep that memory aligned. */
+
+enum { BUMP_HEADER = (sizeof(struct BumpBlock) + BUMP_ALIGN - 1)
+                     / BUMP_ALIGN * BUMP_ALIGN };
+
+/* A BumpAllocator consists of its Allocator, a list of the blocks
+   it took from malloc, and the unused end of the block it is handing
+   out memory from. */
+
+struct BumpAllocator
+{
+   /* The Allocator whose context is this BumpAllocator. */
+   struct Allocator sAllocator;
+
+   /* The number of bytes taken from malloc for a shared block. */
+   size_t uBlockSize;
+
+   /* The blocks taken from malloc, most recent first. */
+   struct BumpBlock *psBlocks;
+
+   /* The next free byte of the current shared block, and its end,
+      or NULL if there is none yet. */
+   char *pcNext;
+   char *pcEnd;
+
+   /* The memory last handed out from the current shared block, or
+      NULL if it has been freed or there is none. */
+   char *pcLast;
+
+   /* The number of bytes taken from malloc. */
+   size_t uBytes;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Return a block of uSize bytes from malloc.  pvContext is unused. */
+
+static void *Allocator_heapAlloc(void *pvContext, size_t uSize)
+{
+   (void)pvContext;
+   return malloc(uSize);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Resize the block pvBlock from malloc to uNewSize bytes.  pvContext
+   and uOldSize are unused. */
+
+static void *Allocator_heapRealloc(void *pvContext, void *pvBlock,
+                                   size_t uOldSize, size_t uNewSize)
+{
+   (void)pvContext;
+   (void)uOldSize;
+   return realloc(pvBlock, uNewSize);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Free the block pvBlock from malloc.  pvContext and uSize are
+   unused. */
+
+static void Allocator_heapFree(void *pvContext, void *pvBlock,
+                               size_t uSize)
+{
+   (void)pvContext;
+   (void)uSize;
+   free(pvBlock);
+}
+
+const struct Allocator Allocator_heap =
+{
+   Allocator_heapAlloc, Allocator_heapRealloc, Allocator_heapFree,
+   NULL
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Note that the CountingAllocator pvContext now holds uAdded more
+   bytes, updating its peak. */
+
+static void CountingAllocator_add(void *pvContext, size_t uAdded)
+{
+   struct AllocatorCounts *psCounts;
+
+   psCounts = &((struct CountingAllocator*)pvContext)->sCounts;
+   psCounts->uBytes += uAdded;
+   if (psCounts->uBytes > psCounts->uPeakBytes)
+      psCounts->uPeakBytes = psCounts->uBytes;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return a block of uSize bytes from the base of the
+   CountingAllocator pvContext, counting it. */
+
+static void *CountingAllocator_alloc(void *pvContext, size_t uSize)
+{
+   struct CountingAllocator *psCounting = pvContext;
+   void *pvBlock;
+
+   pvBlock = Allocator_alloc(psCounting->psBase, uSize);
+   if (pvBlock == NULL)
+      return NULL;
+   psCounting->sCounts.uAllocs++;
+   CountingAllocator_add(pvContext, uSize);
+   return pvBlock;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Resize the block pvBlock from the base of the CountingAllocator
+   pvContext from uOldSize to uNewSize bytes, counting it. */
+
+static void *CountingAllocator_realloc(void *pvContext, void *pvBlock,
+                                       size_t uOldSize, size_t uNewSize)
+{
+   struct CountingAllocator *psCounting = pvContext;
+
+   pvBlock = Allocator_realloc(psCounting->psBase, pvBlock, uOldSize,
+                               uNewSize);
+   if (pvBlock == NULL)
+      return NULL;
+   psCounting->sCounts.uReallocs++;
+   psCounting->sCounts.uBytes -= uOldSize;
+   CountingAllocator_add(pvContext, uNewSize);
+   return pvBlock;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the block pvBlock of uSize bytes to the base of the
+   CountingAllocator pvContext, counting it. */
+
+static void CountingAllocator_release(void *pvContext, void *pvBlock,
+                                      size_t uSize)
+{
+   struct CountingAllocator *psCounting = pvContext;
+
+   Allocator_free(psCounting->psBase, pvBlock, uSize);
+   psCounting->sCounts.uFrees++;
+   psCounting->sCounts.uBytes -= uSize;
+}
+
+/*--------------------------------------------------------------------*/
+
+CountingAllocator_T CountingAllocator_new(
+   const struct Allocator *psBase)
+{
+   CountingAllocator_T oCounting;
+
+   assert(psBase != NULL);
+
+   oCounting = (struct CountingAllocator*)
+      calloc(1, sizeof(struct CountingAllocator));
+   if (oCounting == NULL)
+      return NULL;
+
+   oCounting->sAllocator.pfAlloc = CountingAllocator_alloc;
+   oCounting->sAllocator.pfRealloc = CountingAllocator_realloc;
+   oCounting->sAllocator.pfFree = CountingAllocator_release;
+   oCounting->sAllocator.pvContext = oCounting;
+   oCounting->psBase = psBase;
+   return oCounting;
+}
+
+/*--------------------------------------------------------------------*/
+
+void CountingAllocator_free(CountingAllocator_T oCounting)
+{
+   assert(oCounting != NULL);
+
+   free(oCounting);
+}
+
+/*--------------------------------------------------------------------*/
+
+const struct Allocator *CountingAllocator_get(
+   CountingAllocator_T oCounting)
+{
+   assert(oCounting != NULL);
+
+   return &oCounting->sAllocator;
+}
+
+/*--------------------------------------------------------------------*/
+
+void CountingAllocator_getCounts(CountingAllocator_T oCounting,
+                                 struct AllocatorCounts *psCounts)
+{
+   assert(oCounting != NULL);
+   assert(psCounts != NULL);
+
+   *psCounts = oCounting->sCounts;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Take a block of uSize bytes from malloc for oBump and return its
+   memory, or NULL if insufficient memory is available. */
+
+static char *BumpAllocator_takeBlock(BumpAllocator_T oBump,
+                                     size_t uSize)
+{
+   struct BumpBlock *psBlock;
+
+   psBlock = (struct BumpBlock*)malloc(BUMP_HEADER + uSize);
+   if (psBlock == NULL)
+      return NULL;
+   psBlock->psNext = oBump->psBlocks;
+   oBump->psBlocks = psBlock;
+   oBump->uBytes += BUMP_HEADER + uSize;
+   return (char*)psBlock + BUMP_HEADER;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return uSize bytes from the BumpAllocator pvContext. */
+
+static void *BumpAllocator_alloc(void *pvContext, size_t uSize)
+{
+   BumpAllocator_T oBump = pvContext;
+   char *pcBlock;
+
+   uSize = (uSize + BUMP_ALIGN - 1) / BUMP_ALIGN * BUMP_ALIGN;
+
+   if (oBump->pcNext == NULL
+       || uSize > (size_t)(oBump->pcEnd - oBump->pcNext))
+   {
+      /* a large request would waste most of a shared block */
+      if (uSize > oBump->uBlockSize / 4)
+         return BumpAllocator_takeBlock(oBump, uSize);
+
+      pcBlock = BumpAllocator_takeBlock(oBump, oBump->uBlockSize);
+      if (pcBlock == NULL)
+         return NULL;
+      oBump->pcNext = pcBlock;
+      oBump->pcEnd = pcBlock + oBump->uBlockSize;
+   }
+
+   oBump->pcLast = oBump->pcNext;
+   oBump->pcNext += uSize;
+   return oBump->pcLast;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Resize the block pvBlock of uOldSize bytes from the BumpAllocator
+   pvContext to uNewSize bytes: in place if it was the last handed
+   out and still fits, or else by copying it to a new block and
+   abandoning the old one. */
+
+static void *BumpAllocator_realloc(void *pvContext, void *pvBlock,
+                                   size_t uOldSize, size_t uNewSize)
+{
+   BumpAllocator_T oBump = pvContext;
+   size_t uRounded;
+   void *pvNew;
+
+   uRounded = (uNewSize + BUMP_ALIGN - 1) / BUMP_ALIGN * BUMP_ALIGN;
+   if (pvBlock != NULL && pvBlock == oBump->pcLast
+       && uRounded <= (size_t)(oBump->pcEnd - oBump->pcLast))
+   {
+      oBump->pcNext = oBump->pcLast + uRounded;
+      return pvBlock;
+   }
+
+   pvNew = BumpAllocator_alloc(pvContext, uNewSize);
+   if (pvNew == NULL)
+      return NULL;
+   if (pvBlock != NULL)
+      memcpy(pvNew, pvBlock, uOldSize < uNewSize ? uOldSize : uNewSize);
+   return pvNew;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the block pvBlock of the BumpAllocator pvContext, which
+   reuses it only if it was the last handed out.  uSize is unused. */
+
+static void BumpAllocator_release(void *pvContext, void *pvBlock,
+                                  size_t uSize)
+{
+   BumpAllocator_T oBump = pvContext;
+
+   (void)uSize;
+   if (pvBlock == oBump->pcLast)
+   {
+      oBump->pcNext = oBump->pcLast;
+      oBump->pcLast = NULL;
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+BumpAllocator_T BumpAllocator_new(size_t uBlockSize)
+{
+   BumpAllocator_T oBump;
+
+   oBump = (struct BumpAllocator*)
+      calloc(1, sizeof(struct BumpAllocator));
+   if (oBump == NULL)
+      return NULL;
+
+   if (uBlockSize == 0)
+      uBlockSize = BUMP_BLOCK_SIZE;
+   oBump->uBlockSize =
+      (uBlockSize + BUMP_ALIGN - 1) / BUMP_ALIGN * BUMP_ALIGN;
+   oBump->sAllocator.pfAlloc = BumpAllocator_alloc;
+   oBump->sAllocator.pfRealloc = BumpAllocator_realloc;
+   oBump->sAllocator.pfFree = BumpAllocator_release;
+   oBump->sAllocator.pvContext = oBump;
+   return oBump;
+}
+
+/*--------------------------------------------------------------------*/
+
+void BumpAllocator_free(BumpAllocator_T oBump)
+{
+   struct BumpBlock *psBlock;
+
+   assert(oBump != NULL);
+
+   while (oBump->psBlocks != NULL)
+   {
+      psBlock = oBump->psBlocks;
+      oBump->psBlocks = psBlock->psNext;
+      free(psBlock);
+   }
+   free(oBump);
+}
+
+/*--------------------------------------------------------------------*/
+
+const struct Allocator *BumpAllocator_get(BumpAllocator_T oBump)
+{
+   assert(oBump != NULL);
+
+   return &oBump->sAllocator;
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t BumpAllocator_getBytes(BumpAllocator_T oBump)
+{
+   assert(oBump != NULL);
+
+   return oBump->uBytes;
+}
@@ -0,0 +1,163 @@
+/*--------------------------------------------------------------------*/
+/* allocator.h                                                        */
+/* Author: Alina Chen and Nickolas Casalinuovo                        */
+/*--------------------------------------------------------------------*/
+
+#ifndef ALLOCATOR_INCLUDED
+#define ALLOCATOR_INCLUDED
+
+#include <stddef.h>
+
+/* An Allocator is a source of memory: three functions that behave as
+   malloc, realloc and free do, each passed pvContext first.  The
+   caller always knows the size of a block, so pfRealloc is passed
+   the old size as well as the new, and pfFree the size of the block
+   being freed, which lets an allocator keep no header per block.
+   pfAlloc and pfRealloc return NULL if insufficient memory is
+   available, leaving any old block unchanged; every block they
+   return is aligned for any type, and uSize is never 0. */
+
+struct Allocator
+{
+   void *(*pfAlloc)(void *pvContext, size_t uSize);
+   void *(*pfRealloc)(void *pvContext, void *pvBlock, size_t uOldSize,
+                      size_t uNewSize);
+   void (*pfFree)(void *pvContext, void *pvBlock, size_t uSize);
+   void *pvContext;
+};
+
+/* The counters kept by a CountingAllocator_T object. */
+
+struct AllocatorCounts
+{
+   /* The number of blocks allocated. */
+   size_t uAllocs;
+
+   /* The number of blocks resized. */
+   size_t uReallocs;
+
+   /* The number of blocks freed. */
+   size_t uFrees;
+
+   /* The number of bytes in blocks currently allocated. */
+   size_t uBytes;
+
+   /* The most bytes that were ever allocated at once. */
+   size_t uPeakBytes;
+};
+
+/* A CountingAllocator_T object passes each request on to another
+   Allocator, counting the blocks and bytes that go through it. */
+
+typedef struct CountingAllocator *CountingAllocator_T;
+
+/* A BumpAllocator_T object hands out memory from large blocks,
+   front to back, for structures built once and then only read: a
+   request costs a few instructions and no header, and freeing
+   returns memory only if it was the last handed out.  All of it is
+   released at once by BumpAllocator_free. */
+
+typedef struct BumpAllocator *BumpAllocator_T;
+
+/*--------------------------------------------------------------------*/
+
+/* The Allocator of malloc, realloc and free. */
+
+extern const struct Allocator Allocator_heap;
+
+/*--------------------------------------------------------------------*/
+
+/* Return a block of uSize bytes from psAllocator, or NULL if
+   insufficient memory is available. */
+
+static inline void *Allocator_alloc(const struct Allocator *psAllocator,
+                                    size_t uSize)
+{
+   return psAllocator->pfAlloc(psAllocator->pvContext, uSize);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Resize the block pvBlock of uOldSize bytes from psAllocator to
+   uNewSize bytes, as realloc does.  Return the resized block, or
+   NULL if insufficient memory is available. */
+
+static inline void *Allocator_realloc(
+   const struct Allocator *psAllocator, void *pvBlock, size_t uOldSize,
+   size_t uNewSize)
+{
+   return psAllocator->pfRealloc(psAllocator->pvContext, pvBlock,
+                                 uOldSize, uNewSize);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the block pvBlock of uSize bytes to psAllocator.  Do nothing
+   if pvBlock is NULL. */
+
+static inline void Allocator_free(const struct Allocator *psAllocator,
+                                  void *pvBlock, size_t uSize)
+{
+   if (pvBlock != NULL)
+      psAllocator->pfFree(psAllocator->pvContext, pvBlock, uSize);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return a new CountingAllocator_T object that takes its memory from
+   psBase, with all counters 0, or NULL if insufficient memory is
+   available. */
+
+CountingAllocator_T CountingAllocator_new(
+   const struct Allocator *psBase);
+
+/*--------------------------------------------------------------------*/
+
+/* Free oCounting.  Blocks it handed out belong to its base, and are
+   not freed. */
+
+void CountingAllocator_free(CountingAllocator_T oCounting);
+
+/*--------------------------------------------------------------------*/
+
+/* Return the Allocator of oCounting, valid until oCounting is
+   freed. */
+
+const struct Allocator *CountingAllocator_get(
+   CountingAllocator_T oCounting);
+
+/*--------------------------------------------------------------------*/
+
+/* Assign the counters of oCounting to *psCounts. */
+
+void CountingAllocator_getCounts(CountingAllocator_T oCounting,
+                                 struct AllocatorCounts *psCounts);
+
+/*--------------------------------------------------------------------*/
+
+/* Return a new BumpAllocator_T object that takes memory from malloc
+   uBlockSize bytes at a time, or a default amount if uBlockSize is
+   0, or NULL if insufficient memory is available.  A request larger
+   than a quarter of a block gets a block of its own. */
+
+BumpAllocator_T BumpAllocator_new(size_t uBlockSize);
+
+/*--------------------------------------------------------------------*/
+
+/* Free oBump and every block it handed out. */
+
+void BumpAllocator_free(BumpAllocator_T oBump);
+
+/*--------------------------------------------------------------------*/
+
+/* Return the Allocator of oBump, valid until oBump is freed. */
+
+const struct Allocator *BumpAllocator_get(BumpAllocator_T oBump);
+
+/*--------------------------------------------------------------------*/
+
+/* Return the number of bytes oBump has taken from malloc. */
+
+size_t BumpAllocator_getBytes(BumpAllocator_T oBump);
+
+#endif
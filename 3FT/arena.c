@@ -0,0 +1,292 @@
+/*--------------------------------------------------------------------*/
+/* arena.c                                                            */
+/* Author: Alina Chen and Nickolas Casalinuovo                        */
+/*--------------------------------------------------------------------*/
+
+/* for MAP_ANONYMOUS, MAP_NORESERVE, MAP_HUGETLB and madvise */
+#define _DEFAULT_SOURCE 1
+
+#include "arena.h"
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+/*--------------------------------------------------------------------*/
+
+/* The alignment of every block, that of malloc on the platforms
+   this is built for.  Blocks of up to SMALL_MAX bytes are rounded up
+   to a multiple of it, each multiple a size class; larger blocks are
+   rounded up to a power of 2, each power a size class. */
+
+enum { ARENA_ALIGN = 16, SMALL_MAX = 1024 };
+
+/* The number of size classes of small blocks, and of all blocks. */
+
+enum { SMALL_CLASSES = SMALL_MAX / ARENA_ALIGN,
+       CLASSES = SMALL_CLASSES + 64 };
+
+/* The size of a huge page, to which the region is aligned. */
+
+enum { HUGE_PAGE = 2 * 1024 * 1024 };
+
+/* The default size of the region, halved until it can be reserved.
+   Reserving address space commits no memory. */
+
+static const size_t DEFAULT_RESERVE = (size_t)1 << 34;
+
+/*--------------------------------------------------------------------*/
+
+/* An Arena consists of its Allocator, its region, the part of the
+   region not yet handed out, and a list of freed blocks for each
+   size class, linked through their first bytes. */
+
+struct Arena
+{
+   /* The Allocator whose context is this Arena. */
+   struct Allocator sAllocator;
+
+   /* The region, and its size in bytes. */
+   char *pcBase;
+   size_t uReserved;
+
+   /* The first byte of the region not yet handed out. */
+   char *pcNext;
+
+   /* How the region is backed. */
+   enum ArenaBacking eBacking;
+
+   /* The number of bytes in freed blocks. */
+   size_t uFree;
+
+   /* The first freed block of each size class, or NULL if there is
+      none. */
+   void *apvFree[CLASSES];
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Return the size class of a block of uSize bytes, and assign the
+   size of the blocks of that class to *puRounded. */
+
+static size_t Arena_classOf(size_t uSize, size_t *puRounded)
+{
+   size_t uClass;
+   size_t uRounded;
+
+   if (uSize <= SMALL_MAX)
+   {
+      uClass = (uSize + ARENA_ALIGN - 1) / ARENA_ALIGN;
+      if (uClass == 0)
+         uClass = 1;
+      *puRounded = uClass * ARENA_ALIGN;
+      return uClass - 1;
+   }
+
+   uClass = SMALL_CLASSES;
+   for (uRounded = 2 * SMALL_MAX; uRounded < uSize; uRounded *= 2)
+      uClass++;
+   *puRounded = uRounded;
+   return uClass;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return a block of uSize bytes from the Arena pvContext: a freed
+   block of its size class if there is one, or else the next unused
+   bytes of the region, or NULL if the region is used up. */
+
+static void *Arena_alloc(void *pvContext, size_t uSize)
+{
+   Arena_T oArena = pvContext;
+   size_t uClass;
+   size_t uRounded;
+   void *pvBlock;
+
+   if (uSize > oArena->uReserved)
+      return NULL;
+
+   uClass = Arena_classOf(uSize, &uRounded);
+   pvBlock = oArena->apvFree[uClass];
+   if (pvBlock != NULL)
+   {
+      memcpy(&oArena->apvFree[uClass], pvBlock, sizeof(void*));
+      oArena->uFree -= uRounded;
+      return pvBlock;
+   }
+
+   if (uRounded > (size_t)(oArena->pcBase + oArena->uReserved
+                           - oArena->pcNext))
+      return NULL;
+   pvBlock = oArena->pcNext;
+   oArena->pcNext += uRounded;
+   return pvBlock;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the block pvBlock of uSize bytes to the list of its size
+   class in the Arena pvContext. */
+
+static void Arena_release(void *pvContext, void *pvBlock,
+                          size_t uSize)
+{
+   Arena_T oArena = pvContext;
+   size_t uClass;
+   size_t uRounded;
+
+   uClass = Arena_classOf(uSize, &uRounded);
+   memcpy(pvBlock, &oArena->apvFree[uClass], sizeof(void*));
+   oArena->apvFree[uClass] = pvBlock;
+   oArena->uFree += uRounded;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Resize the block pvBlock of uOldSize bytes from the Arena pvContext
+   to uNewSize bytes: in place if both sizes are of one size class,
+   or else by moving it to a block of the new size. */
+
+static void *Arena_realloc(void *pvContext, void *pvBlock,
+                           size_t uOldSize, size_t uNewSize)
+{
+   size_t uOldRounded;
+   size_t uNewRounded;
+   void *pvNew;
+
+   if (pvBlock == NULL)
+      return Arena_alloc(pvContext, uNewSize);
+
+   (void)Arena_classOf(uOldSize, &uOldRounded);
+   (void)Arena_classOf(uNewSize, &uNewRounded);
+   if (uOldRounded == uNewRounded)
+      return pvBlock;
+
+   pvNew = Arena_alloc(pvContext, uNewSize);
+   if (pvNew == NULL)
+      return NULL;
+   memcpy(pvNew, pvBlock, uOldSize < uNewSize ? uOldSize : uNewSize);
+   Arena_release(pvContext, pvBlock, uOldSize);
+   return pvNew;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Reserve a region of uSize bytes of ordinary memory, a multiple of
+   HUGE_PAGE, aligned to HUGE_PAGE so that every huge page of it can
+   be backed by one.  Return the region, or NULL if it cannot be
+   reserved. */
+
+static char *Arena_reserve(size_t uSize)
+{
+   char *pcMap;
+   char *pcBase;
+   size_t uHead;
+
+   pcMap = mmap(NULL, uSize + HUGE_PAGE, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+   if (pcMap == MAP_FAILED)
+      return NULL;
+
+   pcBase = (char*)(((uintptr_t)pcMap + HUGE_PAGE - 1)
+                    & ~(uintptr_t)(HUGE_PAGE - 1));
+   uHead = (size_t)(pcBase - pcMap);
+   if (uHead > 0)
+      (void)munmap(pcMap, uHead);
+   (void)munmap(pcBase + uSize, HUGE_PAGE - uHead);
+   return pcBase;
+}
+
+/*--------------------------------------------------------------------*/
+
+Arena_T Arena_new(size_t uReserve, int bHugeTlb)
+{
+   Arena_T oArena;
+   char *pcBase = NULL;
+   int bDefault = (uReserve == 0);
+
+   oArena = (struct Arena*)calloc(1, sizeof(struct Arena));
+   if (oArena == NULL)
+      return NULL;
+
+   if (bDefault)
+      uReserve = DEFAULT_RESERVE;
+   uReserve = (uReserve + HUGE_PAGE - 1) / HUGE_PAGE * HUGE_PAGE;
+
+#ifdef MAP_HUGETLB
+   if (bHugeTlb)
+   {
+      /* the pool's pages are reserved now, or the mapping fails */
+      pcBase = mmap(NULL, uReserve, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+      if (pcBase == MAP_FAILED)
+         pcBase = NULL;
+      else
+         oArena->eBacking = ARENA_HUGETLB;
+   }
+#else
+   (void)bHugeTlb;
+#endif
+
+   if (pcBase == NULL)
+   {
+      pcBase = Arena_reserve(uReserve);
+      while (pcBase == NULL && bDefault && uReserve > HUGE_PAGE)
+      {
+         uReserve /= 2;
+         pcBase = Arena_reserve(uReserve);
+      }
+      if (pcBase == NULL)
+      {
+         free(oArena);
+         return NULL;
+      }
+      oArena->eBacking = ARENA_PLAIN;
+#ifdef MADV_HUGEPAGE
+      if (madvise(pcBase, uReserve, MADV_HUGEPAGE) == 0)
+         oArena->eBacking = ARENA_TRANSPARENT;
+#endif
+   }
+
+   oArena->pcBase = pcBase;
+   oArena->uReserved = uReserve;
+   oArena->pcNext = pcBase;
+   oArena->sAllocator.pfAlloc = Arena_alloc;
+   oArena->sAllocator.pfRealloc = Arena_realloc;
+   oArena->sAllocator.pfFree = Arena_release;
+   oArena->sAllocator.pvContext = oArena;
+   return oArena;
+}
+
+/*--------------------------------------------------------------------*/
+
+void Arena_free(Arena_T oArena)
+{
+   assert(oArena != NULL);
+
+   (void)munmap(oArena->pcBase, oArena->uReserved);
+   free(oArena);
+}
+
+/*--------------------------------------------------------------------*/
+
+const struct Allocator *Arena_get(Arena_T oArena)
+{
+   assert(oArena != NULL);
+
+   return &oArena->sAllocator;
+}
+
+/*--------------------------------------------------------------------*/
+
+void Arena_getStats(Arena_T oArena, struct ArenaStats *psStats)
+{
+   assert(oArena != NULL);
+   assert(psStats != NULL);
+
+   psStats->eBacking = oArena->eBacking;
+   psStats->uReserved = oArena->uReserved;
+   psStats->uUsed = (size_t)(oArena->pcNext - oArena->pcBase);
+   psStats->uFree = oArena->uFree;
+}
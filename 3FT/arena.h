@@ -0,0 +1,85 @@
+/*--------------------------------------------------------------------*/
+/* arena.h                                                            */
+/* Author: Alina Chen and Nickolas Casalinuovo                        */
+/*--------------------------------------------------------------------*/
+
+#ifndef ARENA_INCLUDED
+#define ARENA_INCLUDED
+
+#include <stddef.h>
+#include "allocator.h"
+
+/* An Arena_T object is an Allocator (see allocator.h) over one large
+   region of address space, reserved up front and backed by huge
+   pages where the system allows, so that a tree placed in it spans
+   few pages and its lookups miss the TLB less often.  Blocks are
+   handed out front to back; a freed block is kept on a list of
+   blocks of its size and reused for the next request of that size.
+   Memory goes back to the system only when the arena is freed. */
+
+typedef struct Arena *Arena_T;
+
+/* The ways an Arena_T object's region can be backed. */
+
+enum ArenaBacking
+{
+   /* Pages reserved in the hugetlbfs pool (MAP_HUGETLB). */
+   ARENA_HUGETLB,
+
+   /* Ordinary pages, which the kernel is asked to back with
+      transparent huge pages (MADV_HUGEPAGE). */
+   ARENA_TRANSPARENT,
+
+   /* Ordinary pages, as the system has no huge pages to offer. */
+   ARENA_PLAIN
+};
+
+/* The state of an Arena_T object. */
+
+struct ArenaStats
+{
+   /* How the region is backed. */
+   enum ArenaBacking eBacking;
+
+   /* The number of bytes reserved. */
+   size_t uReserved;
+
+   /* The number of bytes handed out at least once. */
+   size_t uUsed;
+
+   /* The number of bytes in freed blocks waiting to be reused. */
+   size_t uFree;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Return a new Arena_T object over a region of about uReserve bytes,
+   or a default size if uReserve is 0, or NULL if no region can be
+   reserved.  If bHugeTlb is 1 (TRUE), the region is first sought in
+   the hugetlbfs pool, which must hold enough pages for all of it;
+   otherwise, or if that fails, it is reserved from ordinary memory,
+   without committing it, and advised to use transparent huge
+   pages. */
+
+Arena_T Arena_new(size_t uReserve, int bHugeTlb);
+
+/*--------------------------------------------------------------------*/
+
+/* Free oArena, returning its whole region, and so every block it
+   handed out, to the system. */
+
+void Arena_free(Arena_T oArena);
+
+/*--------------------------------------------------------------------*/
+
+/* Return the Allocator of oArena, valid until oArena is freed. */
+
+const struct Allocator *Arena_get(Arena_T oArena);
+
+/*--------------------------------------------------------------------*/
+
+/* Assign the state of oArena to *psStats. */
+
+void Arena_getStats(Arena_T oArena, struct ArenaStats *psStats);
+
+#endif
@@ -0,0 +1,235 @@
+/*--------------------------------------------------------------------*/
+/* bloom.c                                                            */
+/* Author: Alina Chen and Nickolas Casalinuovo                        */
+/*--------------------------------------------------------------------*/
+
+#include "bloom.h"
+#include <assert.h>
+#include <limits.h>
+#include <stdlib.h>
+
+/*--------------------------------------------------------------------*/
+
+/* The number of counters per expected string, and the number of
+   counters each string sets.  Together they give a false-positive
+   rate of about 1% while the filter holds no more strings than it
+   was sized for. */
+
+enum { COUNTERS_PER_KEY = 10, HASHES = 7 };
+
+/*--------------------------------------------------------------------*/
+
+/* A Bloom consists of an array of saturating counters, along with
+   the number of strings it holds and the number of its counters that
+   are not zero. */
+
+struct Bloom
+{
+   /* The number of strings the Bloom was sized for. */
+   size_t uCapacity;
+
+   /* The number of strings in the Bloom. */
+   size_t uCount;
+
+   /* The number of counters, a power of 2. */
+   size_t uCounters;
+
+   /* The number of counters that are not zero. */
+   size_t uNonZero;
+
+   /* The counters.  A counter that reaches UCHAR_MAX stays there, as
+      it can no longer tell how many strings set it. */
+   unsigned char *pucCounters;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Compute two independent hashes of string pcKey, assigning them to
+   *puHash1 and *puHash2.  *puHash2 is odd, so that stepping by it
+   visits distinct counters. */
+
+static void Bloom_hash(const char *pcKey, size_t *puHash1,
+                       size_t *puHash2)
+{
+   size_t uHash1 = (size_t)2166136261U;
+   size_t uHash2 = 5381;
+
+   assert(pcKey != NULL);
+   assert(puHash1 != NULL);
+   assert(puHash2 != NULL);
+
+   while (*pcKey != '\0')
+   {
+      uHash1 = (uHash1 ^ (unsigned char)*pcKey) * (size_t)16777619U;
+      uHash2 = uHash2 * 33 + (unsigned char)*pcKey;
+      pcKey++;
+   }
+   *puHash1 = uHash1;
+   *puHash2 = uHash2 | 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+Bloom_T Bloom_new(size_t uExpected)
+{
+   Bloom_T oBloom;
+   size_t uCounters = 64;
+
+   while (uCounters < uExpected * COUNTERS_PER_KEY)
+      uCounters *= 2;
+
+   oBloom = (struct Bloom*)malloc(sizeof(struct Bloom));
+   if (oBloom == NULL)
+      return NULL;
+
+   oBloom->pucCounters = (unsigned char*)calloc(uCounters, 1);
+   if (oBloom->pucCounters == NULL)
+   {
+      free(oBloom);
+      return NULL;
+   }
+
+   oBloom->uCapacity = uCounters / COUNTERS_PER_KEY;
+   oBloom->uCount = 0;
+   oBloom->uCounters = uCounters;
+   oBloom->uNonZero = 0;
+   return oBloom;
+}
+
+/*--------------------------------------------------------------------*/
+
+void Bloom_free(Bloom_T oBloom)
+{
+   assert(oBloom != NULL);
+
+   free(oBloom->pucCounters);
+   free(oBloom);
+}
+
+/*--------------------------------------------------------------------*/
+
+void Bloom_add(Bloom_T oBloom, const char *pcKey)
+{
+   size_t uHash1;
+   size_t uHash2;
+   size_t u;
+   unsigned char *pucCounter;
+
+   assert(oBloom != NULL);
+   assert(pcKey != NULL);
+
+   Bloom_hash(pcKey, &uHash1, &uHash2);
+   for (u = 0; u < HASHES; u++)
+   {
+      pucCounter = &oBloom->pucCounters[(uHash1 + u * uHash2)
+                                        & (oBloom->uCounters - 1)];
+      if (*pucCounter == 0)
+         oBloom->uNonZero++;
+      if (*pucCounter < UCHAR_MAX)
+         (*pucCounter)++;
+   }
+   oBloom->uCount++;
+}
+
+/*--------------------------------------------------------------------*/
+
+void Bloom_remove(Bloom_T oBloom, const char *pcKey)
+{
+   size_t uHash1;
+   size_t uHash2;
+   size_t u;
+   unsigned char *pucCounter;
+
+   assert(oBloom != NULL);
+   assert(pcKey != NULL);
+   assert(oBloom->uCount > 0);
+
+   Bloom_hash(pcKey, &uHash1, &uHash2);
+   for (u = 0; u < HASHES; u++)
+   {
+      pucCounter = &oBloom->pucCounters[(uHash1 + u * uHash2)
+                                        & (oBloom->uCounters - 1)];
+      assert(*pucCounter > 0);
+      if (*pucCounter < UCHAR_MAX)
+      {
+         (*pucCounter)--;
+         if (*pucCounter == 0)
+            oBloom->uNonZero--;
+      }
+   }
+   oBloom->uCount--;
+}
+
+/*--------------------------------------------------------------------*/
+
+int Bloom_mayContain(Bloom_T oBloom, const char *pcKey)
+{
+   size_t uHash1;
+   size_t uHash2;
+   size_t u;
+
+   assert(oBloom != NULL);
+   assert(pcKey != NULL);
+
+   Bloom_hash(pcKey, &uHash1, &uHash2);
+   for (u = 0; u < HASHES; u++)
+      if (oBloom->pucCounters[(uHash1 + u * uHash2)
+                              & (oBloom->uCounters - 1)] == 0)
+         return 0;
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t Bloom_getCount(Bloom_T oBloom)
+{
+   assert(oBloom != NULL);
+
+   return oBloom->uCount;
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t Bloom_getCapacity(Bloom_T oBloom)
+{
+   assert(oBloom != NULL);
+
+   return oBloom->uCapacity;
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t Bloom_getCounters(Bloom_T oBloom)
+{
+   assert(oBloom != NULL);
+
+   return oBloom->uCounters;
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t Bloom_getHashes(Bloom_T oBloom)
+{
+   assert(oBloom != NULL);
+   (void)oBloom;
+
+   return HASHES;
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t Bloom_getBytes(Bloom_T oBloom)
+{
+   assert(oBloom != NULL);
+
+   return sizeof(struct Bloom) + oBloom->uCounters;
+}
+
+/*--------------------------------------------------------------------*/
+
+double Bloom_getFillRatio(Bloom_T oBloom)
+{
+   assert(oBloom != NULL);
+
+   return (double)oBloom->uNonZero / (double)oBloom->uCounters;
+}
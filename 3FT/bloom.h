@@ -0,0 +1,92 @@
+/*--------------------------------------------------------------------*/
+/* bloom.h                                                            */
+/* Author: Alina Chen and Nickolas Casalinuovo                        */
+/*--------------------------------------------------------------------*/
+
+#ifndef BLOOM_INCLUDED
+#define BLOOM_INCLUDED
+
+#include <stddef.h>
+
+/* A Bloom_T object is a counting Bloom filter over strings: a
+   compact summary of a multiset of strings that answers "possibly
+   present" or "definitely absent", and that supports removals.
+   A string that was added and not removed is never reported absent;
+   an absent string is reported possibly present with a probability
+   that grows as more strings are added than the filter was sized
+   for. */
+
+typedef struct Bloom *Bloom_T;
+
+/*--------------------------------------------------------------------*/
+
+/* Return a new empty Bloom_T object sized for uExpected strings, or
+   NULL if insufficient memory is available. */
+
+Bloom_T Bloom_new(size_t uExpected);
+
+/*--------------------------------------------------------------------*/
+
+/* Free oBloom. */
+
+void Bloom_free(Bloom_T oBloom);
+
+/*--------------------------------------------------------------------*/
+
+/* Add string pcKey to oBloom. */
+
+void Bloom_add(Bloom_T oBloom, const char *pcKey);
+
+/*--------------------------------------------------------------------*/
+
+/* Remove one occurrence of string pcKey, which must have been added,
+   from oBloom. */
+
+void Bloom_remove(Bloom_T oBloom, const char *pcKey);
+
+/*--------------------------------------------------------------------*/
+
+/* Return 0 (FALSE) if string pcKey is definitely not in oBloom, and
+   1 (TRUE) if it may be. */
+
+int Bloom_mayContain(Bloom_T oBloom, const char *pcKey);
+
+/*--------------------------------------------------------------------*/
+
+/* Return the number of strings in oBloom. */
+
+size_t Bloom_getCount(Bloom_T oBloom);
+
+/*--------------------------------------------------------------------*/
+
+/* Return the number of strings oBloom was sized for. */
+
+size_t Bloom_getCapacity(Bloom_T oBloom);
+
+/*--------------------------------------------------------------------*/
+
+/* Return the number of counters in oBloom. */
+
+size_t Bloom_getCounters(Bloom_T oBloom);
+
+/*--------------------------------------------------------------------*/
+
+/* Return the number of counters each string sets in oBloom. */
+
+size_t Bloom_getHashes(Bloom_T oBloom);
+
+/*--------------------------------------------------------------------*/
+
+/* Return the number of bytes of memory used by oBloom. */
+
+size_t Bloom_getBytes(Bloom_T oBloom);
+
+/*--------------------------------------------------------------------*/
+
+/* Return the fraction of oBloom's counters that are not zero.  An
+   absent string is reported possibly present with probability about
+   this fraction raised to the number of hashes. */
+
+double Bloom_getFillRatio(Bloom_T oBloom);
+
+#endif
@@ -0,0 +1,789 @@
+/*--------------------------------------------------------------------*/
+/* btree.c                                                            */
+/* Author: Alina Chen and Nickolas Casalinuovo                        */
+/*--------------------------------------------------------------------*/
+
+/* for posix_memalign */
+#define _POSIX_C_SOURCE 200112L
+
+#include "btree.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*--------------------------------------------------------------------*/
+
+/* The size and alignment of every node: four cache lines, so that a
+   search touches few lines per level yet the tree stays shallow. */
+
+enum { CACHE_LINE = 64, NODE_BYTES = 4 * CACHE_LINE };
+
+/* The most elements a leaf can hold, and the most children an
+   internal node can have. */
+
+enum { LEAF_MAX = (NODE_BYTES - sizeof(size_t)) / sizeof(void*) };
+enum { BRANCH_MAX = (NODE_BYTES - sizeof(size_t))
+                    / (sizeof(size_t) + 2 * sizeof(void*)) };
+
+/* More levels than any tree that fits in memory can have. */
+
+enum { MAX_HEIGHT = 32 };
+
+/*--------------------------------------------------------------------*/
+
+/* A leaf: its elements are apvElements[0...uCount-1]. */
+
+struct BTreeLeaf
+{
+   /* The number of elements in the leaf. */
+   size_t uCount;
+
+   /* The elements. */
+   const void *apvElements[LEAF_MAX];
+};
+
+/* An internal node: its children are apvChildren[0...uCount-1]. */
+
+struct BTreeBranch
+{
+   /* The number of children of the node. */
+   size_t uCount;
+
+   /* auCounts[i] is the number of elements below apvChildren[i]. */
+   size_t auCounts[BRANCH_MAX];
+
+   /* apvFirsts[i] is the first element below apvChildren[i], so that
+      a search can choose a child without visiting any. */
+   const void *apvFirsts[BRANCH_MAX];
+
+   /* The children: leaves if the node is just above the leaves, or
+      else internal nodes. */
+   void *apvChildren[BRANCH_MAX];
+};
+
+/* A BTree is a B+tree whose leaves are all at the same depth.  Every
+   node but the root holds at least half as many entries as it can,
+   and the root, if it is not a leaf, has at least two children. */
+
+struct BTree
+{
+   /* The number of elements in the BTree. */
+   size_t uLength;
+
+   /* The number of levels above the leaves: 0 if the root is a
+      leaf. */
+   size_t uHeight;
+
+   /* The number of nodes. */
+   size_t uNodes;
+
+   /* The root: a leaf if uHeight is 0, or else an internal node. */
+   void *pvRoot;
+};
+
+/*--------------------------------------------------------------------*/
+
+#ifndef NDEBUG
+
+/* Check the invariants of oBTree that can be checked at its root.
+   Return 1 (TRUE) iff oBTree is in a valid state. */
+
+static int BTree_isValid(BTree_T oBTree)
+{
+   struct BTreeBranch *psBranch;
+   size_t u;
+   size_t uCount = 0;
+
+   if (oBTree->pvRoot == NULL) return 0;
+   if (oBTree->uHeight == 0)
+      return ((struct BTreeLeaf*)oBTree->pvRoot)->uCount
+             == oBTree->uLength;
+
+   psBranch = (struct BTreeBranch*)oBTree->pvRoot;
+   if (psBranch->uCount < 2 || psBranch->uCount > BRANCH_MAX)
+      return 0;
+   for (u = 0; u < psBranch->uCount; u++)
+      uCount += psBranch->auCounts[u];
+   if (uCount != oBTree->uLength) return 0;
+   return 1;
+}
+
+#endif
+
+/*--------------------------------------------------------------------*/
+
+/* Return the most entries a node uHeight levels above the leaves can
+   hold. */
+
+static size_t BTree_maxEntries(size_t uHeight)
+{
+   return uHeight == 0 ? (size_t)LEAF_MAX : (size_t)BRANCH_MAX;
+}
+
+/* Return the number of entries in the node pvNode, which is uHeight
+   levels above the leaves. */
+
+static size_t BTree_entries(const void *pvNode, size_t uHeight)
+{
+   if (uHeight == 0)
+      return ((const struct BTreeLeaf*)pvNode)->uCount;
+   return ((const struct BTreeBranch*)pvNode)->uCount;
+}
+
+/* Return the number of elements below the node pvNode, which is
+   uHeight levels above the leaves. */
+
+static size_t BTree_countOf(const void *pvNode, size_t uHeight)
+{
+   const struct BTreeBranch *psBranch;
+   size_t u;
+   size_t uCount = 0;
+
+   if (uHeight == 0)
+      return ((const struct BTreeLeaf*)pvNode)->uCount;
+   psBranch = (const struct BTreeBranch*)pvNode;
+   for (u = 0; u < psBranch->uCount; u++)
+      uCount += psBranch->auCounts[u];
+   return uCount;
+}
+
+/* Return the first element below the nonempty node pvNode, which is
+   uHeight levels above the leaves. */
+
+static const void *BTree_firstOf(const void *pvNode, size_t uHeight)
+{
+   if (uHeight == 0)
+      return ((const struct BTreeLeaf*)pvNode)->apvElements[0];
+   return ((const struct BTreeBranch*)pvNode)->apvFirsts[0];
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return a new empty node of oBTree, uHeight levels above the leaves,
+   or NULL if insufficient memory is available. */
+
+static void *BTree_newNode(BTree_T oBTree, size_t uHeight)
+{
+   void *pvNode;
+
+   assert(sizeof(struct BTreeLeaf) <= NODE_BYTES);
+   assert(sizeof(struct BTreeBranch) <= NODE_BYTES);
+
+   if (posix_memalign(&pvNode, CACHE_LINE, NODE_BYTES) != 0)
+      return NULL;
+   if (uHeight == 0)
+      ((struct BTreeLeaf*)pvNode)->uCount = 0;
+   else
+      ((struct BTreeBranch*)pvNode)->uCount = 0;
+   oBTree->uNodes++;
+   return pvNode;
+}
+
+/* Free the node pvNode of oBTree, which is uHeight levels above the
+   leaves, and all nodes below it. */
+
+static void BTree_freeNode(BTree_T oBTree, void *pvNode,
+                           size_t uHeight)
+{
+   struct BTreeBranch *psBranch;
+   size_t u;
+
+   if (uHeight > 0)
+   {
+      psBranch = (struct BTreeBranch*)pvNode;
+      for (u = 0; u < psBranch->uCount; u++)
+         BTree_freeNode(oBTree, psBranch->apvChildren[u], uHeight - 1);
+   }
+   free(pvNode);
+   oBTree->uNodes--;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Move uMove entries, each uSize bytes long, from the array pcSrc,
+   which holds uSrcLen entries, starting at index uSrcAt, into the
+   array pcDst, which holds uDstLen entries, at index uDstAt.  Close
+   the gap they leave and open the gap they fill. */
+
+static void BTree_moveEntries(char *pcDst, size_t uDstLen,
+                              size_t uDstAt, char *pcSrc,
+                              size_t uSrcLen, size_t uSrcAt,
+                              size_t uMove, size_t uSize)
+{
+   memmove(pcDst + (uDstAt + uMove) * uSize, pcDst + uDstAt * uSize,
+           (uDstLen - uDstAt) * uSize);
+   memcpy(pcDst + uDstAt * uSize, pcSrc + uSrcAt * uSize,
+          uMove * uSize);
+   memmove(pcSrc + uSrcAt * uSize, pcSrc + (uSrcAt + uMove) * uSize,
+           (uSrcLen - uSrcAt - uMove) * uSize);
+}
+
+/* Move uMove entries from the node pvSrc, starting at entry uSrcAt,
+   into the distinct node pvDst at entry uDstAt.  Both nodes are
+   uHeight levels above the leaves. */
+
+static void BTree_transfer(void *pvDst, size_t uDstAt, void *pvSrc,
+                           size_t uSrcAt, size_t uMove, size_t uHeight)
+{
+   struct BTreeLeaf *psDstLeaf;
+   struct BTreeLeaf *psSrcLeaf;
+   struct BTreeBranch *psDst;
+   struct BTreeBranch *psSrc;
+
+   assert(pvDst != pvSrc);
+   assert(BTree_entries(pvDst, uHeight) + uMove
+          <= BTree_maxEntries(uHeight));
+
+   if (uHeight == 0)
+   {
+      psDstLeaf = (struct BTreeLeaf*)pvDst;
+      psSrcLeaf = (struct BTreeLeaf*)pvSrc;
+      BTree_moveEntries((char*)psDstLeaf->apvElements,
+                        psDstLeaf->uCount, uDstAt,
+                        (char*)psSrcLeaf->apvElements,
+                        psSrcLeaf->uCount, uSrcAt, uMove,
+                        sizeof(void*));
+      psDstLeaf->uCount += uMove;
+      psSrcLeaf->uCount -= uMove;
+      return;
+   }
+
+   psDst = (struct BTreeBranch*)pvDst;
+   psSrc = (struct BTreeBranch*)pvSrc;
+   BTree_moveEntries((char*)psDst->auCounts, psDst->uCount, uDstAt,
+                     (char*)psSrc->auCounts, psSrc->uCount, uSrcAt,
+                     uMove, sizeof(size_t));
+   BTree_moveEntries((char*)psDst->apvFirsts, psDst->uCount, uDstAt,
+                     (char*)psSrc->apvFirsts, psSrc->uCount, uSrcAt,
+                     uMove, sizeof(void*));
+   BTree_moveEntries((char*)psDst->apvChildren, psDst->uCount, uDstAt,
+                     (char*)psSrc->apvChildren, psSrc->uCount, uSrcAt,
+                     uMove, sizeof(void*));
+   psDst->uCount += uMove;
+   psSrc->uCount -= uMove;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Split the full child uChild of psBranch, which is uHeight levels
+   above the leaves, into two halves.  psBranch must not be full.
+   Return 1 (TRUE) if successful, or 0 (FALSE) if insufficient memory
+   is available, in which case oBTree is unchanged. */
+
+static int BTree_splitChild(BTree_T oBTree,
+                            struct BTreeBranch *psBranch,
+                            size_t uChild, size_t uHeight)
+{
+   void *pvChild;
+   void *pvSibling;
+   size_t uEntries;
+   size_t uAfter;
+
+   assert(psBranch->uCount < BRANCH_MAX);
+
+   pvChild = psBranch->apvChildren[uChild];
+   pvSibling = BTree_newNode(oBTree, uHeight);
+   if (pvSibling == NULL)
+      return 0;
+   uEntries = BTree_entries(pvChild, uHeight);
+   BTree_transfer(pvSibling, 0, pvChild, uEntries / 2,
+                  uEntries - uEntries / 2, uHeight);
+
+   uAfter = psBranch->uCount - uChild - 1;
+   memmove(&psBranch->auCounts[uChild + 2],
+           &psBranch->auCounts[uChild + 1], uAfter * sizeof(size_t));
+   memmove(&psBranch->apvFirsts[uChild + 2],
+           &psBranch->apvFirsts[uChild + 1], uAfter * sizeof(void*));
+   memmove(&psBranch->apvChildren[uChild + 2],
+           &psBranch->apvChildren[uChild + 1], uAfter * sizeof(void*));
+   psBranch->apvChildren[uChild + 1] = pvSibling;
+   psBranch->auCounts[uChild] = BTree_countOf(pvChild, uHeight);
+   psBranch->auCounts[uChild + 1] = BTree_countOf(pvSibling, uHeight);
+   psBranch->apvFirsts[uChild + 1] = BTree_firstOf(pvSibling, uHeight);
+   psBranch->uCount++;
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Restore the minimum number of entries to the child uChild of
+   psBranch, which is uHeight levels above the leaves and has one
+   entry too few, by moving entries to it from a neighbour or, if
+   they both fit in one node, merging it with the neighbour. */
+
+static void BTree_rebalance(BTree_T oBTree,
+                            struct BTreeBranch *psBranch,
+                            size_t uChild, size_t uHeight)
+{
+   size_t uLeft;
+   void *pvLeft;
+   void *pvRight;
+   size_t uLeftEntries;
+   size_t uRightEntries;
+   size_t uTarget;
+   size_t uAfter;
+
+   assert(psBranch->uCount >= 2);
+
+   uLeft = uChild > 0 ? uChild - 1 : uChild;
+   pvLeft = psBranch->apvChildren[uLeft];
+   pvRight = psBranch->apvChildren[uLeft + 1];
+   uLeftEntries = BTree_entries(pvLeft, uHeight);
+   uRightEntries = BTree_entries(pvRight, uHeight);
+
+   if (uLeftEntries + uRightEntries <= BTree_maxEntries(uHeight))
+   {
+      BTree_transfer(pvLeft, uLeftEntries, pvRight, 0, uRightEntries,
+                     uHeight);
+      free(pvRight);
+      oBTree->uNodes--;
+      psBranch->auCounts[uLeft] += psBranch->auCounts[uLeft + 1];
+      uAfter = psBranch->uCount - uLeft - 2;
+      memmove(&psBranch->auCounts[uLeft + 1],
+              &psBranch->auCounts[uLeft + 2], uAfter * sizeof(size_t));
+      memmove(&psBranch->apvFirsts[uLeft + 1],
+              &psBranch->apvFirsts[uLeft + 2], uAfter * sizeof(void*));
+      memmove(&psBranch->apvChildren[uLeft + 1],
+              &psBranch->apvChildren[uLeft + 2],
+              uAfter * sizeof(void*));
+      psBranch->uCount--;
+   }
+   else
+   {
+      uTarget = (uLeftEntries + uRightEntries) / 2;
+      if (uLeftEntries < uTarget)
+         BTree_transfer(pvLeft, uLeftEntries, pvRight, 0,
+                        uTarget - uLeftEntries, uHeight);
+      else
+         BTree_transfer(pvRight, 0, pvLeft, uTarget,
+                        uLeftEntries - uTarget, uHeight);
+      psBranch->auCounts[uLeft] = BTree_countOf(pvLeft, uHeight);
+      psBranch->auCounts[uLeft + 1] = BTree_countOf(pvRight, uHeight);
+      psBranch->apvFirsts[uLeft + 1] = BTree_firstOf(pvRight, uHeight);
+   }
+   psBranch->apvFirsts[uLeft] = BTree_firstOf(pvLeft, uHeight);
+}
+
+/*--------------------------------------------------------------------*/
+
+BTree_T BTree_new(void)
+{
+   BTree_T oBTree;
+
+   oBTree = (struct BTree*)malloc(sizeof(struct BTree));
+   if (oBTree == NULL)
+      return NULL;
+
+   oBTree->uLength = 0;
+   oBTree->uHeight = 0;
+   oBTree->uNodes = 0;
+   oBTree->pvRoot = BTree_newNode(oBTree, 0);
+   if (oBTree->pvRoot == NULL)
+   {
+      free(oBTree);
+      return NULL;
+   }
+
+   assert(BTree_isValid(oBTree));
+
+   return oBTree;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Free the uCount nodes of oBTree at ppvNodes, each uHeight levels
+   above the leaves, and all nodes below them. */
+
+static void BTree_freeNodes(BTree_T oBTree, void **ppvNodes,
+                            size_t uCount, size_t uHeight)
+{
+   size_t u;
+
+   for (u = 0; u < uCount; u++)
+      BTree_freeNode(oBTree, ppvNodes[u], uHeight);
+}
+
+/*--------------------------------------------------------------------*/
+
+BTree_T BTree_newFrom(void *const *ppvElements, size_t uLength)
+{
+   BTree_T oBTree;
+   struct BTreeLeaf *psLeaf;
+   struct BTreeBranch *psBranch;
+   void **ppvLevel;
+   size_t uNodes;
+   size_t uParents;
+   size_t uFirst;
+   size_t uEnd;
+   size_t u;
+
+   assert(uLength == 0 || ppvElements != NULL);
+
+   if (uLength <= LEAF_MAX)
+   {
+      oBTree = BTree_new();
+      if (oBTree == NULL)
+         return NULL;
+      psLeaf = (struct BTreeLeaf*)oBTree->pvRoot;
+      memcpy(psLeaf->apvElements, ppvElements, uLength * sizeof(void*));
+      psLeaf->uCount = uLength;
+      oBTree->uLength = uLength;
+      return oBTree;
+   }
+
+   oBTree = (struct BTree*)malloc(sizeof(struct BTree));
+   if (oBTree == NULL)
+      return NULL;
+   oBTree->uLength = uLength;
+   oBTree->uHeight = 0;
+   oBTree->uNodes = 0;
+
+   /* The fewest nodes that can hold each level share its entries
+      evenly, so each is at least half full. */
+   uNodes = (uLength + LEAF_MAX - 1) / LEAF_MAX;
+   ppvLevel = (void**)malloc(uNodes * sizeof(void*));
+   if (ppvLevel == NULL)
+   {
+      free(oBTree);
+      return NULL;
+   }
+   for (u = 0; u < uNodes; u++)
+   {
+      psLeaf = (struct BTreeLeaf*)BTree_newNode(oBTree, 0);
+      if (psLeaf == NULL)
+      {
+         BTree_freeNodes(oBTree, ppvLevel, u, 0);
+         free(ppvLevel);
+         free(oBTree);
+         return NULL;
+      }
+      uFirst = uLength * u / uNodes;
+      psLeaf->uCount = uLength * (u + 1) / uNodes - uFirst;
+      memcpy(psLeaf->apvElements, &ppvElements[uFirst],
+             psLeaf->uCount * sizeof(void*));
+      ppvLevel[u] = psLeaf;
+   }
+
+   /* Each parent takes the place in ppvLevel of its first child or
+      one before it, so the level above is built in place. */
+   while (uNodes > 1)
+   {
+      uParents = (uNodes + BRANCH_MAX - 1) / BRANCH_MAX;
+      for (u = 0; u < uParents; u++)
+      {
+         uFirst = uNodes * u / uParents;
+         uEnd = uNodes * (u + 1) / uParents;
+         psBranch = (struct BTreeBranch*)
+            BTree_newNode(oBTree, oBTree->uHeight + 1);
+         if (psBranch == NULL)
+         {
+            BTree_freeNodes(oBTree, ppvLevel, u, oBTree->uHeight + 1);
+            BTree_freeNodes(oBTree, &ppvLevel[uFirst], uNodes - uFirst,
+                            oBTree->uHeight);
+            free(ppvLevel);
+            free(oBTree);
+            return NULL;
+         }
+         for (psBranch->uCount = 0; uFirst < uEnd; uFirst++)
+         {
+            psBranch->apvChildren[psBranch->uCount] = ppvLevel[uFirst];
+            psBranch->auCounts[psBranch->uCount] =
+               BTree_countOf(ppvLevel[uFirst], oBTree->uHeight);
+            psBranch->apvFirsts[psBranch->uCount] =
+               BTree_firstOf(ppvLevel[uFirst], oBTree->uHeight);
+            psBranch->uCount++;
+         }
+         ppvLevel[u] = psBranch;
+      }
+      uNodes = uParents;
+      oBTree->uHeight++;
+   }
+   oBTree->pvRoot = ppvLevel[0];
+   free(ppvLevel);
+
+   assert(BTree_isValid(oBTree));
+
+   return oBTree;
+}
+
+/*--------------------------------------------------------------------*/
+
+void BTree_free(BTree_T oBTree)
+{
+   assert(oBTree != NULL);
+
+   BTree_freeNode(oBTree, oBTree->pvRoot, oBTree->uHeight);
+   free(oBTree);
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t BTree_getLength(BTree_T oBTree)
+{
+   assert(oBTree != NULL);
+
+   return oBTree->uLength;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *BTree_get(BTree_T oBTree, size_t uIndex)
+{
+   struct BTreeBranch *psBranch;
+   void *pvNode;
+   size_t uHeight;
+   size_t u;
+
+   assert(oBTree != NULL);
+   assert(uIndex < oBTree->uLength);
+
+   pvNode = oBTree->pvRoot;
+   for (uHeight = oBTree->uHeight; uHeight > 0; uHeight--)
+   {
+      psBranch = (struct BTreeBranch*)pvNode;
+      for (u = 0; uIndex >= psBranch->auCounts[u]; u++)
+         uIndex -= psBranch->auCounts[u];
+      pvNode = psBranch->apvChildren[u];
+   }
+   return (void*)((struct BTreeLeaf*)pvNode)->apvElements[uIndex];
+}
+
+/*--------------------------------------------------------------------*/
+
+int BTree_addAt(BTree_T oBTree, size_t uIndex, const void *pvElement)
+{
+   struct BTreeBranch *apsPath[MAX_HEIGHT];
+   size_t auPath[MAX_HEIGHT];
+   struct BTreeBranch *psBranch;
+   struct BTreeLeaf *psLeaf;
+   void *pvNode;
+   size_t uHeight;
+   size_t uDepth;
+   size_t u;
+
+   assert(oBTree != NULL);
+   assert(uIndex <= oBTree->uLength);
+
+   /* Splitting full nodes on the way down, starting with the root,
+      ensures that each split has room in its parent, and that
+      running out of memory leaves a valid tree behind. */
+   if (BTree_entries(oBTree->pvRoot, oBTree->uHeight)
+       == BTree_maxEntries(oBTree->uHeight))
+   {
+      psBranch = (struct BTreeBranch*)
+         BTree_newNode(oBTree, oBTree->uHeight + 1);
+      if (psBranch == NULL)
+         return 0;
+      psBranch->uCount = 1;
+      psBranch->auCounts[0] = oBTree->uLength;
+      psBranch->apvFirsts[0] =
+         BTree_firstOf(oBTree->pvRoot, oBTree->uHeight);
+      psBranch->apvChildren[0] = oBTree->pvRoot;
+      if (! BTree_splitChild(oBTree, psBranch, 0, oBTree->uHeight))
+      {
+         free(psBranch);
+         oBTree->uNodes--;
+         return 0;
+      }
+      oBTree->pvRoot = psBranch;
+      oBTree->uHeight++;
+   }
+
+   pvNode = oBTree->pvRoot;
+   for (uDepth = 0, uHeight = oBTree->uHeight; uHeight > 0;
+        uDepth++, uHeight--)
+   {
+      /* An index between two children goes at the end of the
+         first. */
+      psBranch = (struct BTreeBranch*)pvNode;
+      for (u = 0; u + 1 < psBranch->uCount
+                  && uIndex > psBranch->auCounts[u]; u++)
+         uIndex -= psBranch->auCounts[u];
+      if (BTree_entries(psBranch->apvChildren[u], uHeight - 1)
+          == BTree_maxEntries(uHeight - 1))
+      {
+         if (! BTree_splitChild(oBTree, psBranch, u, uHeight - 1))
+            return 0;
+         if (uIndex > psBranch->auCounts[u])
+         {
+            uIndex -= psBranch->auCounts[u];
+            u++;
+         }
+      }
+      apsPath[uDepth] = psBranch;
+      auPath[uDepth] = u;
+      pvNode = psBranch->apvChildren[u];
+   }
+
+   psLeaf = (struct BTreeLeaf*)pvNode;
+   memmove(&psLeaf->apvElements[uIndex + 1],
+           &psLeaf->apvElements[uIndex],
+           (psLeaf->uCount - uIndex) * sizeof(void*));
+   psLeaf->apvElements[uIndex] = pvElement;
+   psLeaf->uCount++;
+
+   while (uDepth-- > 0)
+   {
+      psBranch = apsPath[uDepth];
+      u = auPath[uDepth];
+      psBranch->auCounts[u]++;
+      psBranch->apvFirsts[u] =
+         BTree_firstOf(psBranch->apvChildren[u],
+                       oBTree->uHeight - uDepth - 1);
+   }
+   oBTree->uLength++;
+
+   assert(BTree_isValid(oBTree));
+
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *BTree_removeAt(BTree_T oBTree, size_t uIndex)
+{
+   struct BTreeBranch *apsPath[MAX_HEIGHT];
+   size_t auPath[MAX_HEIGHT];
+   struct BTreeBranch *psBranch;
+   struct BTreeLeaf *psLeaf;
+   const void *pvElement;
+   void *pvNode;
+   size_t uHeight;
+   size_t uDepth;
+   size_t u;
+
+   assert(oBTree != NULL);
+   assert(uIndex < oBTree->uLength);
+
+   pvNode = oBTree->pvRoot;
+   for (uDepth = 0, uHeight = oBTree->uHeight; uHeight > 0;
+        uDepth++, uHeight--)
+   {
+      psBranch = (struct BTreeBranch*)pvNode;
+      for (u = 0; uIndex >= psBranch->auCounts[u]; u++)
+         uIndex -= psBranch->auCounts[u];
+      apsPath[uDepth] = psBranch;
+      auPath[uDepth] = u;
+      pvNode = psBranch->apvChildren[u];
+   }
+
+   psLeaf = (struct BTreeLeaf*)pvNode;
+   pvElement = psLeaf->apvElements[uIndex];
+   memmove(&psLeaf->apvElements[uIndex],
+           &psLeaf->apvElements[uIndex + 1],
+           (psLeaf->uCount - uIndex - 1) * sizeof(void*));
+   psLeaf->uCount--;
+
+   /* Restore each node on the path, from the leaf up. */
+   while (uDepth-- > 0)
+   {
+      psBranch = apsPath[uDepth];
+      u = auPath[uDepth];
+      uHeight = oBTree->uHeight - uDepth - 1;
+      psBranch->auCounts[u]--;
+      if (BTree_entries(psBranch->apvChildren[u], uHeight)
+          < BTree_maxEntries(uHeight) / 2)
+         BTree_rebalance(oBTree, psBranch, u, uHeight);
+      else
+         psBranch->apvFirsts[u] =
+            BTree_firstOf(psBranch->apvChildren[u], uHeight);
+   }
+
+   /* A root left with one child gives way to it. */
+   if (oBTree->uHeight > 0
+       && ((struct BTreeBranch*)oBTree->pvRoot)->uCount == 1)
+   {
+      pvNode = ((struct BTreeBranch*)oBTree->pvRoot)->apvChildren[0];
+      free(oBTree->pvRoot);
+      oBTree->uNodes--;
+      oBTree->pvRoot = pvNode;
+      oBTree->uHeight--;
+   }
+   oBTree->uLength--;
+
+   assert(BTree_isValid(oBTree));
+
+   return (void*)pvElement;
+}
+
+/*--------------------------------------------------------------------*/
+
+int BTree_bsearch(BTree_T oBTree, const void *pvKey, size_t *puIndex,
+                  int (*pfCompare)(const void *pvKey,
+                                   const void *pvElement))
+{
+   struct BTreeBranch *psBranch;
+   struct BTreeLeaf *psLeaf;
+   void *pvNode;
+   size_t uHeight;
+   size_t uBase = 0;
+   size_t uLo;
+   size_t uHi;
+   size_t uMid;
+   size_t u;
+   int iCompare;
+
+   assert(oBTree != NULL);
+   assert(puIndex != NULL);
+   assert(pfCompare != NULL);
+
+   pvNode = oBTree->pvRoot;
+   for (uHeight = oBTree->uHeight; uHeight > 0; uHeight--)
+   {
+      /* Find the last child whose first element is at most pvKey,
+         or the first child if there is none. */
+      psBranch = (struct BTreeBranch*)pvNode;
+      uLo = 0;
+      uHi = psBranch->uCount;
+      while (uLo < uHi)
+      {
+         uMid = uLo + (uHi - uLo) / 2;
+         iCompare = (*pfCompare)(pvKey, psBranch->apvFirsts[uMid]);
+         if (iCompare == 0)
+         {
+            for (u = 0; u < uMid; u++)
+               uBase += psBranch->auCounts[u];
+            *puIndex = uBase;
+            return 1;
+         }
+         if (iCompare < 0)
+            uHi = uMid;
+         else
+            uLo = uMid + 1;
+      }
+      if (uLo > 0)
+         uLo--;
+      for (u = 0; u < uLo; u++)
+         uBase += psBranch->auCounts[u];
+      pvNode = psBranch->apvChildren[uLo];
+   }
+
+   psLeaf = (struct BTreeLeaf*)pvNode;
+   uLo = 0;
+   uHi = psLeaf->uCount;
+   while (uLo < uHi)
+   {
+      uMid = uLo + (uHi - uLo) / 2;
+      iCompare = (*pfCompare)(pvKey, psLeaf->apvElements[uMid]);
+      if (iCompare == 0)
+      {
+         *puIndex = uBase + uMid;
+         return 1;
+      }
+      if (iCompare < 0)
+         uHi = uMid;
+      else
+         uLo = uMid + 1;
+   }
+   *puIndex = uBase + uLo;
+   return 0;
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t BTree_getBytes(BTree_T oBTree)
+{
+   assert(oBTree != NULL);
+
+   return sizeof(struct BTree) + oBTree->uNodes * NODE_BYTES;
+}
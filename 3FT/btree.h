@@ -0,0 +1,89 @@
+/*--------------------------------------------------------------------*/
+/* btree.h                                                            */
+/* Author: Alina Chen and Nickolas Casalinuovo                        */
+/*--------------------------------------------------------------------*/
+
+#ifndef BTREE_INCLUDED
+#define BTREE_INCLUDED
+
+#include <stddef.h>
+
+/* A BTree_T object is a sequence of elements, as a DynArray_T is,
+   stored in an in-memory B+tree whose nodes are a few cache lines
+   long.  Each internal node records how many elements lie below each
+   of its children, so getting, adding, or removing the uIndex'th
+   element takes time logarithmic in the length, as does a binary
+   search of a sorted BTree_T. */
+
+typedef struct BTree *BTree_T;
+
+/*--------------------------------------------------------------------*/
+
+/* Return a new empty BTree_T object, or NULL if insufficient memory
+   is available. */
+
+BTree_T BTree_new(void);
+
+/*--------------------------------------------------------------------*/
+
+/* Return a new BTree_T object holding the uLength elements at
+   ppvElements, in order, in as few nodes as can hold them, or NULL if
+   insufficient memory is available.  Takes time linear in uLength,
+   where adding the elements one at a time would leave most nodes
+   half full. */
+
+BTree_T BTree_newFrom(void *const *ppvElements, size_t uLength);
+
+/*--------------------------------------------------------------------*/
+
+/* Free oBTree. */
+
+void BTree_free(BTree_T oBTree);
+
+/*--------------------------------------------------------------------*/
+
+/* Return the length of oBTree. */
+
+size_t BTree_getLength(BTree_T oBTree);
+
+/*--------------------------------------------------------------------*/
+
+/* Return the uIndex'th element of oBTree. */
+
+void *BTree_get(BTree_T oBTree, size_t uIndex);
+
+/*--------------------------------------------------------------------*/
+
+/* Add pvElement to oBTree such that it is the uIndex'th element.
+   Return 1 (TRUE) if successful, or 0 (FALSE) if insufficient memory
+   is available, in which case oBTree is unchanged. */
+
+int BTree_addAt(BTree_T oBTree, size_t uIndex, const void *pvElement);
+
+/*--------------------------------------------------------------------*/
+
+/* Remove and return the uIndex'th element of oBTree. */
+
+void *BTree_removeAt(BTree_T oBTree, size_t uIndex);
+
+/*--------------------------------------------------------------------*/
+
+/* Binary search oBTree for pvKey using *pfCompare to determine
+   equality.  If an element is found, then assign its index to
+   *puIndex and return 1.  If no element is found, then assign the
+   index where it would belong to *puIndex and return 0.
+   *pfCompare must return <0, 0, or >0 if pvKey is less than, equal
+   to, or greater than *pvElement.  oBTree must be sorted as
+   determined by *pfCompare. */
+
+int BTree_bsearch(BTree_T oBTree, const void *pvKey, size_t *puIndex,
+                  int (*pfCompare)(const void *pvKey,
+                                   const void *pvElement));
+
+/*--------------------------------------------------------------------*/
+
+/* Return the number of bytes of memory used by oBTree. */
+
+size_t BTree_getBytes(BTree_T oBTree);
+
+#endif
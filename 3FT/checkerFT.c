@@ -0,0 +1,286 @@
+/*--------------------------------------------------------------------*/
+/* checkerFT.c                                                        */
+/* Author: Alina Chen and Nickolas Casalinuovo                        */
+/*--------------------------------------------------------------------*/
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "checkerFT.h"
+
+/* The most consecutive children of each type that a sample checks
+   at each node it reaches. */
+enum { SAMPLE_WINDOW = 4 };
+
+/* the state of the generator that chooses what a sample checks */
+static uint64_t sampleState = 1;
+
+/* Returns a pseudo-random number from 0 to n - 1, for n > 0. */
+static size_t CheckerFT_random(size_t n) {
+   assert(n > 0);
+
+   sampleState = sampleState * 6364136223846793005ULL
+                 + 1442695040888963407ULL;
+   return (size_t)(sampleState >> 33) % n;
+}
+
+/* Returns the child of n of type type with identifier childID. */
+static Node_T CheckerFT_getChild(Node_T n, nodeType type,
+                                 size_t childID) {
+   if(type == ISFILE)
+      return Node_getChildFile(n, childID);
+   return Node_getChildDirectory(n, childID);
+}
+
+/* see checkerFT.h for specification */
+boolean CheckerFT_Node_isValid(Node_T n) {
+   Node_T parent;
+   const char* npath;
+   const char* ppath;
+   const char* name;
+   size_t i;
+
+   if(n == NULL) {
+      fprintf(stderr, "A node is a NULL pointer\n");
+      return FALSE;
+   }
+
+   npath = Node_getPath(n);
+   if(npath == NULL) {
+      fprintf(stderr, "Node has no path\n");
+      return FALSE;
+   }
+
+   /* files are leaves, and hold their contents in one place */
+   if(!Node_isConsistent(n)) {
+      fprintf(stderr, "Node's fields do not agree with its type\n");
+      return FALSE;
+   }
+
+   parent = Node_getParent(n);
+   if(parent != NULL) {
+      if(isFile(parent)) {
+         fprintf(stderr, "Parent of a node is a file\n");
+         return FALSE;
+      }
+
+      ppath = Node_getPath(parent);
+      i = strlen(ppath);
+      if(strncmp(npath, ppath, i) || npath[i] != '/') {
+         fprintf(stderr, "P's path is not a prefix of C's path\n");
+         return FALSE;
+      }
+
+      name = npath + i + 1;
+      if(*name == '\0') {
+         fprintf(stderr, "C's path ends in an empty component\n");
+         return FALSE;
+      }
+      if(strchr(name, '/') != NULL) {
+         fprintf(stderr, "C's path has grandchild of P's path\n");
+         return FALSE;
+      }
+
+      /* this also finds a file and directory of the same name */
+      if(Node_findChild(parent, name, strlen(name)) != n) {
+         fprintf(stderr, "P does not find C by its name\n");
+         return FALSE;
+      }
+   }
+
+   return TRUE;
+}
+
+/*
+   Checks the children of n of type type with identifiers from first
+   up to but not including last: each must be non-NULL, be of type
+   type, and have n as its parent, and their paths must increase.
+   Returns FALSE if a broken invariant is found and TRUE otherwise.
+*/
+static boolean CheckerFT_childrenCheck(Node_T n, nodeType type,
+                                       size_t first, size_t last) {
+   Node_T child;
+   Node_T lastChild = NULL;
+   size_t c;
+
+   for(c = first; c < last; c++) {
+      child = CheckerFT_getChild(n, type, c);
+      if(child == NULL) {
+         fprintf(stderr, "Null Child.\n");
+         return FALSE;
+      }
+      if(getType(child) != type) {
+         fprintf(stderr, "Child is among the other type's children\n");
+         return FALSE;
+      }
+      if(Node_getParent(child) != n) {
+         fprintf(stderr, "Parent of child is not current node.\n");
+         return FALSE;
+      }
+      if(lastChild != NULL &&
+         strcmp(Node_getPath(lastChild), Node_getPath(child)) >= 0) {
+         fprintf(stderr, "Children are not in alphabetical order.\n");
+         return FALSE;
+      }
+      lastChild = child;
+   }
+
+   return TRUE;
+}
+
+/*
+   Performs a pre-order traversal of the tree rooted at n.
+   Returns FALSE if a broken invariant is found and
+   returns TRUE otherwise.
+
+   Adds the number of nodes visited to *numNodes.
+*/
+static boolean CheckerFT_treeCheck(Node_T n, size_t *numNodes) {
+   size_t numDirs;
+   size_t numFiles;
+   size_t c;
+
+   assert(n != NULL);
+   assert(numNodes != NULL);
+
+   (*numNodes)++;
+   if(!CheckerFT_Node_isValid(n))
+      return FALSE;
+
+   numDirs = Node_getNumDirChildren(n);
+   numFiles = Node_getNumFileChildren(n);
+   if(!CheckerFT_childrenCheck(n, ISDIRECTORY, 0, numDirs)
+      || !CheckerFT_childrenCheck(n, ISFILE, 0, numFiles))
+      return FALSE;
+
+   for(c = 0; c < numDirs; c++)
+      if(!CheckerFT_treeCheck(Node_getChildDirectory(n, c), numNodes))
+         return FALSE;
+   for(c = 0; c < numFiles; c++)
+      if(!CheckerFT_treeCheck(Node_getChildFile(n, c), numNodes))
+         return FALSE;
+
+   return TRUE;
+}
+
+/*
+   Returns TRUE if the top-level state of the hierarchy, given by
+   isInit, root and count as for CheckerFT_isValid, is consistent
+   without looking below the root, or FALSE otherwise.
+*/
+static boolean CheckerFT_stateCheck(boolean isInit, Node_T root,
+                                    size_t count) {
+   if(!isInit) {
+      if(count != 0) {
+         fprintf(stderr, "Not initialized, but count is not 0\n");
+         return FALSE;
+      }
+      if(root != NULL) {
+         fprintf(stderr, "Not initialized, but root is not NULL\n");
+         return FALSE;
+      }
+      return TRUE;
+   }
+
+   if(root == NULL) {
+      if(count != 0) {
+         fprintf(stderr,
+                 "Initialized, has no nodes but count isn't 0\n");
+         return FALSE;
+      }
+      return TRUE;
+   }
+   if(count == 0) {
+      fprintf(stderr, "Initialized, has a node but count is 0\n");
+      return FALSE;
+   }
+   if(Node_getParent(root) != NULL) {
+      fprintf(stderr, "Parent of root is not null.\n");
+      return FALSE;
+   }
+   if(isFile(root)) {
+      fprintf(stderr, "Root is a file.\n");
+      return FALSE;
+   }
+
+   return TRUE;
+}
+
+/* see checkerFT.h for specification */
+boolean CheckerFT_isValid(boolean isInit, Node_T root, size_t count) {
+   size_t numNodes = 0;
+
+   if(!CheckerFT_stateCheck(isInit, root, count))
+      return FALSE;
+   if(root == NULL)
+      return TRUE;
+
+   /* Now checks invariants recursively at each node from the root. */
+   if(!CheckerFT_treeCheck(root, &numNodes))
+      return FALSE;
+
+   if(numNodes != count) {
+      fprintf(stderr,
+              "The number of nodes is not equal to the count.\n");
+      return FALSE;
+   }
+
+   return TRUE;
+}
+
+/* see checkerFT.h for specification */
+boolean CheckerFT_isValidSample(boolean isInit, Node_T root,
+                                size_t count, size_t budget) {
+   Node_T n = root;
+   size_t numChildren[2];
+   size_t spent = 0;
+   size_t first;
+   size_t last;
+   size_t c;
+   nodeType type;
+
+   if(!CheckerFT_stateCheck(isInit, root, count))
+      return FALSE;
+   if(root == NULL)
+      return TRUE;
+
+   while(spent < budget) {
+      if(!CheckerFT_Node_isValid(n))
+         return FALSE;
+      spent++;
+
+      /* check a window of each type's children at a random place */
+      numChildren[ISDIRECTORY] = Node_getNumDirChildren(n);
+      numChildren[ISFILE] = Node_getNumFileChildren(n);
+      for(type = ISDIRECTORY; type <= ISFILE; type++) {
+         if(numChildren[type] == 0)
+            continue;
+         first = CheckerFT_random(numChildren[type]);
+         last = first + SAMPLE_WINDOW;
+         if(last > numChildren[type])
+            last = numChildren[type];
+         if(!CheckerFT_childrenCheck(n, type, first, last))
+            return FALSE;
+         spent += last - first;
+      }
+
+      /* then continue down through a random child, if there is one */
+      if(numChildren[ISDIRECTORY] + numChildren[ISFILE] == 0) {
+         n = root;
+         continue;
+      }
+      c = CheckerFT_random(numChildren[ISDIRECTORY]
+                           + numChildren[ISFILE]);
+      if(c < numChildren[ISDIRECTORY])
+         n = Node_getChildDirectory(n, c);
+      else
+         n = Node_getChildFile(n, c - numChildren[ISDIRECTORY]);
+      if(n == NULL) {
+         fprintf(stderr, "Null Child.\n");
+         return FALSE;
+      }
+   }
+
+   return TRUE;
+}
@@ -0,0 +1,45 @@
+/*--------------------------------------------------------------------*/
+/* checkerFT.h                                                        */
+/* Author: Alina Chen and Nickolas Casalinuovo                        */
+/*--------------------------------------------------------------------*/
+
+#ifndef CHECKERFT_INCLUDED
+#define CHECKERFT_INCLUDED
+
+#include "node.h"
+
+
+/*
+   Returns TRUE if n represents a file or directory in a valid state,
+   both in its own fields and as a child that its parent can find by
+   name, or FALSE otherwise.
+*/
+boolean CheckerFT_Node_isValid(Node_T n);
+
+/*
+   Returns TRUE if the hierarchy is in a valid state or FALSE
+   otherwise.  The data structure's validity is based on a boolean
+   isInit indicating whether it has been initialized, a Node_T root
+   representing the root of the hierarchy, and a size_t count
+   representing the total number of directories and files in the
+   hierarchy.  Checks every node, so takes time at least linear in
+   count.
+*/
+boolean CheckerFT_isValid(boolean isInit, Node_T root, size_t count);
+
+/*
+   Returns TRUE if a random sample of the hierarchy given by isInit,
+   root and count is in a valid state, or FALSE otherwise.  Checks
+   the top-level state as CheckerFT_isValid does, then walks down from
+   the root through randomly chosen children, checking each node it
+   reaches and a few of that node's children, and starts again from
+   the root whenever it reaches a file or an empty directory, until
+   about budget nodes have been checked.  So its time depends on
+   budget, not on the size of the hierarchy, and it cannot confirm
+   count.  The choices come from a generator of the checker's own, so
+   they do not disturb the client's use of rand.
+*/
+boolean CheckerFT_isValidSample(boolean isInit, Node_T root,
+                                size_t count, size_t budget);
+
+#endif
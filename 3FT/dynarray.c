@@ -5,7 +5,9 @@
 
 #include "dynarray.h"
 #include <assert.h>
+#include <pthread.h>
 #include <stdlib.h>
+#include <string.h>
 
 /*--------------------------------------------------------------------*/
 
@@ -16,7 +18,7 @@ static const size_t MIN_PHYS_LENGTH = 2;
 /*--------------------------------------------------------------------*/
 
 /* A DynArray consists of an array, along with its logical and
-   physical lengths. */
+   physical lengths and the Allocator it came from. */
 
 struct DynArray
 {
@@ -30,10 +32,56 @@ struct DynArray
 
    /* The array that underlies the DynArray. */
    const void **ppvArray;
+
+   /* The Allocator of the DynArray and its array, or NULL if they
+      come from malloc. */
+   const struct Allocator *psAllocator;
 };
 
 /*--------------------------------------------------------------------*/
 
+/* Return a block of uSize bytes from psAllocator, or from malloc if
+   psAllocator is NULL.  Keeping the heap case here means a DynArray
+   that never sees an Allocator does not need allocator.o. */
+
+static void *DynArray_alloc(const struct Allocator *psAllocator,
+                            size_t uSize)
+{
+   if (psAllocator == NULL)
+      return malloc(uSize);
+   return Allocator_alloc(psAllocator, uSize);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Resize pvBlock from uOldSize to uNewSize bytes, as DynArray_alloc
+   would have allocated it. */
+
+static void *DynArray_realloc(const struct Allocator *psAllocator,
+                              void *pvBlock, size_t uOldSize,
+                              size_t uNewSize)
+{
+   if (psAllocator == NULL)
+      return realloc(pvBlock, uNewSize);
+   return Allocator_realloc(psAllocator, pvBlock, uOldSize, uNewSize);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return pvBlock of uSize bytes, as DynArray_alloc would have
+   allocated it. */
+
+static void DynArray_release(const struct Allocator *psAllocator,
+                             void *pvBlock, size_t uSize)
+{
+   if (psAllocator == NULL)
+      free(pvBlock);
+   else
+      Allocator_free(psAllocator, pvBlock, uSize);
+}
+
+/*--------------------------------------------------------------------*/
+
 #ifndef NDEBUG
 
 /* Check the invariants of oDynArray.  Return 1 (TRUE) iff oDynArray
@@ -66,7 +114,10 @@ static int DynArray_grow(DynArray_T oDynArray)
    uNewLength = GROWTH_FACTOR * oDynArray->uPhysLength;
 
    ppvNewArray = (const void**)
-      realloc(oDynArray->ppvArray, sizeof(void*) * uNewLength);
+      DynArray_realloc(oDynArray->psAllocator,
+                       (void*)oDynArray->ppvArray,
+                       sizeof(void*) * oDynArray->uPhysLength,
+                       sizeof(void*) * uNewLength);
    if (ppvNewArray == NULL)
       return 0;
 
@@ -78,12 +129,22 @@ static int DynArray_grow(DynArray_T oDynArray)
 /*--------------------------------------------------------------------*/
 
 DynArray_T DynArray_new(size_t uLength)
+{
+   return DynArray_newWith(uLength, NULL);
+}
+
+/*--------------------------------------------------------------------*/
+
+DynArray_T DynArray_newWith(size_t uLength,
+                            const struct Allocator *psAllocator)
 {
    DynArray_T oDynArray;
 
-   oDynArray = (struct DynArray*)malloc(sizeof(struct DynArray));
+   oDynArray = (struct DynArray*)
+      DynArray_alloc(psAllocator, sizeof(struct DynArray));
    if (oDynArray == NULL)
       return NULL;
+   oDynArray->psAllocator = psAllocator;
 
    oDynArray->uLength = uLength;
    if (uLength > MIN_PHYS_LENGTH)
@@ -91,13 +152,17 @@ DynArray_T DynArray_new(size_t uLength)
    else
       oDynArray->uPhysLength = MIN_PHYS_LENGTH;
 
-   oDynArray->ppvArray =
-      (const void**)calloc(oDynArray->uPhysLength, sizeof(void*));
+   oDynArray->ppvArray = (const void**)
+      DynArray_alloc(psAllocator,
+                     sizeof(void*) * oDynArray->uPhysLength);
    if (oDynArray->ppvArray == NULL)
    {
-      free(oDynArray);
+      DynArray_release(psAllocator, oDynArray,
+                       sizeof(struct DynArray));
       return NULL;
    }
+   memset(oDynArray->ppvArray, 0,
+          sizeof(void*) * oDynArray->uPhysLength);
 
    return oDynArray;
 }
@@ -109,8 +174,11 @@ void DynArray_free(DynArray_T oDynArray)
    assert(oDynArray != NULL);
    assert(DynArray_isValid(oDynArray));
 
-   free(oDynArray->ppvArray);
-   free(oDynArray);
+   DynArray_release(oDynArray->psAllocator,
+                    (void*)oDynArray->ppvArray,
+                    sizeof(void*) * oDynArray->uPhysLength);
+   DynArray_release(oDynArray->psAllocator, oDynArray,
+                    sizeof(struct DynArray));
 }
 
 /*--------------------------------------------------------------------*/
@@ -200,6 +268,79 @@ int DynArray_addAt(DynArray_T oDynArray, size_t uIndex,
 
 /*--------------------------------------------------------------------*/
 
+int DynArray_reserve(DynArray_T oDynArray, size_t uPhysLength)
+{
+   const void **ppvNewArray;
+
+   assert(oDynArray != NULL);
+   assert(DynArray_isValid(oDynArray));
+
+   if (uPhysLength <= oDynArray->uPhysLength)
+      return 1;
+
+   ppvNewArray = (const void**)
+      DynArray_realloc(oDynArray->psAllocator,
+                       (void*)oDynArray->ppvArray,
+                       sizeof(void*) * oDynArray->uPhysLength,
+                       sizeof(void*) * uPhysLength);
+   if (ppvNewArray == NULL)
+      return 0;
+
+   oDynArray->uPhysLength = uPhysLength;
+   oDynArray->ppvArray = ppvNewArray;
+
+   assert(DynArray_isValid(oDynArray));
+
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+int DynArray_addAllSorted(DynArray_T oDynArray,
+                          const void **ppvElements, size_t uCount,
+                          int (*pfCompare)(const void *pvElement1,
+                                           const void *pvElement2))
+{
+   size_t uOld;
+   size_t uNew;
+   size_t uOut;
+
+   assert(oDynArray != NULL);
+   assert(ppvElements != NULL || uCount == 0);
+   assert(pfCompare != NULL);
+   assert(DynArray_isValid(oDynArray));
+
+   if (uCount == 0)
+      return 1;
+
+   if (oDynArray->uLength + uCount > oDynArray->uPhysLength)
+      if (! DynArray_reserve(oDynArray, oDynArray->uLength + uCount))
+         return 0;
+
+   /* Merge from the back, so that no element is moved more than
+      once.  uOld, uNew, and uOut count the elements not yet placed.
+      On ties, the old element stays first. */
+   uOld = oDynArray->uLength;
+   uNew = uCount;
+   uOut = uOld + uNew;
+   while (uNew > 0)
+   {
+      if (uOld > 0
+          && (*pfCompare)(oDynArray->ppvArray[uOld-1],
+                          ppvElements[uNew-1]) > 0)
+         oDynArray->ppvArray[--uOut] = oDynArray->ppvArray[--uOld];
+      else
+         oDynArray->ppvArray[--uOut] = ppvElements[--uNew];
+   }
+   oDynArray->uLength += uCount;
+
+   assert(DynArray_isValid(oDynArray));
+
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
 void *DynArray_removeAt(DynArray_T oDynArray, size_t uIndex)
 {
    const void *pvOldElement;
@@ -253,27 +394,144 @@ void DynArray_map(DynArray_T oDynArray,
 
 /*--------------------------------------------------------------------*/
 
+/* Subarrays of at most this many elements are sorted by insertion
+   sort, which beats quicksort's partitioning overhead on them. */
+
+enum { INSERTION_SORT_MAX = 16 };
+
+/*--------------------------------------------------------------------*/
+
 /* Sort the array of elements that resides in memory at
    addresses ppvLo...ppvHi in ascending order, as determined
-   by *pfCompare.
+   by *pfCompare, using insertion sort.
    *pfCompare must return <0, 0, or >0 depending upon whether
    *pvElement1 is less than, equal to, or greater than *pvElement2,
    respectively. */
 
-static void DynArray_qsort(
+static void DynArray_insertionSort(
+   const void **ppvLo,
+   const void **ppvHi,
+   int (*pfCompare) (const void *pvElement1, const void *pvElement2))
+{
+   const void **ppvNext;
+   const void **ppvHole;
+   const void *pvElement;
+
+   assert(ppvLo != NULL);
+   assert(ppvHi != NULL);
+   assert(pfCompare != NULL);
+
+   for (ppvNext = ppvLo + 1; ppvNext <= ppvHi; ppvNext++)
+   {
+      pvElement = *ppvNext;
+      ppvHole = ppvNext;
+      while (ppvHole > ppvLo
+             && (*pfCompare)(pvElement, *(ppvHole - 1)) < 0)
+      {
+         *ppvHole = *(ppvHole - 1);
+         ppvHole--;
+      }
+      *ppvHole = pvElement;
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Restore the max-heap order of the uLength elements at ppvHeap,
+   whose subtrees below index uRoot are already heaps, by moving the
+   element at uRoot down, as determined by *pfCompare. */
+
+static void DynArray_siftDown(
+   const void **ppvHeap,
+   size_t uRoot,
+   size_t uLength,
+   int (*pfCompare) (const void *pvElement1, const void *pvElement2))
+{
+   const void *pvElement;
+   size_t uChild;
+
+   assert(ppvHeap != NULL);
+   assert(pfCompare != NULL);
+
+   pvElement = ppvHeap[uRoot];
+   while (uRoot < uLength / 2)
+   {
+      uChild = 2 * uRoot + 1;
+      if (uChild + 1 < uLength
+          && (*pfCompare)(ppvHeap[uChild], ppvHeap[uChild + 1]) < 0)
+         uChild++;
+      if ((*pfCompare)(pvElement, ppvHeap[uChild]) >= 0)
+         break;
+      ppvHeap[uRoot] = ppvHeap[uChild];
+      uRoot = uChild;
+   }
+   ppvHeap[uRoot] = pvElement;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Sort the array of elements that resides in memory at
+   addresses ppvLo...ppvHi in ascending order, as determined
+   by *pfCompare, using heapsort. */
+
+static void DynArray_heapsort(
    const void **ppvLo,
    const void **ppvHi,
    int (*pfCompare) (const void *pvElement1, const void *pvElement2))
 {
-   /* This function implements a variation of the quicksort algorithm
+   size_t uLength;
+   size_t u;
+   const void *pvTemp;
+
+   assert(ppvLo != NULL);
+   assert(ppvHi != NULL);
+   assert(pfCompare != NULL);
+
+   uLength = (size_t)(ppvHi - ppvLo) + 1;
+
+   for (u = uLength / 2; u > 0; u--)
+      DynArray_siftDown(ppvLo, u - 1, uLength, pfCompare);
+
+   for (u = uLength - 1; u > 0; u--)
+   {
+      /* Move the largest remaining element to the end. */
+      pvTemp = ppvLo[0];
+      ppvLo[0] = ppvLo[u];
+      ppvLo[u] = pvTemp;
+
+      DynArray_siftDown(ppvLo, 0, u, pfCompare);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Sort the array of elements that resides in memory at
+   addresses ppvLo...ppvHi in ascending order, as determined
+   by *pfCompare, using introsort: quicksort with median-of-three
+   pivots, switching to heapsort for a subarray that is still
+   unsorted after uDepthLimit levels of partitioning, and to
+   insertion sort for small subarrays.
+   *pfCompare must return <0, 0, or >0 depending upon whether
+   *pvElement1 is less than, equal to, or greater than *pvElement2,
+   respectively. */
+
+static void DynArray_introsort(
+   const void **ppvLo,
+   const void **ppvHi,
+   int (*pfCompare) (const void *pvElement1, const void *pvElement2),
+   size_t uDepthLimit)
+{
+   /* The partitioning is a variation of the quicksort algorithm
       shown in the book "Algorithms + Data Structures = Programs" by
-      Niklaus Wirth. */
+      Niklaus Wirth.  Elements equal to the pivot stop both scans, so
+      runs of equal elements are split evenly. */
 
    /* This function uses pointers instead of indices to avoid
       complications with using unsigned integers as array indices. */
 
    const void **ppvRight;
    const void **ppvLeft;
+   const void **ppvMid;
    const void *pvPivot;
    const void *pvTemp;
 
@@ -281,32 +539,83 @@ static void DynArray_qsort(
    assert(ppvHi != NULL);
    assert(pfCompare != NULL);
 
-   ppvRight = ppvLo;
-   ppvLeft = ppvHi;
-   pvPivot = *(ppvLo + ((ppvHi - ppvLo) / 2));
-
-   while (ppvRight <= ppvLeft)
+   while (ppvHi - ppvLo >= INSERTION_SORT_MAX)
    {
-      while ((*pfCompare)(*ppvRight, pvPivot) < 0)
-         ppvRight++;
-      while ((*pfCompare)(pvPivot, *ppvLeft) < 0)
-         ppvLeft--;
-      if (ppvRight <= ppvLeft)
+      if (uDepthLimit == 0)
+      {
+         DynArray_heapsort(ppvLo, ppvHi, pfCompare);
+         return;
+      }
+      uDepthLimit--;
+
+      /* Order *ppvLo, *ppvMid, and *ppvHi, and use the median as the
+         pivot.  The outer two then bound both scans. */
+      ppvMid = ppvLo + ((ppvHi - ppvLo) / 2);
+      if ((*pfCompare)(*ppvMid, *ppvLo) < 0)
+      {
+         pvTemp = *ppvMid; *ppvMid = *ppvLo; *ppvLo = pvTemp;
+      }
+      if ((*pfCompare)(*ppvHi, *ppvMid) < 0)
+      {
+         pvTemp = *ppvHi; *ppvHi = *ppvMid; *ppvMid = pvTemp;
+         if ((*pfCompare)(*ppvMid, *ppvLo) < 0)
+         {
+            pvTemp = *ppvMid; *ppvMid = *ppvLo; *ppvLo = pvTemp;
+         }
+      }
+      pvPivot = *ppvMid;
+
+      ppvRight = ppvLo + 1;
+      ppvLeft = ppvHi - 1;
+      while (ppvRight <= ppvLeft)
       {
-         /* Swap *ppvRight and *ppvLeft. */
-         pvTemp = *ppvRight;
-         *ppvRight = *ppvLeft;
-         *ppvLeft = pvTemp;
+         while ((*pfCompare)(*ppvRight, pvPivot) < 0)
+            ppvRight++;
+         while ((*pfCompare)(pvPivot, *ppvLeft) < 0)
+            ppvLeft--;
+         if (ppvRight <= ppvLeft)
+         {
+            /* Swap *ppvRight and *ppvLeft. */
+            pvTemp = *ppvRight;
+            *ppvRight = *ppvLeft;
+            *ppvLeft = pvTemp;
+
+            ppvRight++;
+            ppvLeft--;
+         }
+      }
 
-         ppvRight++;
-         ppvLeft--;
+      /* Recurse on the smaller side and loop on the larger, so that
+         the stack depth is at most logarithmic. */
+      if (ppvLeft - ppvLo < ppvHi - ppvRight)
+      {
+         DynArray_introsort(ppvLo, ppvLeft, pfCompare, uDepthLimit);
+         ppvLo = ppvRight;
+      }
+      else
+      {
+         DynArray_introsort(ppvRight, ppvHi, pfCompare, uDepthLimit);
+         ppvHi = ppvLeft;
       }
    }
 
-   if (ppvLo < ppvLeft)
-      DynArray_qsort(ppvLo, ppvLeft, pfCompare);
-   if (ppvRight < ppvHi)
-      DynArray_qsort(ppvRight, ppvHi, pfCompare);
+   if (ppvLo < ppvHi)
+      DynArray_insertionSort(ppvLo, ppvHi, pfCompare);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the number of levels of partitioning that introsort allows
+   an array of uLength elements before falling back to heapsort:
+   2 * floor(log2(uLength)). */
+
+static size_t DynArray_depthLimit(size_t uLength)
+{
+   size_t uDepthLimit = 0;
+
+   for (; uLength > 1; uLength /= 2)
+      uDepthLimit += 2;
+   return uDepthLimit;
 }
 
 /*--------------------------------------------------------------------*/
@@ -322,10 +631,299 @@ void DynArray_sort(DynArray_T oDynArray,
    if (oDynArray->uLength < 2)
       return;
 
-   DynArray_qsort(
+   DynArray_introsort(
       &oDynArray->ppvArray[0],
       &oDynArray->ppvArray[oDynArray->uLength-1],
-      pfCompare);
+      pfCompare, DynArray_depthLimit(oDynArray->uLength));
+
+   assert(DynArray_isValid(oDynArray));
+}
+
+/*--------------------------------------------------------------------*/
+
+/* DynArray_sortParallel does not give a thread fewer elements than
+   this to sort, as starting the thread would cost more than it
+   saves. */
+
+enum { PARALLEL_SORT_MIN_PIECE = 4096 };
+
+/* A piece of DynArray_sortParallel's work for one thread: sorting
+   the uLength elements at ppvLo, or producing elements
+   uOutLo...uOutHi-1 of the stable merge of the uALength elements at
+   ppvA with the uBLength elements at ppvB into the array ppvOut. */
+
+struct DynArraySortTask
+{
+   /* 1 (TRUE) for a merge, 0 (FALSE) for a sort. */
+   int iMerge;
+
+   /* The elements to sort, and their number. */
+   const void **ppvLo;
+   size_t uLength;
+
+   /* The runs to merge, and their lengths. */
+   const void **ppvA;
+   size_t uALength;
+   const void **ppvB;
+   size_t uBLength;
+
+   /* The array to merge into, and the range of it to produce. */
+   const void **ppvOut;
+   size_t uOutLo;
+   size_t uOutHi;
+
+   /* The comparison function. */
+   int (*pfCompare)(const void *pvElement1, const void *pvElement2);
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Return the number of elements of the uALength elements at ppvA
+   among the first uOut elements of the stable merge of those with
+   the uBLength elements at ppvB, as determined by *pfCompare.  Ties
+   go to ppvA, so the merge of two sorted runs is the same however
+   its output is divided. */
+
+static size_t DynArray_coRank(
+   size_t uOut,
+   const void **ppvA, size_t uALength,
+   const void **ppvB, size_t uBLength,
+   int (*pfCompare) (const void *pvElement1, const void *pvElement2))
+{
+   size_t uLo;
+   size_t uHi;
+   size_t uMid;
+
+   assert(uOut <= uALength + uBLength);
+
+   uLo = (uOut > uBLength) ? uOut - uBLength : 0;
+   uHi = (uOut < uALength) ? uOut : uALength;
+
+   /* Find the least count of elements of ppvA such that the next
+      element of ppvB to be taken does not belong before the next
+      element of ppvA. */
+   while (uLo < uHi)
+   {
+      uMid = uLo + (uHi - uLo) / 2;
+      if ((*pfCompare)(ppvB[uOut - uMid - 1], ppvA[uMid]) >= 0)
+         uLo = uMid + 1;
+      else
+         uHi = uMid;
+   }
+   return uLo;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Do the work described by pvTask, a struct DynArraySortTask.
+   Return NULL.  The signature is that of a pthread start routine. */
+
+static void *DynArray_runSortTask(void *pvTask)
+{
+   struct DynArraySortTask *psTask = (struct DynArraySortTask*)pvTask;
+   size_t uA;
+   size_t uAEnd;
+   size_t uB;
+   size_t uBEnd;
+   const void **ppvOut;
+
+   assert(psTask != NULL);
+
+   if (! psTask->iMerge)
+   {
+      if (psTask->uLength >= 2)
+         DynArray_introsort(psTask->ppvLo,
+                            psTask->ppvLo + psTask->uLength - 1,
+                            psTask->pfCompare,
+                            DynArray_depthLimit(psTask->uLength));
+      return NULL;
+   }
+
+   uA = DynArray_coRank(psTask->uOutLo,
+                        psTask->ppvA, psTask->uALength,
+                        psTask->ppvB, psTask->uBLength,
+                        psTask->pfCompare);
+   uB = psTask->uOutLo - uA;
+   uAEnd = DynArray_coRank(psTask->uOutHi,
+                           psTask->ppvA, psTask->uALength,
+                           psTask->ppvB, psTask->uBLength,
+                           psTask->pfCompare);
+   uBEnd = psTask->uOutHi - uAEnd;
+
+   ppvOut = psTask->ppvOut + psTask->uOutLo;
+   while (uA < uAEnd && uB < uBEnd)
+   {
+      if ((*psTask->pfCompare)(psTask->ppvB[uB], psTask->ppvA[uA]) < 0)
+         *ppvOut++ = psTask->ppvB[uB++];
+      else
+         *ppvOut++ = psTask->ppvA[uA++];
+   }
+   while (uA < uAEnd)
+      *ppvOut++ = psTask->ppvA[uA++];
+   while (uB < uBEnd)
+      *ppvOut++ = psTask->ppvB[uB++];
+   return NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Do the uTasks tasks in psTasks concurrently, each in its own
+   thread, using the threads in ptThreads.  A task whose thread cannot
+   be started is done by the calling thread. */
+
+static void DynArray_runSortTasks(struct DynArraySortTask *psTasks,
+                                  size_t uTasks, pthread_t *ptThreads)
+{
+   size_t u;
+   char *pcStarted;
+   char acStarted[64];
+
+   assert(psTasks != NULL);
+   assert(ptThreads != NULL);
+   assert(uTasks > 0);
+
+   pcStarted = (uTasks <= sizeof(acStarted)) ?
+      acStarted : (char*)calloc(uTasks, 1);
+
+   /* The calling thread does the first task itself. */
+   for (u = 1; u < uTasks; u++)
+   {
+      if (pcStarted != NULL
+          && pthread_create(&ptThreads[u], NULL, DynArray_runSortTask,
+                            &psTasks[u]) == 0)
+         pcStarted[u] = 1;
+      else
+      {
+         if (pcStarted != NULL)
+            pcStarted[u] = 0;
+         (void)DynArray_runSortTask(&psTasks[u]);
+      }
+   }
+   (void)DynArray_runSortTask(&psTasks[0]);
+
+   for (u = 1; u < uTasks; u++)
+      if (pcStarted != NULL && pcStarted[u])
+         (void)pthread_join(ptThreads[u], NULL);
+
+   if (pcStarted != acStarted)
+      free(pcStarted);
+}
+
+/*--------------------------------------------------------------------*/
+
+void DynArray_sortParallel(DynArray_T oDynArray,
+                           int (*pfCompare)(const void *pvElement1,
+                                            const void *pvElement2),
+                           size_t uThreads)
+{
+   size_t uLength;
+   size_t uRuns;
+   size_t uGroups;
+   size_t uParts;
+   size_t uTasks;
+   size_t uGroupLength;
+   size_t u;
+   size_t uPart;
+   const void **ppvSrc;
+   const void **ppvDst;
+   const void **ppvTemp;
+   const void **ppvScratch;
+   size_t *puBounds;
+   struct DynArraySortTask *psTasks;
+   pthread_t *ptThreads;
+
+   assert(oDynArray != NULL);
+   assert(pfCompare != NULL);
+   assert(DynArray_isValid(oDynArray));
+
+   uLength = oDynArray->uLength;
+   if (uThreads > uLength / PARALLEL_SORT_MIN_PIECE)
+      uThreads = uLength / PARALLEL_SORT_MIN_PIECE;
+   if (uThreads <= 1)
+   {
+      DynArray_sort(oDynArray, pfCompare);
+      return;
+   }
+
+   ppvScratch = (const void**)malloc(sizeof(void*) * uLength);
+   puBounds = (size_t*)malloc(sizeof(size_t) * (uThreads + 1));
+   psTasks = (struct DynArraySortTask*)
+      calloc(uThreads, sizeof(struct DynArraySortTask));
+   ptThreads = (pthread_t*)malloc(sizeof(pthread_t) * uThreads);
+   if (ppvScratch == NULL || puBounds == NULL || psTasks == NULL
+       || ptThreads == NULL)
+   {
+      free(ppvScratch);
+      free(puBounds);
+      free(psTasks);
+      free(ptThreads);
+      DynArray_sort(oDynArray, pfCompare);
+      return;
+   }
+
+   /* Sort uThreads runs of nearly equal length in place. */
+   for (u = 0; u <= uThreads; u++)
+      puBounds[u] = uLength / uThreads * u
+         + (uLength % uThreads) * u / uThreads;
+   for (u = 0; u < uThreads; u++)
+   {
+      psTasks[u].iMerge = 0;
+      psTasks[u].ppvLo = &oDynArray->ppvArray[puBounds[u]];
+      psTasks[u].uLength = puBounds[u + 1] - puBounds[u];
+      psTasks[u].pfCompare = pfCompare;
+   }
+   DynArray_runSortTasks(psTasks, uThreads, ptThreads);
+
+   /* Merge adjacent pairs of runs until one is left, dividing the
+      threads among the pairs.  A last unpaired run is merged with
+      an empty one, which copies it. */
+   ppvSrc = oDynArray->ppvArray;
+   ppvDst = ppvScratch;
+   for (uRuns = uThreads; uRuns > 1; uRuns = uGroups)
+   {
+      uGroups = (uRuns + 1) / 2;
+      uParts = uThreads / uGroups;
+      uTasks = 0;
+      for (u = 0; u < uGroups; u++)
+      {
+         uGroupLength = puBounds[(2 * u + 2 <= uRuns) ? 2 * u + 2
+                                 : uRuns] - puBounds[2 * u];
+         for (uPart = 0; uPart < uParts; uPart++)
+         {
+            psTasks[uTasks].iMerge = 1;
+            psTasks[uTasks].ppvA = ppvSrc + puBounds[2 * u];
+            psTasks[uTasks].uALength =
+               puBounds[2 * u + 1] - puBounds[2 * u];
+            psTasks[uTasks].ppvB = ppvSrc + puBounds[2 * u + 1];
+            psTasks[uTasks].uBLength =
+               uGroupLength - psTasks[uTasks].uALength;
+            psTasks[uTasks].ppvOut = ppvDst + puBounds[2 * u];
+            psTasks[uTasks].uOutLo = uGroupLength * uPart / uParts;
+            psTasks[uTasks].uOutHi =
+               uGroupLength * (uPart + 1) / uParts;
+            psTasks[uTasks].pfCompare = pfCompare;
+            uTasks++;
+         }
+      }
+      DynArray_runSortTasks(psTasks, uTasks, ptThreads);
+
+      /* The merged runs start where every other old run did. */
+      for (u = 0; u < uGroups; u++)
+         puBounds[u] = puBounds[2 * u];
+      puBounds[uGroups] = uLength;
+
+      ppvTemp = ppvSrc;
+      ppvSrc = ppvDst;
+      ppvDst = ppvTemp;
+   }
+
+   if (ppvSrc != oDynArray->ppvArray)
+      memcpy(oDynArray->ppvArray, ppvSrc, sizeof(void*) * uLength);
+
+   free(ppvScratch);
+   free(puBounds);
+   free(psTasks);
+   free(ptThreads);
 
    assert(DynArray_isValid(oDynArray));
 }
@@ -7,6 +7,7 @@
 #define DYNARRAY_INCLUDED
 
 #include <stddef.h>
+#include "allocator.h"
 
 /* A DynArray_T object is an array whose length can expand
    dynamically. */
@@ -22,6 +23,17 @@ DynArray_T DynArray_new(size_t uLength);
 
 /*--------------------------------------------------------------------*/
 
+/* Return a new DynArray_T object whose length is uLength, which
+   takes its memory from psAllocator rather than from malloc, or NULL
+   if insufficient memory is available.  psAllocator must remain
+   valid until the object is freed; if it is NULL, malloc is used,
+   as by DynArray_new. */
+
+DynArray_T DynArray_newWith(size_t uLength,
+                            const struct Allocator *psAllocator);
+
+/*--------------------------------------------------------------------*/
+
 /* Free oDynArray. */
 
 void DynArray_free(DynArray_T oDynArray);
@@ -65,6 +77,32 @@ int DynArray_addAt(DynArray_T oDynArray, size_t uIndex,
 
 /*--------------------------------------------------------------------*/
 
+/* Make the physical length of oDynArray at least uPhysLength, so that
+   it can hold that many elements without growing.  Return 1 (TRUE) if
+   successful, or 0 (FALSE) if insufficient memory is available. */
+
+int DynArray_reserve(DynArray_T oDynArray, size_t uPhysLength);
+
+/*--------------------------------------------------------------------*/
+
+/* Add the uCount elements at ppvElements to oDynArray, merging them
+   into place in a single pass with at most one allocation.  Both
+   oDynArray and ppvElements must be sorted as determined by
+   *pfCompare, and oDynArray remains so; an added element equal to an
+   old one goes after it.  Return 1 (TRUE) if successful, or 0 (FALSE)
+   if insufficient memory is available, in which case oDynArray is
+   unchanged.
+   *pfCompare must return <0, 0, or >0 depending upon whether
+   *pvElement1 is less than, equal to, or greater than *pvElement2,
+   respectively. */
+
+int DynArray_addAllSorted(DynArray_T oDynArray,
+                          const void **ppvElements, size_t uCount,
+                          int (*pfCompare)(const void *pvElement1,
+                                           const void *pvElement2));
+
+/*--------------------------------------------------------------------*/
+
 /* Remove and return the uIndex'th element of oDynArray. */
 
 void *DynArray_removeAt(DynArray_T oDynArray, size_t uIndex);
@@ -100,6 +138,22 @@ void DynArray_sort(DynArray_T oDynArray,
 
 /*--------------------------------------------------------------------*/
 
+/* Sort oDynArray in the order determined by *pfCompare, as
+   DynArray_sort does, using up to uThreads threads: each sorts a
+   piece of oDynArray, and then the pieces are merged, each merge
+   divided among the threads.  *pfCompare must be safe to call from
+   several threads at once.  If *pfCompare defines a total order, the
+   result is the same as that of DynArray_sort.  Small arrays, and
+   arrays for which the scratch memory cannot be allocated, are
+   sorted by DynArray_sort alone. */
+
+void DynArray_sortParallel(DynArray_T oDynArray,
+                           int (*pfCompare)(const void *pvElement1,
+                                            const void *pvElement2),
+                           size_t uThreads);
+
+/*--------------------------------------------------------------------*/
+
 /* Linear search oDynArray for *pvSoughtElement using *pfCompare to
    determine equality.  If the element is found, then assign its
    index to *puIndex and return 1.  If the element is not found, then
@@ -3,14 +3,33 @@
 /* Author: Alina Chen and Nickolas Casalinuovo                        */
 /*--------------------------------------------------------------------*/
 
+/* for clock_gettime and pthreads */
+#define _POSIX_C_SOURCE 200112L
+
 #include <assert.h>
+#include <limits.h>
+#include <pthread.h>
 #include <string.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <stdlib.h>
+#include <time.h>
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#endif
 
+#include "allocator.h"
+#include "arena.h"
 #include "dynarray.h"
+#include "pathcache.h"
+#include "bloom.h"
+#include "pathsplit.h"
 #include "ft.h"
 #include "node.h"
+#include "checkerFT.h"
+
+/* The number of path components split out at a time. */
+enum { PATH_SPANS = 32 };
 
 /* A File Tree is an AO with 3 state variables: */
 /* a flag for if it is in an initialized state (TRUE) or not (FALSE) */
@@ -19,6 +38,413 @@ static boolean isInitialized;
 static Node_T root;
 /* a counter of the number of nodes in the hierarchy */
 static size_t count;
+/* a flag for if file contents are copied into and owned by the tree
+   (TRUE) or borrowed from the client (FALSE) */
+static boolean ownsContents;
+/* the source of the memory of the nodes and the handle table,
+   fixed while the tree is initialized */
+static const struct Allocator* treeAllocator = &Allocator_heap;
+/* the region the nodes were moved to by FT_compact, or NULL if they
+   come from treeAllocator */
+static Arena_T treeArena;
+
+/* the cache of recent exact-path lookups (NULL for absent paths),
+   or NULL if lookups are not cached */
+static PathCache_T lookupCache;
+
+/* The number of entries in the lookup cache created by FT_init. */
+enum { DEFAULT_LOOKUP_CACHE_SIZE = 4096 };
+
+/* a counting Bloom filter over the full paths of all nodes, which
+   lets lookups of most absent paths return without a traversal,
+   or NULL if there is no filter */
+static Bloom_T pathFilter;
+/* the number of lookups the filter answered as absent */
+static size_t filterRejects;
+/* the number of lookups the filter passed on to the traversal */
+static size_t filterPasses;
+/* the number of passed lookups that found no node */
+static size_t filterFalsePositives;
+/* the number of times the filter was rebuilt because the tree
+   outgrew it */
+static size_t filterRebuilds;
+
+/* Nodes opened with FT_open are named by slots in a handle table. */
+
+/* An FT_Handle holds a slot index in its low HANDLE_INDEX_BITS bits
+   and the slot's generation in the remaining bits. */
+enum { HANDLE_INDEX_BITS = sizeof(FT_Handle) * CHAR_BIT / 2 };
+
+/* A slot of the handle table */
+struct FT_HandleSlot {
+    /* the node named by the slot, or NULL if the slot is free */
+    Node_T node;
+    /* the generation a handle must carry to name node,
+       or 0 if the slot is free */
+    size_t gen;
+    /* if the slot is free, the index + 1 of the next free slot,
+       or 0 if there is none */
+    size_t nextFree;
+};
+
+/* the handle table: a DynArray of struct FT_HandleSlot pointers,
+   or NULL if no handle has been opened since initialization */
+static DynArray_T handleSlots;
+/* the index + 1 of the first free slot, or 0 if there is none */
+static size_t freeHandleSlot;
+/* the number of slots currently naming a node */
+static size_t openHandles;
+/* the generation given to the next slot filled; never reset, so that
+   a handle from before FT_destroy is not valid after FT_init */
+static size_t nextHandleGen = 1;
+
+#ifndef NDEBUG
+
+/* The tree is checked after every FT_SAMPLE_PERIOD'th change to it,
+   by a sample of about FT_SAMPLE_BUDGET nodes. */
+enum { FT_SAMPLE_PERIOD = 256, FT_SAMPLE_BUDGET = 16 };
+
+/* the number of changes made so far, for checking only */
+static size_t changes;
+
+/*
+   Returns TRUE if the tree is valid, as far as a sample checked every
+   FT_SAMPLE_PERIOD calls shows, or FALSE otherwise. Called after each
+   change to the tree, so that checking can stay enabled for trees of
+   any size; CheckerFT_isValid checks the whole tree.
+*/
+static boolean FT_isValid(void) {
+    if(++changes % FT_SAMPLE_PERIOD != 0)
+        return TRUE;
+    return CheckerFT_isValidSample(isInitialized, root, count,
+                                   FT_SAMPLE_BUDGET);
+}
+
+#endif
+
+/* Calls are counted in a set of counters per thread, so that threads
+   never write to the same counters. */
+
+#ifdef __GNUC__
+#define FT_THREAD_LOCAL __thread
+#else
+/* without thread-local storage, threads share one set of counters */
+#define FT_THREAD_LOCAL
+#endif
+
+/* The counters of the calls made by a thread */
+struct FT_ThreadStats {
+    /* the counters of each operation, as reported by FT_getStats */
+    struct FT_OpStats ops[FT_OPS];
+    /* nodes visited so far by the call in progress */
+    size_t visits;
+    /* the state of the generator that picks the calls to time */
+    uint32_t timingState;
+    /* the call in progress, if it is being traced */
+    struct FT_TraceEvent event;
+    /* TRUE if the call in progress is being traced */
+    boolean traced;
+    /* TRUE while a running thread counts its calls here */
+    boolean inUse;
+    /* the next set of counters in statsList */
+    struct FT_ThreadStats* next;
+};
+
+/* every set of counters ever created; sets are never freed, and a
+   set whose thread has exited is reused by the next new thread */
+static struct FT_ThreadStats* statsList;
+/* the lock on statsList and on the inUse fields of its sets */
+static pthread_mutex_t statsLock = PTHREAD_MUTEX_INITIALIZER;
+/* the key whose destructor gives up a thread's set when it exits */
+static pthread_key_t statsKey;
+/* makes sure statsKey is created once */
+static pthread_once_t statsKeyOnce = PTHREAD_ONCE_INIT;
+/* the calling thread's counters, or NULL until its first call */
+static FT_THREAD_LOCAL struct FT_ThreadStats* threadStats;
+
+/* TRUE if a trace hook is registered */
+static boolean tracing;
+/* the hooks called as each call starts and returns, or NULL */
+static FT_TraceHook preHook;
+static FT_TraceHook postHook;
+/* the context passed to the hooks */
+static void* hookContext;
+
+/* The names of the functions counted, indexed by enum FT_Op. */
+static const char* const opNames[FT_OPS] = {
+    "FT_insertDir", "FT_containsDir", "FT_rmDir",
+    "FT_insertFile", "FT_insertFiles", "FT_containsFile",
+    "FT_rmFile", "FT_getFileContents",
+    "FT_replaceFileContents", "FT_readFileRange",
+    "FT_writeFileRange", "FT_appendFile", "FT_stat", "FT_open",
+    "FT_getFileContentsH", "FT_replaceFileContentsH",
+    "FT_statH", "FT_insertFileAt", "FT_containsAt",
+    "FT_rmFileAt", "FT_toString", "FT_init", "FT_initOwned",
+    "FT_destroy", "FT_compact"
+};
+
+/* Marks the set of counters threadSet as free for reuse. */
+static void FT_releaseThreadStats(void* threadSet) {
+    (void) pthread_mutex_lock(&statsLock);
+    ((struct FT_ThreadStats*) threadSet)->inUse = FALSE;
+    (void) pthread_mutex_unlock(&statsLock);
+}
+
+/* Creates statsKey. */
+static void FT_createStatsKey(void) {
+    (void) pthread_key_create(&statsKey, FT_releaseThreadStats);
+}
+
+/*
+   Returns the calling thread's counters, first taking a free set or
+   creating one if the thread has none, or NULL if there is none and
+   one cannot be allocated, in which case the call is not counted.
+*/
+static struct FT_ThreadStats* FT_getThreadStats(void) {
+    struct FT_ThreadStats* set;
+
+    if(threadStats != NULL)
+        return threadStats;
+
+    (void) pthread_once(&statsKeyOnce, FT_createStatsKey);
+    (void) pthread_mutex_lock(&statsLock);
+    for(set = statsList; set != NULL; set = set->next)
+        if(!set->inUse) break;
+    if(set == NULL) {
+        set = calloc(1, sizeof(struct FT_ThreadStats));
+        if(set != NULL) {
+            set->next = statsList;
+            statsList = set;
+        }
+    }
+    if(set != NULL) {
+        set->inUse = TRUE;
+        if(set->timingState == 0)
+            set->timingState = 2463534242u;
+    }
+    (void) pthread_mutex_unlock(&statsLock);
+
+    if(set != NULL)
+        (void) pthread_setspecific(statsKey, set);
+    threadStats = set;
+    return set;
+}
+
+/* Returns the time of a monotonic clock, in nanoseconds. */
+static uint64_t FT_nanos(void) {
+    struct timespec now;
+
+    (void) clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000000u + (uint64_t) now.tv_nsec;
+}
+
+/* Returns the processor's cycle counter, or 0 if it has none that can
+   be read. */
+static uint64_t FT_ticks(void) {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    return (uint64_t) __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+/* Returns the latency histogram bucket that counts nanos. */
+static size_t FT_latencyBucket(uint64_t nanos) {
+    size_t shift = 0;
+    size_t bucket;
+
+    /* the first four buckets each hold one latency */
+    if(nanos < 4)
+        return (size_t) nanos;
+    /* then each power of two is split into four by the two bits
+       after its leading one */
+#ifdef __GNUC__
+    shift = (size_t) (63 - __builtin_clzll(nanos)) - 2;
+#else
+    while((nanos >> shift) >= 8)
+        shift++;
+#endif
+    bucket = (shift + 1) * 4 + (size_t) (nanos >> shift) - 4;
+    if(bucket >= FT_LATENCY_BUCKETS)
+        bucket = FT_LATENCY_BUCKETS - 1;
+    return bucket;
+}
+
+/*
+   Starts counting and tracing a call to op on the calling thread,
+   with the arguments path through lengths, as in struct
+   FT_TraceEvent, and calls the pre hook. Returns the time the call
+   started, or 0 if it cannot be counted.
+*/
+static uint64_t FT_beginTrace(enum FT_Op op, const char* path,
+                              FT_Handle handle, size_t offset,
+                              size_t length, char** names,
+                              size_t* lengths) {
+    struct FT_ThreadStats* set = FT_getThreadStats();
+    struct FT_TraceEvent* event;
+
+    if(set == NULL)
+        return 0;
+    set->visits = 0;
+    set->traced = TRUE;
+    event = &set->event;
+    event->op = op;
+    event->path = path;
+    event->handle = handle;
+    event->offset = offset;
+    event->length = length;
+    event->names = names;
+    event->lengths = lengths;
+    event->status = 0;
+    event->endNanos = 0;
+    event->endTicks = 0;
+    event->nodesVisited = 0;
+    if(preHook != NULL)
+        preHook(event, hookContext);
+    event->startTicks = FT_ticks();
+    event->startNanos = FT_nanos();
+    return event->startNanos;
+}
+
+/*
+   Finishes tracing the call in set, the calling thread's counters,
+   which is returning status and ended at end, and calls the post
+   hook.
+*/
+static void FT_endTrace(struct FT_ThreadStats* set, int status,
+                        uint64_t end) {
+    struct FT_TraceEvent* event = &set->event;
+
+    set->traced = FALSE;
+    event->endTicks = FT_ticks();
+    event->endNanos = end;
+    event->status = status;
+    event->nodesVisited = set->visits;
+    if(postHook != NULL)
+        postHook(event, hookContext);
+}
+
+/*
+   Starts counting a call on the calling thread, which is not traced.
+   Returns the time the call started, or 0 if the call is not to be
+   timed.
+*/
+static uint64_t FT_beginCount(void) {
+    struct FT_ThreadStats* set = FT_getThreadStats();
+
+    if(set == NULL)
+        return 0;
+    set->visits = 0;
+    /* a xorshift generator; its high bits pick the calls to time */
+    set->timingState ^= set->timingState << 13;
+    set->timingState ^= set->timingState >> 17;
+    set->timingState ^= set->timingState << 5;
+    if(set->timingState >> 16 < 65536u / FT_TIMING_PERIOD)
+        return FT_nanos();
+    return 0;
+}
+
+/*
+   Starts counting a call to op on the calling thread, with the
+   arguments path through lengths to be traced, as in struct
+   FT_TraceEvent. Returns the time the call started, to be passed to
+   FT_endOp, or 0 if the call is not to be timed. Small enough to be
+   inlined, so that the arguments are only passed when tracing.
+*/
+static inline uint64_t FT_beginOp(enum FT_Op op, const char* path,
+                                  FT_Handle handle, size_t offset,
+                                  size_t length, char** names,
+                                  size_t* lengths) {
+    if(tracing)
+        return FT_beginTrace(op, path, handle, offset, length, names,
+                             lengths);
+    return FT_beginCount();
+}
+
+/*
+   Counts a call to op, begun by FT_beginOp at start, that is returning
+   status, and returns status.
+*/
+static int FT_endOp(enum FT_Op op, int status, uint64_t start) {
+    struct FT_ThreadStats* set = threadStats;
+    struct FT_OpStats* counters;
+    uint64_t end;
+    uint64_t nanos;
+
+    if(set == NULL)
+        return status;
+    counters = &set->ops[op];
+    counters->calls++;
+    if(status >= 0 && status < FT_STATUSES)
+        counters->outcomes[status]++;
+    counters->nodesVisited += set->visits;
+    if(start != 0) {
+        end = FT_nanos();
+        nanos = end - start;
+        counters->timed++;
+        counters->totalNanos += (size_t) nanos;
+        counters->latencies[FT_latencyBucket(nanos)]++;
+        if(set->traced)
+            FT_endTrace(set, status, end);
+    }
+    return status;
+}
+
+/* Notes that the call to FT_open in progress on the calling thread
+   returns h, if it is being traced. */
+static void FT_noteOpened(FT_Handle h) {
+    if(threadStats != NULL && threadStats->traced)
+        threadStats->event.handle = h;
+}
+
+/* Counts a visit to a node by the calling thread's call in progress. */
+static void FT_noteVisit(void) {
+    if(threadStats != NULL)
+        threadStats->visits++;
+}
+
+/*
+   Starting at the parameter curr, follows the components of the
+   relative path rel as far down the hierarchy as they match,
+   looking each one up among the children of the node before it.
+
+   Returns a pointer to the farthest matching node down that path
+   (curr itself if no component matches, and never below a file),
+   and sets *rest to the part of rel below that node, which is the
+   empty string if every component matched.
+*/
+static Node_T FT_traverseRelative(const char* rel, Node_T curr,
+                                  const char** rest) {
+    struct PathSpan spans[PATH_SPANS];
+    const char* more;
+    Node_T child;
+    size_t n;
+    size_t i;
+
+    assert(rel != NULL);
+    assert(curr != NULL);
+    assert(rest != NULL);
+
+    for(;;) {
+        n = PathSplit_split(rel, spans, PATH_SPANS, &more);
+        for(i = 0; i < n && !isFile(curr); i++) {
+            FT_noteVisit();
+            child = Node_findChild(curr, rel + spans[i].uStart,
+                                   spans[i].uLength);
+            if(child == NULL) break;
+            curr = child;
+        }
+        if(i < n) {
+            *rest = rel + spans[i].uStart;
+            return curr;
+        }
+        if(more == NULL) {
+            *rest = rel + spans[n - 1].uStart + spans[n - 1].uLength;
+            return curr;
+        }
+        rel = more;
+    }
+}
 
 /*
    Starting at the parameter curr, traverses as far down
@@ -30,38 +456,60 @@ static size_t count;
    a prefix of the path
 */
 static Node_T FT_traversePathFrom(char* path, Node_T curr) {
-    Node_T found;
-    size_t i;
+    size_t len;
+    const char* rest;
 
     assert(path != NULL);
 
     if(curr == NULL)
         return NULL;
 
-    if(!strcmp(path,Node_getPath(curr)))
+    len = strlen(Node_getPath(curr));
+    if(strncmp(path, Node_getPath(curr), len))
+        return NULL;
+    if(path[len] == '\0')
         return curr;
+    /* curr's path must end at a component boundary of path */
+    if(path[len] != '/')
+        return NULL;
 
-    if(!strncmp(path, Node_getPath(curr), strlen(Node_getPath(curr)))) {
-        /* Loop through all directory children */
-        for(i = 0; i < Node_getNumDirChildren(curr); i++) {
-            /* Recur down directory children */
-            found = FT_traversePathFrom(path,
-                                        Node_getChildDirectory(curr, i));
-            /* If found, stop recursion */
-            if(found != NULL) return found;
-        }
-        /* Loop through all file children */
-        for(i = 0; i < Node_getNumFileChildren(curr); i++) {
-            /* Recur down file children  */
-            found = FT_traversePathFrom(path,
-                                        Node_getChildFile(curr, i));
-            /* If found, stop recursion */
-            if(found != NULL) return found;
+    return FT_traverseRelative(path + len + 1, curr, &rest);
+}
+
+/*
+   Returns the node whose path is exactly path, or NULL if there is
+   none. Returns NULL at once if the path filter rejects path.
+   Otherwise answers from the lookup cache when it has an entry for path,
+   and otherwise resolves path from the root and caches the result,
+   including an absent result.
+*/
+static Node_T FT_lookup(char* path) {
+    Node_T curr;
+    void* cached;
+
+    assert(path != NULL);
+
+    if(pathFilter != NULL) {
+        if(!Bloom_mayContain(pathFilter, path)) {
+            filterRejects++;
+            return NULL;
         }
+        filterPasses++;
+    }
 
-        return curr;
+    if(lookupCache != NULL && PathCache_get(lookupCache, path, &cached))
+        curr = cached;
+    else {
+        curr = FT_traversePathFrom(path, root);
+        if(curr != NULL && strcmp(path, Node_getPath(curr)))
+            curr = NULL;
+        if(lookupCache != NULL)
+            PathCache_put(lookupCache, path, curr);
     }
-    return NULL;
+
+    if(curr == NULL && pathFilter != NULL)
+        filterFalsePositives++;
+    return curr;
 }
 
 /*
@@ -84,15 +532,124 @@ static int FT_linkParentToChild(Node_T parent, Node_T child) {
 }
 
 /*
-   Inserts a new path into the tree rooted at parent, or, if
-   parent is NULL, as the root of the data structure.
+   Adds the path of n and of every node beneath it to filter.
+*/
+static void FT_addSubtreeToFilter(Bloom_T filter, Node_T n) {
+    size_t i;
 
-   Finds rest of path depending on nodeType type
-   the arguments contents and length are carried down to create the end node
+    assert(filter != NULL);
+    assert(n != NULL);
 
-   If a node representing path already exists, returns ALREADY_IN_TREE
+    Bloom_add(filter, Node_getPath(n));
+    for(i = 0; i < Node_getNumDirChildren(n); i++)
+        FT_addSubtreeToFilter(filter, Node_getChildDirectory(n, i));
+    for(i = 0; i < Node_getNumFileChildren(n); i++)
+        FT_addSubtreeToFilter(filter, Node_getChildFile(n, i));
+}
 
-   If a proper prefix of a path exists as a file, return NOT_A_DIRECTORY.
+/*
+   Returns a new path filter sized for twice the current number of
+   nodes and holding all their paths, or NULL if unable to allocate
+   it.
+*/
+static Bloom_T FT_buildFilter(void) {
+    Bloom_T filter;
+
+    filter = Bloom_new(2 * count);
+    if(filter == NULL) return NULL;
+    if(root != NULL) FT_addSubtreeToFilter(filter, root);
+    return filter;
+}
+
+/*
+   Records the chain of nodes just inserted starting at firstNew, in
+   which each node but the last has exactly one child: drops their
+   lookup cache entries, which can only be negative, and adds their
+   paths to the path filter. Rebuilds the filter, larger, once it
+   holds more paths than it was sized for; if that fails, the old one
+   is kept, and only lets more absent paths through.
+*/
+static void FT_noteNewChain(Node_T firstNew) {
+    Node_T n = firstNew;
+    Bloom_T filter;
+
+    if(lookupCache == NULL && pathFilter == NULL) return;
+
+    while(n != NULL) {
+        if(lookupCache != NULL)
+            PathCache_remove(lookupCache, Node_getPath(n));
+        if(pathFilter != NULL)
+            Bloom_add(pathFilter, Node_getPath(n));
+        if(Node_getNumDirChildren(n) > 0)
+            n = Node_getChildDirectory(n, 0);
+        else
+            n = Node_getChildFile(n, 0);
+    }
+
+    if(pathFilter != NULL
+       && Bloom_getCount(pathFilter) > Bloom_getCapacity(pathFilter)) {
+        filter = FT_buildFilter();
+        if(filter != NULL) {
+            Bloom_free(pathFilter);
+            pathFilter = filter;
+            filterRebuilds++;
+        }
+    }
+}
+
+/*
+   Creates a node named by the nameLength characters at name, of type
+   type, holding contents and
+   length if it is a file, as the child of *curr, or as the first of
+   a new chain of nodes if *firstNew is NULL, in which case it becomes
+   *firstNew. Then makes it *curr and counts it in *newCount.
+
+   If it cannot be created, returns MEMORY_ERROR. If it cannot be
+   linked, destroys it and returns PARENT_CHILD_ERROR. Otherwise,
+   returns SUCCESS.
+*/
+static int FT_extendChain(const char* name, size_t nameLength,
+                          nodeType type, void* contents, size_t length,
+                          Node_T* curr, Node_T* firstNew,
+                          size_t* newCount) {
+    Node_T new;
+    int result;
+
+    if(type == ISFILE) {
+        new = Node_create(name, nameLength, *curr, contents, length,
+                          ISFILE);
+        /* in owned mode the tree keeps its own copy */
+        if(new != NULL && ownsContents &&
+           setOwnedFileContents(new, contents, length) != SUCCESS) {
+            (void) Node_destroy(new, ISFILE);
+            new = NULL;
+        }
+    }
+    else
+        new = Node_create(name, nameLength, *curr, NULL, 0,
+                          ISDIRECTORY);
+    if(new == NULL)
+        return MEMORY_ERROR;
+
+    if(*firstNew == NULL)
+        *firstNew = new;
+    else {
+        /* on failure, new is already destroyed */
+        result = FT_linkParentToChild(*curr, new);
+        if(result != SUCCESS)
+            return result;
+    }
+    (*newCount)++;
+    *curr = new;
+    return SUCCESS;
+}
+
+/*
+   Inserts the relative path restPath below parent, or, if parent is
+   NULL, as the root of the data structure, creating a node for each
+   of its components. The last node is of type type, and the arguments
+   contents and length are carried down to create it if it is a file;
+   the others are directories. Empty components are skipped.
 
    If there is an allocation error in creating any of the new nodes or
    their fields, returns MEMORY_ERROR
@@ -102,15 +659,83 @@ static int FT_linkParentToChild(Node_T parent, Node_T child) {
 
    Otherwise, returns SUCCESS
 */
-static int FT_insertRestOfPath(char* path, Node_T parent, nodeType type, void* contents, size_t length) {
+static int FT_insertBelow(const char* restPath, Node_T parent,
+                          nodeType type, void* contents, size_t length) {
+    struct PathSpan spans[PATH_SPANS];
     Node_T curr = parent;
     Node_T firstNew = NULL;
-    Node_T new;
-    char* copyPath;
-    char* restPath = path;
-    char* dirToken;
-    int result;
+    const char* rel = restPath;
+    const char* more;
+    const char* pending = NULL;
+    size_t pendingLength = 0;
+    int result = SUCCESS;
     size_t newCount = 0;
+    size_t n;
+    size_t i;
+
+    assert(restPath != NULL);
+    assert(!isFile(parent));
+
+    /* each component, named in place by its span of restPath, becomes
+       a directory once another follows it */
+    do {
+        n = PathSplit_split(rel, spans, PATH_SPANS, &more);
+        for(i = 0; i < n && result == SUCCESS; i++) {
+            if(spans[i].uLength == 0)
+                continue;
+            if(pending != NULL)
+                result = FT_extendChain(pending, pendingLength,
+                                        ISDIRECTORY, NULL, 0, &curr,
+                                        &firstNew, &newCount);
+            pending = rel + spans[i].uStart;
+            pendingLength = spans[i].uLength;
+        }
+        rel = more;
+    } while(rel != NULL && result == SUCCESS);
+    if(pending != NULL && result == SUCCESS)
+        result = FT_extendChain(pending, pendingLength, type, contents,
+                                length, &curr, &firstNew, &newCount);
+
+    if(result != SUCCESS) {
+        if(firstNew != NULL)
+            (void) Node_destroy(firstNew, getType(firstNew));
+        return result;
+    }
+
+    if(parent == NULL) {
+        root = firstNew;
+        count = newCount;
+        FT_noteNewChain(firstNew);
+        assert(FT_isValid());
+        return SUCCESS;
+    }
+    /* link rest to parent */
+    result = FT_linkParentToChild(parent, firstNew);
+    if(result == SUCCESS) {
+        count += newCount;
+        FT_noteNewChain(firstNew);
+    }
+
+    assert(FT_isValid());
+    return result;
+}
+
+/*
+   Inserts a new path into the tree rooted at parent, or, if
+   parent is NULL, as the root of the data structure.
+
+   Finds rest of path depending on nodeType type
+   the arguments contents and length are carried down to create the end node
+
+   If a node representing path already exists, returns ALREADY_IN_TREE
+
+   If a proper prefix of a path exists as a file, return NOT_A_DIRECTORY.
+
+   Otherwise, returns as FT_insertBelow does
+*/
+static int FT_insertRestOfPath(char* path, Node_T parent, nodeType type, void* contents, size_t length) {
+    Node_T curr = parent;
+    char* restPath = path;
 
     assert(path != NULL);
 
@@ -128,107 +753,128 @@ static int FT_insertRestOfPath(char* path, Node_T parent, nodeType type, void* c
     }
     if(isFile(parent)) return NOT_A_DIRECTORY;
 
-    /* allocate memory for rest of path */
-    copyPath = malloc(strlen(restPath)+1);
-    if(copyPath == NULL)
-        return MEMORY_ERROR;
-    strcpy(copyPath, restPath);
-    dirToken = strtok(copyPath, "/");
-
-    /* while there are directories to visit */
-    while(dirToken != NULL) {
-        /* track next token */
-        char* nextToken = strtok(NULL, "/");
-        /* insert last file node */
-        if (type == ISFILE && nextToken == NULL){
-            new = Node_create(dirToken, curr, contents, length, ISFILE);
-        }
-        /* insert directory nodes */
-        else{
-            new = Node_create(dirToken, curr, NULL, 0, ISDIRECTORY);
-        }
-        /* add to new count */
-        newCount++;
-
-        if(firstNew == NULL)
-            firstNew = new;
-        else {
-            /* if not the first new child, link */
-            result = FT_linkParentToChild(curr, new);
-            if(result != SUCCESS) {
-                (void) Node_destroy(new, getType(new));
-                (void) Node_destroy(firstNew, getType(firstNew));
-                free(copyPath);
-                return result;
-            }
-        }
-        if(new == NULL) {
-            /* if new was not created */
-            (void) Node_destroy(firstNew, getType(firstNew));
-            free(copyPath);
-            return MEMORY_ERROR;
-        }
-
-        curr = new;
-        dirToken = nextToken;
-    }
-
-    free(copyPath);
-
-    if(parent == NULL) {
-        root = firstNew;
-        count = newCount;
-        return SUCCESS;
-    }
-    /* link rest to parent */
-    result = FT_linkParentToChild(parent, firstNew);
-    if(result == SUCCESS)
-        count += newCount;
-
-    return result;
+    return FT_insertBelow(restPath, parent, type, contents, length);
 }
 
 /*
   Returns TRUE if the tree contains the full path parameter as the type
-  given by the type parameter and FALSE otherwise.
+  given by the type parameter and FALSE otherwise. Sets *status to
+  SUCCESS, or to why it does not: INITIALIZATION_ERROR, NO_SUCH_PATH,
+  or NOT_A_FILE or NOT_A_DIRECTORY if path has the other type.
 */
-static boolean FT_contains(char *path, nodeType type){
+static boolean FT_contains(char *path, nodeType type, int *status){
     Node_T curr;
-    boolean result = FALSE;
 
     assert(path != NULL);
+    assert(status != NULL);
 
-    if(!isInitialized)
+    if(!isInitialized) {
+        *status = INITIALIZATION_ERROR;
         return FALSE;
+    }
 
-    curr = FT_traversePathFrom(path, root);
+    curr = FT_lookup(path);
     if(curr == NULL)
-        result = FALSE;
-    else if(strcmp(path, Node_getPath(curr)))
-        /*if(type==ISFILE && Node)*/
-        result = FALSE;
-    else{
-        if(getType(curr) == type) result = TRUE;
-        else result = FALSE;
-    }
+        *status = NO_SUCH_PATH;
+    else if(getType(curr) != type)
+        *status = type == ISFILE ? NOT_A_FILE : NOT_A_DIRECTORY;
+    else
+        *status = SUCCESS;
 
-    return result;
+    return *status == SUCCESS;
 }
 
+/* Does the work of FT_containsFile, without counting the call, and
+   sets *status as FT_contains does. */
+static boolean FT_doContainsFile(char *path, int *status){
+    assert(path != NULL);
+    return FT_contains(path, ISFILE, status);
+}
 
 boolean FT_containsFile(char *path){
-    assert(path != NULL);
-    return FT_contains(path, ISFILE);
+    uint64_t start;
+    boolean result;
+    int status;
+
+    start = FT_beginOp(FT_OP_CONTAINS_FILE, path, 0, 0, 0, NULL, NULL);
+    result = FT_doContainsFile(path, &status);
+    (void) FT_endOp(FT_OP_CONTAINS_FILE, status, start);
+    return result;
 }
 
+/* Does the work of FT_containsDir, without counting the call, and
+   sets *status as FT_contains does. */
+static boolean FT_doContainsDir(char *path, int *status) {
+    assert(path != NULL);
+    return FT_contains(path, ISDIRECTORY, status);
+}
 
 boolean FT_containsDir(char *path) {
-    assert(path != NULL);
-    return FT_contains(path, ISDIRECTORY);
+    uint64_t start;
+    boolean result;
+    int status;
+
+    start = FT_beginOp(FT_OP_CONTAINS_DIR, path, 0, 0, 0, NULL, NULL);
+    result = FT_doContainsDir(path, &status);
+    (void) FT_endOp(FT_OP_CONTAINS_DIR, status, start);
+    return result;
 }
 
 
-int FT_destroy(void){
+/*
+  Frees the handle slots of n and every node beneath it, so that
+  handles naming those nodes are no longer valid, and drops their
+  lookup cache entries and path filter entries.
+*/
+static void FT_forgetSubtree(Node_T n) {
+    struct FT_HandleSlot *slot;
+    size_t index;
+    size_t i;
+
+    assert(n != NULL);
+
+    if(lookupCache != NULL)
+        PathCache_remove(lookupCache, Node_getPath(n));
+    if(pathFilter != NULL)
+        Bloom_remove(pathFilter, Node_getPath(n));
+
+    index = Node_getHandle(n);
+    if(index != 0) {
+        slot = DynArray_get(handleSlots, index - 1);
+        slot->node = NULL;
+        slot->gen = 0;
+        slot->nextFree = freeHandleSlot;
+        freeHandleSlot = index;
+        Node_setHandle(n, 0);
+        openHandles--;
+    }
+
+    for(i = 0; i < Node_getNumDirChildren(n); i++)
+        FT_forgetSubtree(Node_getChildDirectory(n, i));
+    for(i = 0; i < Node_getNumFileChildren(n); i++)
+        FT_forgetSubtree(Node_getChildFile(n, i));
+}
+
+/*
+  Frees the handle table, invalidating every handle.
+*/
+static void FT_freeHandles(void) {
+    size_t i;
+
+    if(handleSlots == NULL) return;
+
+    for(i = 0; i < DynArray_getLength(handleSlots); i++)
+        Allocator_free(treeAllocator, DynArray_get(handleSlots, i),
+                       sizeof(struct FT_HandleSlot));
+    DynArray_free(handleSlots);
+    handleSlots = NULL;
+    freeHandleSlot = 0;
+    openHandles = 0;
+}
+
+/* Does the work of FT_destroy, without counting the call. */
+static int FT_doDestroy(void){
+    assert(CheckerFT_isValid(isInitialized, root, count));
     if(!isInitialized)
         return INITIALIZATION_ERROR;
     if(root != NULL) {
@@ -237,19 +883,66 @@ int FT_destroy(void){
     }
     root = NULL;
     isInitialized = 0;
+    ownsContents = FALSE;
+    if(treeArena != NULL) {
+        Arena_free(treeArena);
+        treeArena = NULL;
+    }
+    FT_freeHandles();
+    if(lookupCache != NULL) {
+        PathCache_free(lookupCache);
+        lookupCache = NULL;
+    }
+    if(pathFilter != NULL) {
+        Bloom_free(pathFilter);
+        pathFilter = NULL;
+    }
     return SUCCESS;
 }
 
-int FT_init(void){
+int FT_destroy(void){
+    uint64_t start;
+    int result;
+
+    start = FT_beginOp(FT_OP_DESTROY, NULL, 0, 0, 0, NULL, NULL);
+    result = FT_doDestroy();
+    return FT_endOp(FT_OP_DESTROY, result, start);
+}
+
+/* Does the work of FT_init, without counting the call. */
+static int FT_doInit(void){
     if(isInitialized)
         return INITIALIZATION_ERROR;
     isInitialized = 1;
     root = NULL;
     count = 0;
+    Node_setAllocator(treeAllocator);
+    /* without memory for a cache, lookups are simply not cached */
+    lookupCache = PathCache_new(DEFAULT_LOOKUP_CACHE_SIZE);
     return SUCCESS;
 }
 
-int FT_insertDir(char *path) {
+int FT_init(void){
+    uint64_t start;
+    int result;
+
+    start = FT_beginOp(FT_OP_INIT, NULL, 0, 0, 0, NULL, NULL);
+    result = FT_doInit();
+    return FT_endOp(FT_OP_INIT, result, start);
+}
+
+int FT_initOwned(void){
+    uint64_t start;
+    int result;
+
+    start = FT_beginOp(FT_OP_INIT_OWNED, NULL, 0, 0, 0, NULL, NULL);
+    result = FT_doInit();
+    if(result == SUCCESS) ownsContents = TRUE;
+    return FT_endOp(FT_OP_INIT_OWNED, result, start);
+}
+
+/* Does the work of FT_insertDir, without counting the call. */
+static int FT_doInsertDir(char *path) {
     Node_T curr;
     int result;
 
@@ -262,6 +955,37 @@ int FT_insertDir(char *path) {
     return result;
 }
 
+int FT_insertDir(char *path) {
+    uint64_t start;
+    int result;
+
+    start = FT_beginOp(FT_OP_INSERT_DIR, path, 0, 0, 0, NULL, NULL);
+    result = FT_doInsertDir(path);
+    return FT_endOp(FT_OP_INSERT_DIR, result, start);
+}
+
+/*
+  Removes the hierarchy rooted at curr, invalidating any handles
+  that name its nodes. If curr is the data structure's root, root
+  becomes NULL.
+ */
+static void FT_rmNode(Node_T curr) {
+    Node_T parent;
+
+    assert(curr != NULL);
+
+    parent = Node_getParent(curr);
+    if(parent == NULL)
+        root = NULL;
+    else
+        Node_unlinkChild(parent, curr);
+
+    if(openHandles > 0 || lookupCache != NULL || pathFilter != NULL)
+        FT_forgetSubtree(curr);
+    count -= Node_destroy(curr, getType(curr));
+    assert(FT_isValid());
+}
+
 /*
   Removes the hierarchy rooted at path starting from
   curr. If curr is the data structure's root, root becomes NULL.
@@ -270,27 +994,19 @@ int FT_insertDir(char *path) {
   and SUCCESS otherwise.
  */
 static int FT_rmPathAt(char* path, Node_T curr) {
-    Node_T parent;
-
     assert(path != NULL);
     assert(curr != NULL);
 
-    parent = Node_getParent(curr);
-
     if(!strcmp(path,Node_getPath(curr))) {
-        if(parent == NULL)
-            root = NULL;
-        else
-            Node_unlinkChild(parent, curr);
-
-        count -= Node_destroy(curr, getType(curr));
+        FT_rmNode(curr);
         return SUCCESS;
     }
     else
         return NO_SUCH_PATH;
 }
 
-int FT_rmDir(char *path){
+/* Does the work of FT_rmDir, without counting the call. */
+static int FT_doRmDir(char *path){
     Node_T curr;
     int result;
 
@@ -299,8 +1015,8 @@ int FT_rmDir(char *path){
     if(!isInitialized)
         return INITIALIZATION_ERROR;
 
-    curr = FT_traversePathFrom(path, root);
-    if(curr == NULL || strcmp(Node_getPath(curr), path))
+    curr = FT_lookup(path);
+    if(curr == NULL)
         result =  NO_SUCH_PATH;
     else if(isFile(curr)) result = NOT_A_DIRECTORY;
     else
@@ -309,8 +1025,18 @@ int FT_rmDir(char *path){
     return result;
 }
 
-int FT_insertFile(char *path, void *contents, size_t length){
-    Node_T curr;
+int FT_rmDir(char *path){
+    uint64_t start;
+    int result;
+
+    start = FT_beginOp(FT_OP_RM_DIR, path, 0, 0, 0, NULL, NULL);
+    result = FT_doRmDir(path);
+    return FT_endOp(FT_OP_RM_DIR, result, start);
+}
+
+/* Does the work of FT_insertFile, without counting the call. */
+static int FT_doInsertFile(char *path, void *contents, size_t length){
+    Node_T curr;
     int result;
 
     assert(path != NULL);
@@ -323,7 +1049,89 @@ int FT_insertFile(char *path, void *contents, size_t length){
     return result;
 }
 
-int FT_rmFile(char *path){
+int FT_insertFile(char *path, void *contents, size_t length){
+    uint64_t start;
+    int result;
+
+    start = FT_beginOp(FT_OP_INSERT_FILE, path,
+                       0, 0, length, NULL, NULL);
+    result = FT_doInsertFile(path, contents, length);
+    return FT_endOp(FT_OP_INSERT_FILE, result, start);
+}
+
+/* Does the work of FT_insertFiles, without counting the call. */
+static int FT_doInsertFiles(char *dirPath, size_t n, char **names,
+                            void **contents, size_t *lengths) {
+    Node_T dir;
+    Node_T *files;
+    size_t created;
+    size_t i;
+    int result = SUCCESS;
+
+    assert(dirPath != NULL);
+    assert(names != NULL || n == 0);
+    assert(contents != NULL || n == 0);
+    assert(lengths != NULL || n == 0);
+
+    if(!isInitialized) return INITIALIZATION_ERROR;
+
+    dir = FT_lookup(dirPath);
+    if(dir == NULL) return NO_SUCH_PATH;
+    if(isFile(dir)) return NOT_A_DIRECTORY;
+    if(n == 0) return SUCCESS;
+
+    files = malloc(n * sizeof(Node_T));
+    if(files == NULL) return MEMORY_ERROR;
+
+    for(created = 0; created < n; created++) {
+        assert(names[created] != NULL);
+        files[created] = Node_create(names[created],
+                                     strlen(names[created]), dir,
+                                     contents[created], lengths[created],
+                                     ISFILE);
+        if(files[created] == NULL) {
+            result = MEMORY_ERROR;
+            break;
+        }
+        if(ownsContents &&
+           setOwnedFileContents(files[created], contents[created],
+                                lengths[created]) != SUCCESS) {
+            (void) Node_destroy(files[created], ISFILE);
+            result = MEMORY_ERROR;
+            break;
+        }
+    }
+    if(result == SUCCESS)
+        result = Node_linkChildren(dir, files, n);
+
+    if(result != SUCCESS) {
+        for(i = 0; i < created; i++)
+            (void) Node_destroy(files[i], ISFILE);
+        free(files);
+        return result;
+    }
+
+    count += n;
+    for(i = 0; i < n; i++)
+        FT_noteNewChain(files[i]);
+    free(files);
+    assert(FT_isValid());
+    return SUCCESS;
+}
+
+int FT_insertFiles(char *dirPath, size_t n, char **names,
+                   void **contents, size_t *lengths) {
+    uint64_t start;
+    int result;
+
+    start = FT_beginOp(FT_OP_INSERT_FILES, dirPath,
+                       0, 0, n, names, lengths);
+    result = FT_doInsertFiles(dirPath, n, names, contents, lengths);
+    return FT_endOp(FT_OP_INSERT_FILES, result, start);
+}
+
+/* Does the work of FT_rmFile, without counting the call. */
+static int FT_doRmFile(char *path){
     Node_T curr;
     int result;
 
@@ -332,8 +1140,8 @@ int FT_rmFile(char *path){
     if(!isInitialized)
         return INITIALIZATION_ERROR;
 
-    curr = FT_traversePathFrom(path, root);
-    if(curr == NULL || strcmp(Node_getPath(curr),path))
+    curr = FT_lookup(path);
+    if(curr == NULL)
         result =  NO_SUCH_PATH;
     else if(!isFile(curr)) result = NOT_A_FILE;
     else
@@ -343,33 +1151,249 @@ int FT_rmFile(char *path){
 
 }
 
+int FT_rmFile(char *path){
+    uint64_t start;
+    int result;
+
+    start = FT_beginOp(FT_OP_RM_FILE, path, 0, 0, 0, NULL, NULL);
+    result = FT_doRmFile(path);
+    return FT_endOp(FT_OP_RM_FILE, result, start);
+}
+
+/*
+  Returns the file node at exactly path, or NULL if there is none.
+  Sets *status to SUCCESS, or to the reason no node was returned:
+  INITIALIZATION_ERROR, NO_SUCH_PATH, or NOT_A_FILE.
+*/
+static Node_T FT_findFile(char *path, int *status) {
+    Node_T curr;
+
+    assert(path != NULL);
+    assert(status != NULL);
+
+    if(!isInitialized) {
+        *status = INITIALIZATION_ERROR;
+        return NULL;
+    }
+
+    curr = FT_lookup(path);
+    if(curr == NULL) {
+        *status = NO_SUCH_PATH;
+        return NULL;
+    }
+    if(!isFile(curr)) {
+        *status = NOT_A_FILE;
+        return NULL;
+    }
+
+    *status = SUCCESS;
+    return curr;
+}
+
+/* Does the work of FT_getFileContents, without counting the call, and
+   sets *status as FT_findFile does. */
+static void *FT_doGetFileContents(char *path, int *status){
+    Node_T curr;
+
+    assert(path != NULL);
+
+    curr = FT_findFile(path, status);
+    if(curr == NULL) return NULL;
+
+    return getFileContents(curr);
+}
+
 void *FT_getFileContents(char *path){
+    uint64_t start;
+    void* result;
+    int status;
+
+    start = FT_beginOp(FT_OP_GET_FILE_CONTENTS, path,
+                       0, 0, 0, NULL, NULL);
+    result = FT_doGetFileContents(path, &status);
+    (void) FT_endOp(FT_OP_GET_FILE_CONTENTS, status, start);
+    return result;
+}
+
+/*
+  Replaces the contents of the file node curr with newContents of size
+  newLength, as FT_replaceFileContents does. In owned mode, copies
+  newContents into the tree and returns a client-owned copy of the old
+  contents. Sets *status to SUCCESS, or to MEMORY_ERROR if memory
+  cannot be allocated, in which case returns NULL and curr is
+  unchanged.
+*/
+static void *FT_replaceContentsOf(Node_T curr, void *newContents,
+                                  size_t newLength, int *status) {
+    void* result;
+    size_t oldLength;
+    boolean owned;
+
+    assert(isFile(curr));
+    assert(status != NULL);
+
+    *status = SUCCESS;
+    if(!ownsContents) {
+        /* only contents the tree owns need a copy that can fail */
+        owned = ownsFileContents(curr);
+        oldLength = getFileLength(curr);
+        result = replaceFileContents(curr,newContents,newLength);
+        if(result == NULL && owned && oldLength != 0)
+            *status = MEMORY_ERROR;
+        return result;
+    }
+
+    /* hand back a client-owned copy of the old contents */
+    oldLength = getFileLength(curr);
+    result = NULL;
+    if(oldLength != 0) {
+        result = malloc(oldLength);
+        if(result == NULL) {
+            *status = MEMORY_ERROR;
+            return NULL;
+        }
+        (void) readFileRange(curr, 0, oldLength, result);
+    }
+    *status = setOwnedFileContents(curr, newContents, newLength);
+    if(*status != SUCCESS) {
+        free(result);
+        result = NULL;
+    }
+
+    return result;
+}
+
+/* Does the work of FT_replaceFileContents, without counting the
+   call, and sets *status to SUCCESS or the reason it failed. */
+static void *FT_doReplaceFileContents(char *path, void *newContents,
+                                      size_t newLength, int *status) {
     Node_T curr;
     void* result;
 
     assert(path != NULL);
 
-    curr = FT_traversePathFrom(path, root);
-    if(!isFile(curr) || curr == NULL) result = NULL;
-    else result = getFileContents(curr);
+    curr = FT_findFile(path, status);
+    if(curr == NULL) result = NULL;
+    else result = FT_replaceContentsOf(curr, newContents, newLength,
+                                       status);
 
+    assert(FT_isValid());
     return result;
 }
 
 void *FT_replaceFileContents(char *path, void *newContents, size_t newLength) {
-    Node_T curr;
+    uint64_t start;
     void* result;
+    int status;
+
+    start = FT_beginOp(FT_OP_REPLACE_FILE_CONTENTS, path,
+                       0, 0, newLength, NULL, NULL);
+    result = FT_doReplaceFileContents(path, newContents, newLength,
+                                      &status);
+    (void) FT_endOp(FT_OP_REPLACE_FILE_CONTENTS, status, start);
+    return result;
+}
+
+/* Does the work of FT_readFileRange, without counting the call, and
+   sets *status as FT_findFile does. */
+static size_t FT_doReadFileRange(char *path, size_t offset,
+                                 size_t length, void *buf,
+                                 int *status) {
+    Node_T curr;
 
     assert(path != NULL);
+    assert(buf != NULL || length == 0);
 
-    curr = FT_traversePathFrom(path, root);
-    if(!isFile(curr) || curr == NULL) result = NULL;
-    else result = replaceFileContents(curr,newContents,newLength);
+    curr = FT_findFile(path, status);
+    if(curr == NULL) return 0;
+
+    return readFileRange(curr, offset, length, buf);
+}
+
+size_t FT_readFileRange(char *path, size_t offset, size_t length,
+                        void *buf) {
+    uint64_t start;
+    size_t result;
+    int status;
 
+    start = FT_beginOp(FT_OP_READ_FILE_RANGE, path,
+                       0, offset, length, NULL, NULL);
+    result = FT_doReadFileRange(path, offset, length, buf, &status);
+    (void) FT_endOp(FT_OP_READ_FILE_RANGE, status, start);
     return result;
 }
 
-int FT_stat(char *path, boolean *type, size_t *length){
+/* Does the work of FT_writeFileRange, without counting the call. */
+static int FT_doWriteFileRange(char *path, size_t offset,
+                               const void *data, size_t length) {
+    Node_T curr;
+    int status;
+
+    assert(path != NULL);
+    assert(data != NULL || length == 0);
+
+    curr = FT_findFile(path, &status);
+    if(curr == NULL) return status;
+
+    status = writeFileRange(curr, offset, data, length);
+    assert(FT_isValid());
+    return status;
+}
+
+int FT_writeFileRange(char *path, size_t offset, const void *data,
+                      size_t length) {
+    uint64_t start;
+    int result;
+
+    start = FT_beginOp(FT_OP_WRITE_FILE_RANGE, path,
+                       0, offset, length, NULL, NULL);
+    result = FT_doWriteFileRange(path, offset, data, length);
+    return FT_endOp(FT_OP_WRITE_FILE_RANGE, result, start);
+}
+
+/* Does the work of FT_appendFile, without counting the call. */
+static int FT_doAppendFile(char *path, const void *data,
+                           size_t length) {
+    Node_T curr;
+    int status;
+
+    assert(path != NULL);
+    assert(data != NULL || length == 0);
+
+    curr = FT_findFile(path, &status);
+    if(curr == NULL) return status;
+
+    status = writeFileRange(curr, getFileLength(curr), data, length);
+    assert(FT_isValid());
+    return status;
+}
+
+int FT_appendFile(char *path, const void *data, size_t length) {
+    uint64_t start;
+    int result;
+
+    start = FT_beginOp(FT_OP_APPEND_FILE, path,
+                       0, 0, length, NULL, NULL);
+    result = FT_doAppendFile(path, data, length);
+    return FT_endOp(FT_OP_APPEND_FILE, result, start);
+}
+
+/*
+  Sets *type and *length for the node curr as FT_stat does.
+*/
+static void FT_statNode(Node_T curr, boolean *type, size_t *length) {
+    assert(curr != NULL);
+
+    if(isFile(curr)) {
+        *type = TRUE;
+        *length = getFileLength(curr);
+    }
+    else
+        *type = FALSE;
+}
+
+/* Does the work of FT_stat, without counting the call. */
+static int FT_doStat(char *path, boolean *type, size_t *length){
     Node_T curr;
 
     if(!isInitialized) return INITIALIZATION_ERROR;
@@ -377,21 +1401,592 @@ int FT_stat(char *path, boolean *type, size_t *length){
     assert(length!=NULL);
     assert(path != NULL);
 
-    if(FT_containsDir(path)) {
-        *type = FALSE;
-        curr = FT_traversePathFrom(path, root);
+    curr = FT_lookup(path);
+    if(curr == NULL)
+        return NO_SUCH_PATH;
+
+    FT_statNode(curr, type, length);
+    return SUCCESS;
+}
+
+int FT_stat(char *path, boolean *type, size_t *length){
+    uint64_t start;
+    int result;
+
+    start = FT_beginOp(FT_OP_STAT, path, 0, 0, 0, NULL, NULL);
+    result = FT_doStat(path, type, length);
+    return FT_endOp(FT_OP_STAT, result, start);
+}
+
+/* Does the work of FT_open, without counting the call, and sets
+   *status to SUCCESS or the reason it returns 0: INITIALIZATION_ERROR,
+   NO_SUCH_PATH, or MEMORY_ERROR if no slot could be had. */
+static FT_Handle FT_doOpen(char *path, int *status) {
+    Node_T curr;
+    struct FT_HandleSlot *slot;
+    size_t index;
+
+    assert(path != NULL);
+    assert(status != NULL);
+
+    if(!isInitialized) {
+        *status = INITIALIZATION_ERROR;
+        return 0;
     }
-    else if(FT_containsFile(path)){
-        *type = TRUE;
-        curr = FT_traversePathFrom(path, root);
-        *length = getFileLength(curr);
+
+    curr = FT_lookup(path);
+    if(curr == NULL) {
+        *status = NO_SUCH_PATH;
+        return 0;
+    }
+
+    /* the remaining failures are all for want of a slot */
+    *status = MEMORY_ERROR;
+
+    /* a node has at most one slot, shared by all its handles */
+    index = Node_getHandle(curr);
+    if(index != 0) {
+        slot = DynArray_get(handleSlots, index - 1);
+        *status = SUCCESS;
+        return ((slot->gen << HANDLE_INDEX_BITS) | (index - 1));
+    }
+
+    if(freeHandleSlot != 0) {
+        index = freeHandleSlot;
+        slot = DynArray_get(handleSlots, index - 1);
+        freeHandleSlot = slot->nextFree;
+    }
+    else {
+        if(handleSlots == NULL) {
+            handleSlots = DynArray_newWith(0, treeAllocator);
+            if(handleSlots == NULL) return 0;
+        }
+        if(DynArray_getLength(handleSlots) >=
+           ((size_t) 1 << HANDLE_INDEX_BITS) - 1)
+            return 0;
+        slot = Allocator_alloc(treeAllocator,
+                               sizeof(struct FT_HandleSlot));
+        if(slot == NULL) return 0;
+        if(!DynArray_add(handleSlots, slot)) {
+            Allocator_free(treeAllocator, slot,
+                           sizeof(struct FT_HandleSlot));
+            return 0;
+        }
+        index = DynArray_getLength(handleSlots);
+    }
+
+    slot->node = curr;
+    slot->gen = nextHandleGen;
+    slot->nextFree = 0;
+    /* generations wrap within their bits, skipping 0 */
+    nextHandleGen = (nextHandleGen + 1) &
+        (((size_t) 1 << (sizeof(size_t) * CHAR_BIT - HANDLE_INDEX_BITS)) - 1);
+    if(nextHandleGen == 0) nextHandleGen = 1;
+
+    Node_setHandle(curr, index);
+    openHandles++;
+    *status = SUCCESS;
+    return ((slot->gen << HANDLE_INDEX_BITS) | (index - 1));
+}
+
+FT_Handle FT_open(char *path) {
+    uint64_t start;
+    FT_Handle result;
+    int status;
+
+    start = FT_beginOp(FT_OP_OPEN, path, 0, 0, 0, NULL, NULL);
+    result = FT_doOpen(path, &status);
+    FT_noteOpened(result);
+    (void) FT_endOp(FT_OP_OPEN, status, start);
+    return result;
+}
+
+/*
+  Returns the node named by handle h, or NULL if h is not a valid
+  handle. Checks only h's slot and generation, so never touches a
+  node that has been removed.
+*/
+static Node_T FT_nodeOfHandle(FT_Handle h) {
+    struct FT_HandleSlot *slot;
+    size_t index;
+
+    if(handleSlots == NULL) return NULL;
+
+    index = h & (((size_t) 1 << HANDLE_INDEX_BITS) - 1);
+    if(index >= DynArray_getLength(handleSlots)) return NULL;
+
+    slot = DynArray_get(handleSlots, index);
+    if(slot->gen == 0 || slot->gen != (h >> HANDLE_INDEX_BITS))
+        return NULL;
+
+    return slot->node;
+}
+
+/*
+  Returns the file node named by handle h, or NULL if there is none.
+  Sets *status to SUCCESS, or to the reason no node was returned:
+  INITIALIZATION_ERROR, NO_SUCH_PATH, or NOT_A_FILE.
+*/
+static Node_T FT_fileOfHandle(FT_Handle h, int *status) {
+    Node_T curr;
+
+    assert(status != NULL);
+
+    if(!isInitialized) {
+        *status = INITIALIZATION_ERROR;
+        return NULL;
+    }
+
+    curr = FT_nodeOfHandle(h);
+    if(curr == NULL) {
+        *status = NO_SUCH_PATH;
+        return NULL;
+    }
+    if(!isFile(curr)) {
+        *status = NOT_A_FILE;
+        return NULL;
+    }
+
+    *status = SUCCESS;
+    return curr;
+}
+
+/* Does the work of FT_getFileContentsH, without counting the call,
+   and sets *status as FT_fileOfHandle does. */
+static void *FT_doGetFileContentsH(FT_Handle h, int *status) {
+    Node_T curr;
+
+    curr = FT_fileOfHandle(h, status);
+    if(curr == NULL) return NULL;
+
+    return getFileContents(curr);
+}
+
+void *FT_getFileContentsH(FT_Handle h) {
+    uint64_t start;
+    void* result;
+    int status;
+
+    start = FT_beginOp(FT_OP_GET_FILE_CONTENTS_H, NULL,
+                       h, 0, 0, NULL, NULL);
+    result = FT_doGetFileContentsH(h, &status);
+    (void) FT_endOp(FT_OP_GET_FILE_CONTENTS_H, status, start);
+    return result;
+}
+
+/* Does the work of FT_replaceFileContentsH, without counting the
+   call, and sets *status to SUCCESS or the reason it failed. */
+static void *FT_doReplaceFileContentsH(FT_Handle h, void *newContents,
+                                       size_t newLength, int *status) {
+    Node_T curr;
+    void* result;
+
+    curr = FT_fileOfHandle(h, status);
+    if(curr == NULL) return NULL;
+
+    result = FT_replaceContentsOf(curr, newContents, newLength, status);
+    assert(FT_isValid());
+    return result;
+}
+
+void *FT_replaceFileContentsH(FT_Handle h, void *newContents,
+                              size_t newLength) {
+    uint64_t start;
+    void* result;
+    int status;
+
+    start = FT_beginOp(FT_OP_REPLACE_FILE_CONTENTS_H, NULL,
+                       h, 0, newLength, NULL, NULL);
+    result = FT_doReplaceFileContentsH(h, newContents, newLength,
+                                       &status);
+    (void) FT_endOp(FT_OP_REPLACE_FILE_CONTENTS_H, status, start);
+    return result;
+}
+
+/* Does the work of FT_statH, without counting the call. */
+static int FT_doStatH(FT_Handle h, boolean *type, size_t *length) {
+    Node_T curr;
+
+    assert(type != NULL);
+    assert(length != NULL);
+
+    if(!isInitialized) return INITIALIZATION_ERROR;
+
+    curr = FT_nodeOfHandle(h);
+    if(curr == NULL) return NO_SUCH_PATH;
+
+    FT_statNode(curr, type, length);
+    return SUCCESS;
+}
+
+int FT_statH(FT_Handle h, boolean *type, size_t *length) {
+    uint64_t start;
+    int result;
+
+    start = FT_beginOp(FT_OP_STAT_H, NULL, h, 0, 0, NULL, NULL);
+    result = FT_doStatH(h, type, length);
+    return FT_endOp(FT_OP_STAT_H, result, start);
+}
+
+/*
+  Returns the directory node named by handle h, or NULL if there is
+  none. Sets *status to SUCCESS, or to the reason no node was
+  returned: INITIALIZATION_ERROR, NO_SUCH_PATH (h is not valid), or
+  NOT_A_DIRECTORY.
+*/
+static Node_T FT_dirOfHandle(FT_Handle h, int *status) {
+    Node_T dir;
+
+    assert(status != NULL);
+
+    if(!isInitialized) {
+        *status = INITIALIZATION_ERROR;
+        return NULL;
+    }
+
+    dir = FT_nodeOfHandle(h);
+    if(dir == NULL) {
+        *status = NO_SUCH_PATH;
+        return NULL;
+    }
+    if(isFile(dir)) {
+        *status = NOT_A_DIRECTORY;
+        return NULL;
+    }
+
+    *status = SUCCESS;
+    return dir;
+}
+
+/* Does the work of FT_insertFileAt, without counting the call. */
+static int FT_doInsertFileAt(FT_Handle dirHandle, char *relPath,
+                             void *contents, size_t length) {
+    Node_T curr;
+    const char* rest;
+    int status;
+
+    assert(relPath != NULL);
+
+    curr = FT_dirOfHandle(dirHandle, &status);
+    if(curr == NULL) return status;
+
+    curr = FT_traverseRelative(relPath, curr, &rest);
+    if(*rest == '\0') return ALREADY_IN_TREE;
+    if(isFile(curr)) return NOT_A_DIRECTORY;
+
+    return FT_insertBelow(rest, curr, ISFILE, contents, length);
+}
+
+int FT_insertFileAt(FT_Handle dirHandle, char *relPath, void *contents,
+                    size_t length) {
+    uint64_t start;
+    int result;
+
+    start = FT_beginOp(FT_OP_INSERT_FILE_AT, relPath,
+                       dirHandle, 0, length, NULL, NULL);
+    result = FT_doInsertFileAt(dirHandle, relPath, contents, length);
+    return FT_endOp(FT_OP_INSERT_FILE_AT, result, start);
+}
+
+/* Does the work of FT_containsAt, without counting the call. */
+static boolean FT_doContainsAt(FT_Handle dirHandle, char *relPath,
+                               boolean type, int *status) {
+    Node_T curr;
+    const char* rest;
+
+    assert(relPath != NULL);
+
+    curr = FT_dirOfHandle(dirHandle, status);
+    if(curr == NULL) return FALSE;
+
+    curr = FT_traverseRelative(relPath, curr, &rest);
+    if(*rest != '\0')
+        *status = NO_SUCH_PATH;
+    else if(isFile(curr) != type)
+        *status = type ? NOT_A_FILE : NOT_A_DIRECTORY;
+
+    return *status == SUCCESS;
+}
+
+boolean FT_containsAt(FT_Handle dirHandle, char *relPath, boolean type) {
+    uint64_t start;
+    boolean result;
+    int status;
+
+    start = FT_beginOp(FT_OP_CONTAINS_AT, relPath,
+                       dirHandle, 0, (size_t) type, NULL, NULL);
+    result = FT_doContainsAt(dirHandle, relPath, type, &status);
+    (void) FT_endOp(FT_OP_CONTAINS_AT, status, start);
+    return result;
+}
+
+/* Does the work of FT_rmFileAt, without counting the call. */
+static int FT_doRmFileAt(FT_Handle dirHandle, char *relPath) {
+    Node_T curr;
+    const char* rest;
+    int status;
+
+    assert(relPath != NULL);
+
+    curr = FT_dirOfHandle(dirHandle, &status);
+    if(curr == NULL) return status;
+
+    curr = FT_traverseRelative(relPath, curr, &rest);
+    if(*rest != '\0') return NO_SUCH_PATH;
+    if(!isFile(curr)) return NOT_A_FILE;
+
+    FT_rmNode(curr);
+    return SUCCESS;
+}
+
+int FT_rmFileAt(FT_Handle dirHandle, char *relPath) {
+    uint64_t start;
+    int result;
+
+    start = FT_beginOp(FT_OP_RM_FILE_AT, relPath,
+                       dirHandle, 0, 0, NULL, NULL);
+    result = FT_doRmFileAt(dirHandle, relPath);
+    return FT_endOp(FT_OP_RM_FILE_AT, result, start);
+}
+
+int FT_setLookupCacheSize(size_t entries) {
+    PathCache_T cache = NULL;
+
+    if(!isInitialized) return INITIALIZATION_ERROR;
+
+    if(entries > 0) {
+        cache = PathCache_new(entries);
+        if(cache == NULL) return MEMORY_ERROR;
     }
+
+    if(lookupCache != NULL) PathCache_free(lookupCache);
+    lookupCache = cache;
+    return SUCCESS;
+}
+
+int FT_getLookupCacheStats(struct FT_LookupCacheStats *stats) {
+    struct PathCacheStats cacheStats;
+
+    assert(stats != NULL);
+
+    if(!isInitialized) return INITIALIZATION_ERROR;
+
+    if(lookupCache == NULL)
+        memset(&cacheStats, 0, sizeof(cacheStats));
     else
-        curr = NULL;
+        PathCache_getStats(lookupCache, &cacheStats);
+
+    stats->positiveHits = cacheStats.uPositiveHits;
+    stats->negativeHits = cacheStats.uNegativeHits;
+    stats->misses = cacheStats.uMisses;
+    stats->evictions = cacheStats.uEvictions;
+    stats->invalidations = cacheStats.uInvalidations;
+    stats->entries = cacheStats.uEntries;
+    stats->capacity = cacheStats.uCapacity;
+    return SUCCESS;
+}
+
+int FT_setPathFilter(boolean enabled) {
+    Bloom_T filter = NULL;
+
+    if(!isInitialized) return INITIALIZATION_ERROR;
+
+    if(enabled) {
+        filter = FT_buildFilter();
+        if(filter == NULL) return MEMORY_ERROR;
+    }
+
+    if(pathFilter != NULL) Bloom_free(pathFilter);
+    pathFilter = filter;
+    filterRejects = 0;
+    filterPasses = 0;
+    filterFalsePositives = 0;
+    filterRebuilds = 0;
+    return SUCCESS;
+}
+
+int FT_getPathFilterStats(struct FT_PathFilterStats *stats) {
+    double fill;
+    size_t i;
+
+    assert(stats != NULL);
+
+    if(!isInitialized) return INITIALIZATION_ERROR;
+
+    memset(stats, 0, sizeof(*stats));
+    if(pathFilter == NULL) return SUCCESS;
+
+    stats->paths = Bloom_getCount(pathFilter);
+    stats->capacity = Bloom_getCapacity(pathFilter);
+    stats->counters = Bloom_getCounters(pathFilter);
+    stats->bytes = Bloom_getBytes(pathFilter);
+    fill = Bloom_getFillRatio(pathFilter);
+    stats->falsePositiveRate = 1.0;
+    for(i = 0; i < Bloom_getHashes(pathFilter); i++)
+        stats->falsePositiveRate *= fill;
+    stats->rejects = filterRejects;
+    stats->passes = filterPasses;
+    stats->falsePositives = filterFalsePositives;
+    stats->rebuilds = filterRebuilds;
+    return SUCCESS;
+}
+
+int FT_setAllocator(const struct Allocator *allocator) {
+    if(isInitialized) return INITIALIZATION_ERROR;
+
+    treeAllocator = allocator != NULL ? allocator : &Allocator_heap;
+    return SUCCESS;
+}
+
+/*
+  Points the handle slot of n and of every node beneath it, if any,
+  back at the node, after FT_compact moved them.
+*/
+static void FT_rebindHandles(Node_T n) {
+    struct FT_HandleSlot *slot;
+    size_t index;
+    size_t i;
+
+    index = Node_getHandle(n);
+    if(index != 0) {
+        slot = DynArray_get(handleSlots, index - 1);
+        slot->node = n;
+    }
+    for(i = 0; i < Node_getNumDirChildren(n); i++)
+        FT_rebindHandles(Node_getChildDirectory(n, i));
+    for(i = 0; i < Node_getNumFileChildren(n); i++)
+        FT_rebindHandles(Node_getChildFile(n, i));
+}
+
+/* Returns the bytes of the nodes of the tree that FT_compact moves. */
+static size_t FT_treeBytes(void) {
+    struct NodeMemStats nodeStats;
 
-    if (curr == NULL) return NO_SUCH_PATH;
-    else return SUCCESS;
+    Node_getMemStats(&nodeStats);
+    return nodeStats.nodeBytes + nodeStats.pathBytes
+           + nodeStats.childBytes;
+}
+
+/* Does the work of FT_compact, without counting the call. */
+static int FT_doCompact(struct FT_CompactStats *stats) {
+    struct FT_CompactStats result;
+    Arena_T arena;
+    Node_T moved;
+
+    assert(CheckerFT_isValid(isInitialized, root, count));
+    if(!isInitialized) return INITIALIZATION_ERROR;
+
+    result.nanos = FT_nanos();
+    result.nodes = count;
+    result.bytesBefore = FT_treeBytes();
+    if(root != NULL) {
+        arena = Arena_new(0, FALSE);
+        if(arena == NULL) return MEMORY_ERROR;
+        moved = Node_compact(root, Arena_get(arena));
+        if(moved == NULL) {
+            Arena_free(arena);
+            return MEMORY_ERROR;
+        }
+        root = moved;
+        if(treeArena != NULL) Arena_free(treeArena);
+        treeArena = arena;
+        if(openHandles > 0) FT_rebindHandles(root);
+        /* the cache names the old nodes */
+        if(lookupCache != NULL) PathCache_clear(lookupCache);
+    }
+    result.bytesAfter = FT_treeBytes();
+    result.nanos = FT_nanos() - result.nanos;
+
+    assert(CheckerFT_isValid(isInitialized, root, count));
+    if(stats != NULL) *stats = result;
+    return SUCCESS;
+}
+
+int FT_compact(struct FT_CompactStats *stats) {
+    uint64_t start;
+    int result;
+
+    start = FT_beginOp(FT_OP_COMPACT, NULL, 0, 0, 0, NULL, NULL);
+    result = FT_doCompact(stats);
+    return FT_endOp(FT_OP_COMPACT, result, start);
+}
+
+int FT_memoryUsage(struct FT_MemStats *stats) {
+    struct NodeMemStats nodeStats;
+
+    assert(stats != NULL);
+
+    if(!isInitialized) return INITIALIZATION_ERROR;
+
+    Node_getMemStats(&nodeStats);
+    stats->nodes = nodeStats.nodes;
+    stats->nodeBytes = nodeStats.nodeBytes;
+    stats->pathBytes = nodeStats.pathBytes;
+    stats->childBytes = nodeStats.childBytes;
+    stats->childUsedBytes = nodeStats.childUsedBytes;
+    stats->contentBytes = nodeStats.contentBytes;
+    stats->totalBytes = stats->nodeBytes + stats->pathBytes
+                        + stats->childBytes + stats->contentBytes;
+    return SUCCESS;
+}
+
+void FT_getStats(struct FT_Stats *stats) {
+    struct FT_ThreadStats* set;
+    struct FT_OpStats* sum;
+    struct FT_OpStats* add;
+    size_t op;
+    size_t i;
+
+    assert(stats != NULL);
+
+    memset(stats, 0, sizeof(struct FT_Stats));
+    (void) pthread_mutex_lock(&statsLock);
+    for(set = statsList; set != NULL; set = set->next) {
+        for(op = 0; op < FT_OPS; op++) {
+            sum = &stats->ops[op];
+            add = &set->ops[op];
+            sum->calls += add->calls;
+            for(i = 0; i < FT_STATUSES; i++)
+                sum->outcomes[i] += add->outcomes[i];
+            sum->nodesVisited += add->nodesVisited;
+            sum->timed += add->timed;
+            sum->totalNanos += add->totalNanos;
+            for(i = 0; i < FT_LATENCY_BUCKETS; i++)
+                sum->latencies[i] += add->latencies[i];
+        }
+    }
+    (void) pthread_mutex_unlock(&statsLock);
+}
+
+void FT_resetStats(void) {
+    struct FT_ThreadStats* set;
+
+    (void) pthread_mutex_lock(&statsLock);
+    for(set = statsList; set != NULL; set = set->next)
+        memset(set->ops, 0, sizeof(set->ops));
+    (void) pthread_mutex_unlock(&statsLock);
+}
+
+const char *FT_opName(enum FT_Op op) {
+    if((int) op < 0 || op >= FT_OPS)
+        return NULL;
+    return opNames[op];
+}
+
+void FT_setTraceHooks(FT_TraceHook pre, FT_TraceHook post,
+                      void *context) {
+    preHook = pre;
+    postHook = post;
+    hookContext = context;
+    tracing = (pre != NULL || post != NULL);
+}
+
+size_t FT_latencyBucketLow(size_t bucket) {
+    assert(bucket < FT_LATENCY_BUCKETS);
 
+    if(bucket < 4)
+        return bucket;
+    return (4 + bucket % 4) << (bucket / 4 - 1);
 }
 
 /*
@@ -448,14 +2043,19 @@ static void FT_strcatAccumulate(char* str, char* acc) {
         strcat(acc, str); strcat(acc, "\n");
 }
 
-char *FT_toString(void){
+/* Does the work of FT_toString, without counting the call, and sets
+   *status to SUCCESS, INITIALIZATION_ERROR or MEMORY_ERROR. */
+static char *FT_doToString(int *status){
     DynArray_T nodes;
     size_t totalStrlen = 1;
     char* result = NULL;
 
+    assert(status != NULL);
 
+    *status = INITIALIZATION_ERROR;
     if(!isInitialized) return NULL;
 
+    *status = MEMORY_ERROR;
     nodes = DynArray_new(count);
     (void) FT_preOrderTraversal(root, nodes, 0);
 
@@ -471,6 +2071,18 @@ char *FT_toString(void){
     DynArray_map(nodes, (void (*)(void *, void*)) FT_strcatAccumulate, (void *) result);
 
     DynArray_free(nodes);
+    *status = SUCCESS;
+    return result;
+}
+
+char *FT_toString(void){
+    uint64_t start;
+    char* result;
+    int status;
+
+    start = FT_beginOp(FT_OP_TO_STRING, NULL, 0, 0, 0, NULL, NULL);
+    result = FT_doToString(&status);
+    (void) FT_endOp(FT_OP_TO_STRING, status, start);
     return result;
 }
 
@@ -13,7 +13,19 @@
 */
 
 #include <stddef.h>
+#include <stdint.h>
 #include "a4def.h"
+#include "allocator.h"
+
+/*
+  An FT_Handle names a node of the tree without its path, so that
+  repeated operations on the node skip path resolution. A handle
+  carries a generation that is checked on every use: once its node is
+  removed (directly, with an ancestor, or by FT_destroy), the handle
+  is rejected without the removed node being touched. 0 is never a
+  valid handle.
+*/
+typedef size_t FT_Handle;
 
 /*
    Inserts a new directory into the tree at path, if possible.
@@ -56,6 +68,25 @@ int FT_rmDir(char *path);
 */
 int FT_insertFile(char *path, void *contents, size_t length);
 
+/*
+   Inserts n new files into the existing directory dirPath at once:
+   the i'th is named names[i], a single path component, and has
+   contents[i] of size lengths[i] bytes. Cheaper than n calls of
+   FT_insertFile when the directory is large, as the files are sorted
+   and merged in among its children in one pass. Either all the files
+   are inserted, or none is.
+   Returns SUCCESS if the new files are inserted.
+   Returns INITIALIZATION_ERROR if not in an initialized state.
+   Returns NO_SUCH_PATH if dirPath does not exist in the hierarchy.
+   Returns NOT_A_DIRECTORY if dirPath exists but is a file.
+   Returns ALREADY_IN_TREE if a name is already in dirPath (as dir or
+                           file), or is given twice.
+   Returns PARENT_CHILD_ERROR if a name is empty or contains a slash.
+   Returns MEMORY_ERROR if unable to allocate sufficient memory.
+*/
+int FT_insertFiles(char *dirPath, size_t n, char **names,
+                   void **contents, size_t *lengths);
+
 /*
   Returns TRUE if the tree contains the full path parameter as a
   file and FALSE otherwise.
@@ -85,10 +116,51 @@ void *FT_getFileContents(char *path);
   the parameter newContents of size newLength.
   Returns the old contents if successful. (Note: contents may be NULL.)
   Returns NULL if the path does not already exist or is a directory.
+
+  If the old contents were owned by the tree (see FT_initOwned and
+  FT_writeFileRange), the returned old contents are a newly allocated
+  copy, which is then owned by client! Otherwise they are the very
+  pointer the client last passed in for the file, so a client can
+  tell which it got by comparing the result with that pointer.
 */
 void *FT_replaceFileContents(char *path, void *newContents,
                              size_t newLength);
 
+/*
+  Copies at most length bytes of the file at path, starting at byte
+  offset, into buf.
+  Returns the number of bytes copied, which is less than length if
+  the range extends past the end of the file, and 0 if the path does
+  not exist or is a directory.
+*/
+size_t FT_readFileRange(char *path, size_t offset, size_t length,
+                        void *buf);
+
+/*
+  Overwrites length bytes of the file at path, starting at byte
+  offset, with data, extending the file if the range reaches past its
+  end. If offset is past the end of the file, the gap is filled with
+  zero bytes.
+  The first write to a file whose contents are borrowed from the
+  client copies them into the tree, which owns them from then on; the
+  client's buffer is never written.
+  Returns SUCCESS if the contents are written.
+  Returns INITIALIZATION_ERROR if not in an initialized state.
+  Returns NO_SUCH_PATH if the path does not exist in the hierarchy.
+  Returns NOT_A_FILE if path exists but is a directory not a file.
+  Returns MEMORY_ERROR if unable to allocate sufficient memory, in
+                       which case the contents are unchanged.
+*/
+int FT_writeFileRange(char *path, size_t offset, const void *data,
+                      size_t length);
+
+/*
+  Appends length bytes of data to the end of the file at path.
+  Equivalent to FT_writeFileRange at an offset of the file's length,
+  with the same return values.
+*/
+int FT_appendFile(char *path, const void *data, size_t length);
+
 /*
   Returns SUCCESS if path exists in the hierarchy,
   returns NO_SUCH_PATH if it does not, and
@@ -103,6 +175,377 @@ void *FT_replaceFileContents(char *path, void *newContents,
  */
 int FT_stat(char *path, boolean *type, size_t *length);
 
+/*
+  Returns a handle naming the file or directory at path, or 0 if the
+  path does not exist, the structure is not initialized, or there is
+  an allocation error. Opening a node that already has a handle
+  returns the same handle. A handle stays valid until its node is
+  removed or the structure is destroyed.
+*/
+FT_Handle FT_open(char *path);
+
+/*
+  Returns the contents of the file named by handle h.
+  Returns NULL if h is not valid or names a directory.
+  Otherwise behaves as FT_getFileContents.
+*/
+void *FT_getFileContentsH(FT_Handle h);
+
+/*
+  Replaces the contents of the file named by handle h with the
+  parameter newContents of size newLength.
+  Returns NULL if h is not valid or names a directory.
+  Otherwise behaves as FT_replaceFileContents.
+*/
+void *FT_replaceFileContentsH(FT_Handle h, void *newContents,
+                              size_t newLength);
+
+/*
+  Returns SUCCESS if handle h is valid, setting *type and *length
+  as FT_stat does, returns NO_SUCH_PATH if it is not, and
+  returns INITIALIZATION_ERROR if the structure is not initialized.
+*/
+int FT_statH(FT_Handle h, boolean *type, size_t *length);
+
+/*
+  Inserts a new file at relPath below the directory named by
+  dirHandle, with the given contents of size length bytes, resolving
+  relPath from that directory rather than from the root. relPath is
+  a path relative to the directory, with no leading slash.
+  Returns NO_SUCH_PATH if dirHandle is not valid.
+  Returns NOT_A_DIRECTORY if dirHandle names a file, or if a proper
+                          prefix of relPath exists as a file.
+  Otherwise returns as FT_insertFile does.
+*/
+int FT_insertFileAt(FT_Handle dirHandle, char *relPath, void *contents,
+                    size_t length);
+
+/*
+  Returns TRUE if the tree contains relPath below the directory named
+  by dirHandle as a file (if type is TRUE) or a directory (if type is
+  FALSE), and FALSE otherwise, including when dirHandle is not a
+  valid handle to a directory. An empty relPath names the directory
+  itself.
+*/
+boolean FT_containsAt(FT_Handle dirHandle, char *relPath, boolean type);
+
+/*
+  Removes the file at relPath below the directory named by dirHandle.
+  Returns NO_SUCH_PATH if dirHandle is not valid or relPath does not
+                       exist below it.
+  Returns NOT_A_DIRECTORY if dirHandle names a file.
+  Otherwise returns as FT_rmFile does.
+*/
+int FT_rmFileAt(FT_Handle dirHandle, char *relPath);
+
+/*
+  Counters of the lookup cache, which remembers the results of recent
+  lookups of full paths, both found (positive) and absent (negative).
+  The hit ratio is (positiveHits + negativeHits) divided by that sum
+  plus misses.
+*/
+struct FT_LookupCacheStats {
+    /* lookups answered with a node from the cache */
+    size_t positiveHits;
+    /* lookups answered as absent from the cache */
+    size_t negativeHits;
+    /* lookups the cache could not answer */
+    size_t misses;
+    /* entries dropped to make room for newer ones */
+    size_t evictions;
+    /* entries dropped because an insert or remove made them stale */
+    size_t invalidations;
+    /* entries currently held */
+    size_t entries;
+    /* the maximum number of entries, or 0 if there is no cache */
+    size_t capacity;
+};
+
+/*
+  Replaces the lookup cache with an empty one holding about entries
+  entries, or removes it if entries is 0. FT_init creates a cache of
+  a default size. Each entry takes 128 bytes, and paths of more than
+  PATHCACHE_MAX_LENGTH (103) characters are never cached. Results
+  returned are the same with or without the cache; only their speed
+  differs.
+  Returns INITIALIZATION_ERROR if not in an initialized state.
+  Returns MEMORY_ERROR if unable to allocate the new cache, in which
+                       case the old one is kept.
+  Returns SUCCESS otherwise.
+*/
+int FT_setLookupCacheSize(size_t entries);
+
+/*
+  Fills *stats with the counters of the lookup cache since it was
+  created.
+  Returns INITIALIZATION_ERROR if not in an initialized state,
+  and SUCCESS otherwise.
+*/
+int FT_getLookupCacheStats(struct FT_LookupCacheStats *stats);
+
+/*
+  State of the path filter, which summarizes the full paths of all
+  nodes so that most lookups of absent paths return without walking
+  the tree. It never rejects a path that is present; an absent path
+  it lets through is a false positive.
+*/
+struct FT_PathFilterStats {
+    /* paths currently in the filter */
+    size_t paths;
+    /* the number of paths the filter was sized for; once exceeded,
+       the filter is rebuilt for twice the current number of nodes */
+    size_t capacity;
+    /* counters in the filter */
+    size_t counters;
+    /* memory used by the filter, in bytes */
+    size_t bytes;
+    /* the estimated probability that an absent path is let through,
+       given how full the filter currently is */
+    double falsePositiveRate;
+    /* lookups the filter answered as absent */
+    size_t rejects;
+    /* lookups the filter let through */
+    size_t passes;
+    /* lookups let through that found nothing */
+    size_t falsePositives;
+    /* rebuilds since the filter was enabled */
+    size_t rebuilds;
+};
+
+/*
+  Enables the path filter, built from the current tree, if enabled is
+  TRUE, and disables it otherwise; an enabled filter is rebuilt and its
+  counters are reset. FT_init starts without a filter. Results
+  returned are the same with or without the filter; only their speed
+  differs. The filter lasts until FT_destroy.
+  Returns INITIALIZATION_ERROR if not in an initialized state.
+  Returns MEMORY_ERROR if unable to allocate the new filter, in which
+                       case the old one, if any, is kept.
+  Returns SUCCESS otherwise.
+*/
+int FT_setPathFilter(boolean enabled);
+
+/*
+  Fills *stats with the state of the path filter, or with zeroes if
+  there is none.
+  Returns INITIALIZATION_ERROR if not in an initialized state,
+  and SUCCESS otherwise.
+*/
+int FT_getPathFilterStats(struct FT_PathFilterStats *stats);
+
+/*
+  Memory held by the nodes of the tree, in bytes. It is kept up to
+  date as the tree changes, so reading it does not walk the tree. The
+  lookup cache, path filter and handle table are not included.
+*/
+struct FT_MemStats {
+    /* the number of nodes */
+    size_t nodes;
+    /* the node structures themselves */
+    size_t nodeBytes;
+    /* the full paths of the nodes, with their terminating nulls */
+    size_t pathBytes;
+    /* the storage for the children of directories, at its capacity */
+    size_t childBytes;
+    /* the part of childBytes that holds a child or its search key;
+       the rest is spare capacity and the structures that hold it */
+    size_t childUsedBytes;
+    /* file contents owned by the tree, as after FT_initOwned; 0 if
+       the tree holds only the client's pointers */
+    size_t contentBytes;
+    /* the sum of the byte counts above */
+    size_t totalBytes;
+};
+
+/*
+  Fills *stats with the memory held by the nodes of the tree.
+  Returns INITIALIZATION_ERROR if not in an initialized state,
+  and SUCCESS otherwise.
+*/
+int FT_memoryUsage(struct FT_MemStats *stats);
+
+/*
+  Makes allocator (see allocator.h) the source of memory for each
+  tree initialized from now on: its nodes, their paths and arrays of
+  children, and its handle table. If allocator is NULL, that memory
+  comes from malloc, as it does to start with. Owned file contents,
+  children kept in a B-tree, the lookup cache and the path filter
+  always come from malloc. allocator must remain valid until the tree
+  is destroyed.
+  Returns INITIALIZATION_ERROR, leaving the allocator unchanged, if
+  in an initialized state, and SUCCESS otherwise.
+*/
+int FT_setAllocator(const struct Allocator *allocator);
+
+/* The result of a call of FT_compact. */
+struct FT_CompactStats {
+    /* the number of nodes moved */
+    size_t nodes;
+    /* the bytes of node structures, paths and storage for children
+       (as in struct FT_MemStats) before and after */
+    size_t bytesBefore;
+    size_t bytesAfter;
+    /* the time the call took, in nanoseconds */
+    uint64_t nanos;
+};
+
+/*
+  Rebuilds the tree in a fresh region of memory, reserved for it and
+  backed by huge pages where the system allows, and frees the memory
+  the tree held before. The nodes are laid out depth first, each
+  directory's storage for its children just before those children,
+  so that lookups in a tree scattered over the heap by a long run of
+  inserts and removes touch fewer cache lines and pages. Storage for
+  children keeps no spare capacity. Handles, contents and the results
+  of every call are unchanged; the lookup cache is emptied. The tree
+  stays in such a region, with new nodes taken from it, until the next
+  call or FT_destroy; the allocator of FT_setAllocator still supplies
+  the handle table. Takes time linear in the number of nodes, so is
+  meant for a window in which the tree is otherwise idle. If stats is
+  not NULL, fills *stats with the result.
+  Returns INITIALIZATION_ERROR if not in an initialized state.
+  Returns MEMORY_ERROR if unable to allocate the new region or copy,
+                       in which case the tree is unchanged.
+  Returns SUCCESS otherwise.
+*/
+int FT_compact(struct FT_CompactStats *stats);
+
+/* The operations whose calls are counted, each naming the counters
+   of one function in struct FT_Stats. */
+enum FT_Op {
+    FT_OP_INSERT_DIR, FT_OP_CONTAINS_DIR, FT_OP_RM_DIR,
+    FT_OP_INSERT_FILE, FT_OP_INSERT_FILES, FT_OP_CONTAINS_FILE,
+    FT_OP_RM_FILE, FT_OP_GET_FILE_CONTENTS,
+    FT_OP_REPLACE_FILE_CONTENTS, FT_OP_READ_FILE_RANGE,
+    FT_OP_WRITE_FILE_RANGE, FT_OP_APPEND_FILE, FT_OP_STAT, FT_OP_OPEN,
+    FT_OP_GET_FILE_CONTENTS_H, FT_OP_REPLACE_FILE_CONTENTS_H,
+    FT_OP_STAT_H, FT_OP_INSERT_FILE_AT, FT_OP_CONTAINS_AT,
+    FT_OP_RM_FILE_AT, FT_OP_TO_STRING, FT_OP_INIT, FT_OP_INIT_OWNED,
+    FT_OP_DESTROY, FT_OP_COMPACT,
+    FT_OPS
+};
+
+/* The number of return statuses, SUCCESS through MEMORY_ERROR. */
+enum { FT_STATUSES = MEMORY_ERROR + 1 };
+
+/* The number of buckets in a latency histogram. */
+enum { FT_LATENCY_BUCKETS = 128 };
+
+/* About one call in FT_TIMING_PERIOD is timed. */
+enum { FT_TIMING_PERIOD = 8 };
+
+/*
+  Counters of the calls to one function. Reading the clock costs more
+  than some calls, so only about one call in FT_TIMING_PERIOD, chosen
+  at random, is timed. Latencies are kept in log-bucketed histograms:
+  each power of two of nanoseconds is split into four buckets, so a
+  bucket's bounds are within 25% of any latency it counts.
+*/
+struct FT_OpStats {
+    /* calls made */
+    size_t calls;
+    /* calls by outcome: outcomes[s] counts the calls that ended with
+       status s. A function that returns no status is counted by what
+       happened, not by its return value: SUCCESS, or the reason it
+       failed, such as NOT_A_FILE for a path naming a directory. So a
+       read of an empty file's NULL contents counts as SUCCESS. */
+    size_t outcomes[FT_STATUSES];
+    /* nodes whose children were searched in resolving paths */
+    size_t nodesVisited;
+    /* calls timed */
+    size_t timed;
+    /* time spent in the timed calls, in nanoseconds */
+    size_t totalNanos;
+    /* latencies[b] counts the timed calls that took at least
+       FT_latencyBucketLow(b) nanoseconds and less than
+       FT_latencyBucketLow(b + 1); the last bucket has no bound */
+    size_t latencies[FT_LATENCY_BUCKETS];
+};
+
+/* Counters of the calls to each function, indexed by enum FT_Op. */
+struct FT_Stats {
+    struct FT_OpStats ops[FT_OPS];
+};
+
+/*
+  Fills *stats with the sums of the counters of all threads since the
+  program started or FT_resetStats was last called. Each thread counts
+  its own calls, so counting never makes threads wait for each other;
+  the counters of threads calling while this sums them may be read
+  part way through a call. The counters are kept across FT_destroy
+  and FT_init, and whether or not the tree is initialized.
+*/
+void FT_getStats(struct FT_Stats *stats);
+
+/* Sets all counters of all threads back to zero. */
+void FT_resetStats(void);
+
+/*
+  Returns the least latency, in nanoseconds, counted in bucket bucket
+  of a latency histogram of struct FT_OpStats.
+*/
+size_t FT_latencyBucketLow(size_t bucket);
+
+/*
+  Returns the name of the function counted as op, such as
+  "FT_insertDir", or NULL if op is not an enum FT_Op.
+*/
+const char *FT_opName(enum FT_Op op);
+
+/* One call, as passed to a trace hook. */
+struct FT_TraceEvent {
+    /* the function called */
+    enum FT_Op op;
+    /* the path passed to it (relative for the functions taking a
+       directory handle), or NULL if it takes none */
+    const char *path;
+    /* the handle passed to it, or 0 if it takes none; for FT_open,
+       the handle returned, in the hook called after the call */
+    FT_Handle handle;
+    /* the offset passed to FT_readFileRange or FT_writeFileRange,
+       and 0 for other functions */
+    size_t offset;
+    /* the length of the contents or range passed, the number of
+       files passed to FT_insertFiles, or the type passed to
+       FT_containsAt, and 0 for other functions */
+    size_t length;
+    /* the names and lengths passed to FT_insertFiles, or NULL */
+    char **names;
+    size_t *lengths;
+    /* the status it ended with, as counted in struct FT_OpStats; 0
+       in the hook called before the call */
+    int status;
+    /* when the call started and ended, in nanoseconds of a monotonic
+       clock; the end is 0 in the hook called before the call */
+    uint64_t startNanos;
+    uint64_t endNanos;
+    /* the processor's cycle counter when the call started and ended,
+       where there is one to read, and 0 otherwise */
+    uint64_t startTicks;
+    uint64_t endTicks;
+    /* nodes whose children were searched in resolving paths; 0 in
+       the hook called before the call */
+    size_t nodesVisited;
+};
+
+/* A function called with each call made to the tree, and the context
+   it was registered with. The event is valid only during the call. */
+typedef void (*FT_TraceHook)(const struct FT_TraceEvent *event,
+                             void *context);
+
+/*
+  Registers pre to be called as each call counted by FT_getStats
+  starts, and post as it returns, each with context; either may be
+  NULL, and passing NULL for both stops tracing. Hooks are called on
+  the thread making the call, so must be safe to call from any thread
+  that uses the tree, and must not call FT functions themselves.
+  While a hook is registered every call is timed, not only a sample.
+  Must not be called while other threads are calling FT functions.
+  With no hook registered, tracing costs one branch per call.
+*/
+void FT_setTraceHooks(FT_TraceHook pre, FT_TraceHook post,
+                      void *context);
+
 /*
   Sets the data structure to initialized status.
   The data structure is initially empty.
@@ -111,6 +554,21 @@ int FT_stat(char *path, boolean *type, size_t *length);
 */
 int FT_init(void);
 
+/*
+  Sets the data structure to initialized status in owned mode, in
+  which FT_insertFile and FT_replaceFileContents copy file contents
+  into the tree rather than keeping the client's pointer. File
+  contents are stored as chunked ropes, so ranged reads, writes and
+  appends cost time proportional to the bytes they touch.
+  FT_getFileContents then returns a contiguous view owned by the tree
+  that remains valid until the file is next changed or removed.
+  The data structure returns to the default, borrowing mode when it
+  is destroyed.
+  Returns INITIALIZATION_ERROR if already initialized,
+  and SUCCESS otherwise.
+*/
+int FT_initOwned(void);
+
 /*
   Removes all contents of the data structure and
   returns it to uninitialized status.
@@ -0,0 +1,560 @@
+/*--------------------------------------------------------------------*/
+/* ft_client_ext.c                                                    */
+/* Author: Alina Chen and Nickolas Casalinuovo                        */
+/*--------------------------------------------------------------------*/
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "ft.h"
+#include "allocator.h"
+#include "arena.h"
+#include "slowtrace.h"
+#include "record.h"
+
+/* the number of times traceHook has been called */
+static size_t hookCalls;
+/* the last call traceHook was shown */
+static struct FT_TraceEvent lastEvent;
+
+/* Counts the call event in *context, a size_t, and keeps a copy. */
+static void traceHook(const struct FT_TraceEvent *event,
+                      void *context) {
+  (*(size_t*) context)++;
+  lastEvent = *event;
+}
+
+/* Tests the FT interfaces beyond the baseline ones: handles, ranges,
+   statistics, tracing, recording, allocators and compaction.
+   Returns 0. */
+int main(void) {
+  char* temp;
+  char* again;
+  boolean b;
+  size_t l;
+  FT_Handle h;
+  FT_Handle hf;
+  struct FT_PathFilterStats fs;
+  struct FT_LookupCacheStats cst;
+  struct FT_Stats st;
+  struct FT_MemStats ms;
+  CountingAllocator_T counting;
+  struct AllocatorCounts ac;
+  BumpAllocator_T bump;
+  Arena_T arena;
+  struct ArenaStats as;
+  struct FT_CompactStats cs;
+  size_t n;
+  SlowTrace_T slow;
+  FILE* out;
+  Record_T rec;
+  RecordReader_T reader;
+  struct RecordedCall call;
+  char* names[2] = {"x", "y"};
+  void* contents[2] = {NULL, NULL};
+  size_t lengths[2] = {0, 0};
+  int i;
+  char arr[1000] = {'\0'};
+
+  /* handles name a node without re-resolving its path, and are
+     rejected once the node is removed */
+  assert(FT_init() == SUCCESS);
+  assert(FT_insertDir("a") == SUCCESS);
+  assert(FT_insertFile("a/x/H", "hello", 6) == SUCCESS);
+  assert(FT_open("a/x/G") == 0);
+  assert((h = FT_open("a/x/H")) != 0);
+  assert(FT_open("a/x/H") == h);
+  assert(!strcmp(FT_getFileContentsH(h), "hello"));
+  assert(!strcmp(FT_replaceFileContentsH(h, "world", 6), "hello"));
+  assert(!strcmp(FT_getFileContents("a/x/H"), "world"));
+  assert(FT_statH(h, &b, &l) == SUCCESS);
+  assert(b == TRUE);
+  assert(l == 6);
+  assert(FT_rmDir("a/x") == SUCCESS);
+  assert(FT_statH(h, &b, &l) == NO_SUCH_PATH);
+  assert(FT_getFileContentsH(h) == NULL);
+  assert(FT_destroy() == SUCCESS);
+
+  /* paths below a directory handle are resolved from it, creating
+     missing directories on insert, and a handle to a file or to a
+     removed directory is refused */
+  assert(FT_init() == SUCCESS);
+  assert(FT_insertDir("p/q") == SUCCESS);
+  assert((h = FT_open("p/q")) != 0);
+  assert(FT_insertFileAt(h, "r/s/t", "v", 2) == SUCCESS);
+  assert(FT_containsDir("p/q/r") == TRUE);
+  assert(FT_containsDir("p/q/r/s") == TRUE);
+  assert(!strcmp(FT_getFileContents("p/q/r/s/t"), "v"));
+  assert(FT_containsAt(h, "r/s/t", TRUE) == TRUE);
+  assert(FT_containsAt(h, "r/s", FALSE) == TRUE);
+  assert(FT_containsAt(h, "", FALSE) == TRUE);
+  assert(FT_insertFileAt(h, "r/s/t", NULL, 0) == ALREADY_IN_TREE);
+  assert(FT_insertFileAt(h, "r/s/t/u", NULL, 0) == NOT_A_DIRECTORY);
+  assert(FT_containsFile("p/q/r/s/t/u") == FALSE);
+  assert((hf = FT_open("p/q/r/s/t")) != 0);
+  assert(FT_insertFileAt(hf, "u", NULL, 0) == NOT_A_DIRECTORY);
+  assert(FT_rmFileAt(hf, "u") == NOT_A_DIRECTORY);
+  assert(FT_containsAt(hf, "", TRUE) == FALSE);
+  assert(FT_rmFileAt(h, "r/s") == NOT_A_FILE);
+  assert(FT_containsDir("p/q/r/s") == TRUE);
+  assert(FT_rmFileAt(h, "r/x") == NO_SUCH_PATH);
+  assert(FT_rmFileAt(h, "r/s/t") == SUCCESS);
+  assert(FT_containsFile("p/q/r/s/t") == FALSE);
+  assert(FT_insertFileAt(hf, "u", NULL, 0) == NO_SUCH_PATH);
+  assert(FT_rmDir("p/q") == SUCCESS);
+  assert(FT_insertFileAt(h, "w", NULL, 0) == NO_SUCH_PATH);
+  assert(FT_rmFileAt(h, "w") == NO_SUCH_PATH);
+  assert(FT_containsAt(h, "", FALSE) == FALSE);
+  assert(FT_containsDir("p/q") == FALSE);
+  /* the handle stays stale when the path is created again */
+  assert(FT_insertDir("p/q") == SUCCESS);
+  assert(FT_insertFileAt(h, "w", NULL, 0) == NO_SUCH_PATH);
+  assert(FT_containsFile("p/q/w") == FALSE);
+  assert(FT_destroy() == SUCCESS);
+  assert(FT_insertFileAt(h, "w", NULL, 0) == INITIALIZATION_ERROR);
+
+  /* in owned mode the tree keeps its own copy of file contents,
+     which can be read, overwritten and appended to by range */
+  assert(FT_initOwned() == SUCCESS);
+  assert(FT_insertDir("a") == SUCCESS);
+  assert(FT_insertFile("a/L", "log:", 4) == SUCCESS);
+  assert(FT_appendFile("a/L", " one", 5) == SUCCESS);
+  assert(!strcmp(FT_getFileContents("a/L"), "log: one"));
+  assert(FT_writeFileRange("a/L", 5, "ONE", 3) == SUCCESS);
+  assert(FT_readFileRange("a/L", 3, 100, arr) == 6);
+  assert(!strcmp(arr, ": ONE"));
+  assert(FT_stat("a/L", &b, &l) == SUCCESS);
+  assert(l == 9);
+  assert(FT_appendFile("a", "x", 1) == NOT_A_FILE);
+  assert(FT_appendFile("a/M", "x", 1) == NO_SUCH_PATH);
+  assert((temp = FT_replaceFileContents("a/L", NULL, 0)) != NULL);
+  assert(!strcmp(temp, "log: ONE"));
+  free(temp);
+  assert(FT_readFileRange("a/L", 0, 1, arr) == 0);
+  assert(FT_destroy() == SUCCESS);
+
+  /* a batch of files is inserted into a directory all at once, or
+     not at all */
+  assert(FT_init() == SUCCESS);
+  assert(FT_insertDir("a/b") == SUCCESS);
+  assert(FT_insertFile("a/b/m", NULL, 0) == SUCCESS);
+  {
+     char *names[3] = { "z", "c", "n" };
+     char *dupNames[2] = { "q", "m" };
+     char *badNames[2] = { "q", "r/s" };
+     void *contents[3] = { "1", "2", "3" };
+     size_t lengths[3] = { 2, 2, 2 };
+     assert(FT_insertFiles("a/b", 3, names, contents, lengths)
+            == SUCCESS);
+     assert(FT_insertFiles("a/b", 2, dupNames, contents, lengths)
+            == ALREADY_IN_TREE);
+     assert(FT_insertFiles("a/b", 2, badNames, contents, lengths)
+            == PARENT_CHILD_ERROR);
+     assert(FT_insertFiles("a/b/m", 3, names, contents, lengths)
+            == NOT_A_DIRECTORY);
+     assert(FT_insertFiles("a/x", 3, names, contents, lengths)
+            == NO_SUCH_PATH);
+  }
+  assert(FT_containsFile("a/b/q") == FALSE);
+  assert(!strcmp(FT_getFileContents("a/b/c"), "2"));
+  assert(!strcmp(FT_getFileContents("a/b/z"), "1"));
+  assert((temp = FT_toString()) != NULL);
+  assert(!strcmp(temp, "a\na/b\na/b/c\na/b/m\na/b/n\na/b/z\n"));
+  free(temp);
+  assert(FT_destroy() == SUCCESS);
+
+  /* the lookup cache answers repeated lookups, drops entries that an
+     insert or remove makes stale, and evicts the least recently used
+     entry when full; without it lookups are still answered */
+  assert(FT_getLookupCacheStats(&cst) == INITIALIZATION_ERROR);
+  assert(FT_setLookupCacheSize(4) == INITIALIZATION_ERROR);
+  assert(FT_init() == SUCCESS);
+  assert(FT_getLookupCacheStats(&cst) == SUCCESS);
+  assert(cst.capacity >= 4096);
+  assert(cst.entries == 0 && cst.misses == 0);
+  assert(FT_insertDir("c/d/e") == SUCCESS);
+  assert(FT_insertFile("c/f", "x", 2) == SUCCESS);
+  assert(FT_containsFile("c/f") == TRUE);
+  assert(FT_containsFile("c/f") == TRUE);
+  assert(FT_containsFile("c/g") == FALSE);
+  assert(FT_containsFile("c/g") == FALSE);
+  assert(FT_getLookupCacheStats(&cst) == SUCCESS);
+  assert(cst.misses == 2);
+  assert(cst.positiveHits == 1);
+  assert(cst.negativeHits == 1);
+  assert(cst.entries == 2);
+  /* inserting an absent path drops its negative entry */
+  assert(FT_insertFile("c/g", "y", 2) == SUCCESS);
+  assert(FT_getLookupCacheStats(&cst) == SUCCESS);
+  assert(cst.invalidations == 1);
+  assert(cst.entries == 1);
+  assert(FT_containsFile("c/g") == TRUE);
+  /* removing a directory drops the positive entries beneath it */
+  assert(FT_containsDir("c/d/e") == TRUE);
+  assert(FT_containsDir("c/d/e") == TRUE);
+  assert(FT_getLookupCacheStats(&cst) == SUCCESS);
+  assert(cst.misses == 4);
+  assert(cst.positiveHits == 2);
+  assert(cst.entries == 3);
+  assert(FT_rmDir("c/d") == SUCCESS);
+  assert(FT_getLookupCacheStats(&cst) == SUCCESS);
+  assert(cst.misses == 5);
+  assert(cst.invalidations == 3);
+  assert(cst.entries == 2);
+  assert(FT_containsDir("c/d/e") == FALSE);
+  assert(FT_containsDir("c/d") == FALSE);
+  /* a path too long to keep in an entry always misses */
+  memset(arr, 'x', 200);
+  arr[0] = 'c';
+  arr[1] = '/';
+  arr[200] = '\0';
+  assert(FT_containsFile(arr) == FALSE);
+  assert(FT_containsFile(arr) == FALSE);
+  assert(FT_getLookupCacheStats(&cst) == SUCCESS);
+  assert(cst.misses == 9);
+  assert(cst.negativeHits == 1);
+  assert(cst.entries == 4);
+  /* with 4 entries, a fifth path evicts the least recently used */
+  assert(FT_setLookupCacheSize(4) == SUCCESS);
+  assert(FT_getLookupCacheStats(&cst) == SUCCESS);
+  assert(cst.capacity == 4);
+  assert(cst.entries == 0 && cst.misses == 0);
+  for(i = 0; i < 5; i++) {
+     sprintf(arr, "c/h%d", i);
+     assert(FT_containsFile(arr) == FALSE);
+  }
+  assert(FT_containsFile("c/h4") == FALSE);
+  assert(FT_containsFile("c/h0") == FALSE);
+  assert(FT_getLookupCacheStats(&cst) == SUCCESS);
+  assert(cst.misses == 6);
+  assert(cst.negativeHits == 1);
+  assert(cst.evictions == 2);
+  assert(cst.entries == 4);
+  assert(FT_insertFile("c/h2", NULL, 0) == SUCCESS);
+  assert(FT_containsFile("c/h2") == TRUE);
+  assert(FT_getLookupCacheStats(&cst) == SUCCESS);
+  assert(cst.invalidations == 1);
+  assert(cst.misses == 7);
+  /* with no cache, nothing is counted */
+  assert(FT_setLookupCacheSize(0) == SUCCESS);
+  assert(FT_containsFile("c/f") == TRUE);
+  assert(FT_containsFile("c/q") == FALSE);
+  assert(FT_rmDir("c") == SUCCESS);
+  assert(FT_containsFile("c/f") == FALSE);
+  assert(FT_getLookupCacheStats(&cst) == SUCCESS);
+  assert(cst.capacity == 0 && cst.entries == 0);
+  assert(cst.misses == 0 && cst.positiveHits == 0);
+  assert(cst.invalidations == 0);
+  assert(FT_destroy() == SUCCESS);
+
+  /* the path filter never rejects a present path, and keeps up with
+     inserts, removals and growth past its initial size */
+  assert(FT_init() == SUCCESS);
+  assert(FT_insertDir("a") == SUCCESS);
+  assert(FT_setPathFilter(TRUE) == SUCCESS);
+  for(i = 0; i < 100; i++) {
+     sprintf(arr, "a/d%d/f", i);
+     assert(FT_insertFile(arr, NULL, 0) == SUCCESS);
+  }
+  for(i = 0; i < 100; i++) {
+     sprintf(arr, "a/d%d/f", i);
+     assert(FT_containsFile(arr) == TRUE);
+     sprintf(arr, "a/d%d/g", i);
+     assert(FT_containsFile(arr) == FALSE);
+  }
+  assert(FT_rmDir("a/d7") == SUCCESS);
+  assert(FT_containsDir("a/d7") == FALSE);
+  assert(FT_containsFile("a/d8/f") == TRUE);
+  assert(FT_getPathFilterStats(&fs) == SUCCESS);
+  assert(fs.paths == 199);
+  assert(fs.rebuilds > 0);
+  assert(fs.rejects > 0);
+  assert(FT_destroy() == SUCCESS);
+
+  /* a directory keeps its children in order as it grows wide enough
+     to move them into a tree, and shrinks back */
+  assert(FT_init() == SUCCESS);
+  assert(FT_insertDir("w") == SUCCESS);
+  for(i = 2999; i >= 0; i--) {
+     sprintf(arr, "w/f%04d", i);
+     assert(FT_insertFile(arr, NULL, 0) == SUCCESS);
+  }
+  for(i = 0; i < 3000; i += 2) {
+     sprintf(arr, "w/f%04d", i);
+     assert(FT_rmFile(arr) == SUCCESS);
+  }
+  for(i = 1; i < 2800; i += 2) {
+     sprintf(arr, "w/f%04d", i);
+     assert(FT_rmFile(arr) == SUCCESS);
+  }
+  assert(FT_containsFile("w/f2799") == FALSE);
+  assert(FT_containsFile("w/f2801") == TRUE);
+  assert((temp = FT_toString()) != NULL);
+  assert(!strncmp(temp, "w\nw/f2801\nw/f2803\n", 18));
+  assert(strlen(temp) == 2 + 100 * 8);
+  free(temp);
+  assert(FT_destroy() == SUCCESS);
+
+  /* memory is counted as nodes, paths, children and owned contents
+     come and go, and returns to that of the root alone */
+  assert(FT_memoryUsage(&ms) == INITIALIZATION_ERROR);
+  assert(FT_initOwned() == SUCCESS);
+  assert(FT_insertDir("m") == SUCCESS);
+  assert(FT_memoryUsage(&ms) == SUCCESS);
+  assert(ms.nodes == 1 && ms.pathBytes == 2 && ms.contentBytes == 0);
+  l = ms.totalBytes;
+  n = ms.nodeBytes;
+  assert(FT_insertFile("m/big", arr, sizeof(arr)) == SUCCESS);
+  for(i = 0; i < 3000; i++) {
+     sprintf(arr, "m/d/f%04d", i);
+     assert(FT_insertFile(arr, NULL, 0) == SUCCESS);
+  }
+  assert(FT_appendFile("m/big", "xyz", 3) == SUCCESS);
+  assert(FT_memoryUsage(&ms) == SUCCESS);
+  assert(ms.nodes == 3003);
+  /* a file node has no room for children, so is smaller */
+  assert(ms.nodeBytes < 3003 * n);
+  assert(ms.pathBytes == 2 + 6 + 4 + 3000 * 10);
+  assert(ms.contentBytes >= sizeof(arr) + 3);
+  assert(ms.childUsedBytes >= 3002 * sizeof(void*));
+  assert(ms.childUsedBytes <= ms.childBytes);
+  assert(ms.totalBytes == ms.nodeBytes + ms.pathBytes
+                          + ms.childBytes + ms.contentBytes);
+  assert(FT_rmDir("m/d") == SUCCESS);
+  assert(FT_rmFile("m/big") == SUCCESS);
+  assert(FT_memoryUsage(&ms) == SUCCESS);
+  assert(ms.nodes == 1 && ms.contentBytes == 0);
+  assert(ms.totalBytes == l);
+  assert(FT_destroy() == SUCCESS);
+
+  /* a tree takes the memory of its nodes from the allocator it was
+     initialized with, and gives all of it back when destroyed */
+  assert((counting = CountingAllocator_new(&Allocator_heap)) != NULL);
+  assert(FT_setAllocator(CountingAllocator_get(counting)) == SUCCESS);
+  assert(FT_init() == SUCCESS);
+  assert(FT_setAllocator(NULL) == INITIALIZATION_ERROR);
+  assert(FT_insertDir("c/d") == SUCCESS);
+  assert(FT_insertFile("c/d/e", NULL, 0) == SUCCESS);
+  assert(FT_insertFile("c/f", NULL, 0) == SUCCESS);
+  assert(FT_memoryUsage(&ms) == SUCCESS);
+  CountingAllocator_getCounts(counting, &ac);
+  assert(ac.uBytes == ms.nodeBytes + ms.pathBytes + ms.childBytes);
+  assert((h = FT_open("c/d/e")) != 0);
+  assert(FT_destroy() == SUCCESS);
+  CountingAllocator_getCounts(counting, &ac);
+  assert(ac.uBytes == 0 && ac.uAllocs == ac.uFrees && ac.uPeakBytes > 0);
+  CountingAllocator_free(counting);
+
+  assert((bump = BumpAllocator_new(4096)) != NULL);
+  assert(FT_setAllocator(BumpAllocator_get(bump)) == SUCCESS);
+  assert(FT_init() == SUCCESS);
+  assert(FT_insertDir("b") == SUCCESS);
+  for(i = 0; i < 1000; i++) {
+     sprintf(arr, "b/d%d/f%d", i % 10, i);
+     assert(FT_insertFile(arr, NULL, 0) == SUCCESS);
+  }
+  assert(FT_containsFile("b/d7/f997") == TRUE);
+  assert(FT_rmDir("b/d3") == SUCCESS);
+  assert(FT_containsFile("b/d3/f3") == FALSE);
+  assert(BumpAllocator_getBytes(bump) > 1000 * sizeof(void*));
+  assert(FT_destroy() == SUCCESS);
+  assert(FT_setAllocator(NULL) == SUCCESS);
+  BumpAllocator_free(bump);
+
+  /* an arena reuses the blocks of removed nodes for new ones */
+  assert((arena = Arena_new(1 << 24, FALSE)) != NULL);
+  assert(FT_setAllocator(Arena_get(arena)) == SUCCESS);
+  assert(FT_init() == SUCCESS);
+  assert(FT_insertDir("h") == SUCCESS);
+  for(i = 0; i < 1000; i++) {
+     sprintf(arr, "h/d%d/f%d", i % 10, i);
+     assert(FT_insertFile(arr, NULL, 0) == SUCCESS);
+  }
+  assert(FT_rmDir("h/d3") == SUCCESS);
+  Arena_getStats(arena, &as);
+  assert(as.uFree > 0 && as.uUsed <= as.uReserved);
+  l = as.uUsed;
+  assert(FT_insertFile("h/d3/f3", NULL, 0) == SUCCESS);
+  assert(FT_containsFile("h/d3/f3") == TRUE);
+  Arena_getStats(arena, &as);
+  assert(as.uUsed == l);
+  assert(FT_destroy() == SUCCESS);
+  assert(FT_setAllocator(NULL) == SUCCESS);
+  Arena_free(arena);
+
+  /* compaction moves every node, in one directory's array or
+     B-tree of children alike, and nothing a call returns changes */
+  assert(FT_compact(NULL) == INITIALIZATION_ERROR);
+  assert(FT_initOwned() == SUCCESS);
+  assert(FT_compact(&cs) == SUCCESS);
+  assert(cs.nodes == 0 && cs.bytesAfter == 0);
+  assert(FT_insertDir("k") == SUCCESS);
+  for(i = 0; i < 3000; i++) {
+     if(i < 2500) sprintf(arr, "k/w/f%04d", i);
+     else sprintf(arr, "k/d%d/f%d", i % 10, i);
+     assert(FT_insertFile(arr, "abc", 3) == SUCCESS);
+  }
+  for(i = 0; i < 2500; i += 7) {
+     sprintf(arr, "k/w/f%04d", i);
+     assert(FT_rmFile(arr) == SUCCESS);
+  }
+  assert(FT_appendFile("k/w/f0001", "de", 2) == SUCCESS);
+  assert((h = FT_open("k/w/f0001")) != 0);
+  assert(FT_memoryUsage(&ms) == SUCCESS);
+  temp = FT_toString();
+  assert(temp != NULL);
+  assert(FT_compact(&cs) == SUCCESS);
+  assert(cs.nodes == ms.nodes);
+  assert(cs.bytesBefore == ms.nodeBytes + ms.pathBytes + ms.childBytes);
+  assert(cs.bytesAfter <= cs.bytesBefore);
+  assert(FT_memoryUsage(&ms) == SUCCESS);
+  assert(cs.bytesAfter == ms.nodeBytes + ms.pathBytes + ms.childBytes);
+  assert(ms.childUsedBytes <= ms.childBytes);
+  assert(!strcmp(temp, (again = FT_toString())));
+  free(again);
+  free(temp);
+  assert(memcmp(FT_getFileContentsH(h), "abcde", 5) == 0);
+  assert(FT_containsFile("k/w/f0007") == FALSE);
+  assert(FT_containsFile("k/d3/f2503") == TRUE);
+  assert(FT_insertFile("k/w/f0007", "x", 1) == SUCCESS);
+  assert(FT_rmDir("k/d3") == SUCCESS);
+  assert(FT_compact(NULL) == SUCCESS);
+  assert(FT_containsFile("k/w/f0007") == TRUE);
+  assert(FT_statH(h, &b, &l) == SUCCESS && b == TRUE && l == 5);
+  assert(FT_destroy() == SUCCESS);
+  assert(FT_memoryUsage(&ms) == INITIALIZATION_ERROR);
+
+  /* each call is counted by outcome and latency, and the counters
+     outlast the tree until they are reset */
+  FT_resetStats();
+  FT_getStats(&st);
+  assert(st.ops[FT_OP_INSERT_DIR].calls == 0);
+  assert(FT_insertDir("s/t") == INITIALIZATION_ERROR);
+  assert(FT_init() == SUCCESS);
+  assert(FT_insertDir("s/t") == SUCCESS);
+  assert(FT_insertDir("s/t") == ALREADY_IN_TREE);
+  assert(FT_insertFile("s/t/u", NULL, 0) == SUCCESS);
+  assert(FT_containsFile("s/t/u") == TRUE);
+  assert(FT_containsFile("s/t/v") == FALSE);
+  assert(FT_containsFile("s/t") == FALSE);
+  /* calls returning no status count what happened, not their value */
+  assert(FT_getFileContents("s/t/u") == NULL);
+  assert(FT_getFileContents("s/t") == NULL);
+  assert(FT_replaceFileContents("s/t/u", NULL, 0) == NULL);
+  assert(FT_readFileRange("s/t/u", 0, 10, arr) == 0);
+  assert(FT_readFileRange("s/t/v", 0, 10, arr) == 0);
+  assert(FT_compact(NULL) == SUCCESS);
+  assert(FT_destroy() == SUCCESS);
+  assert(FT_toString() == NULL);
+  assert(FT_compact(NULL) == INITIALIZATION_ERROR);
+  FT_getStats(&st);
+  assert(st.ops[FT_OP_INSERT_DIR].calls == 3);
+  assert(st.ops[FT_OP_INSERT_DIR].outcomes[SUCCESS] == 1);
+  assert(st.ops[FT_OP_INSERT_DIR].outcomes[ALREADY_IN_TREE] == 1);
+  assert(st.ops[FT_OP_INSERT_DIR].outcomes[INITIALIZATION_ERROR]
+         == 1);
+  assert(st.ops[FT_OP_CONTAINS_FILE].outcomes[SUCCESS] == 1);
+  assert(st.ops[FT_OP_CONTAINS_FILE].outcomes[NO_SUCH_PATH] == 1);
+  assert(st.ops[FT_OP_CONTAINS_FILE].outcomes[NOT_A_FILE] == 1);
+  assert(st.ops[FT_OP_GET_FILE_CONTENTS].outcomes[SUCCESS] == 1);
+  assert(st.ops[FT_OP_GET_FILE_CONTENTS].outcomes[NOT_A_FILE] == 1);
+  assert(st.ops[FT_OP_REPLACE_FILE_CONTENTS].outcomes[SUCCESS] == 1);
+  assert(st.ops[FT_OP_READ_FILE_RANGE].outcomes[SUCCESS] == 1);
+  assert(st.ops[FT_OP_READ_FILE_RANGE].outcomes[NO_SUCH_PATH] == 1);
+  assert(st.ops[FT_OP_TO_STRING].outcomes[INITIALIZATION_ERROR]
+         == 1);
+  assert(st.ops[FT_OP_COMPACT].calls == 2);
+  assert(st.ops[FT_OP_COMPACT].outcomes[SUCCESS] == 1);
+  assert(!strcmp(FT_opName(FT_OP_COMPACT), "FT_compact"));
+  assert(st.ops[FT_OP_INSERT_FILE].nodesVisited >= 1);
+  for(n = 0, l = 0; l < FT_LATENCY_BUCKETS; l++)
+     n += st.ops[FT_OP_INSERT_DIR].latencies[l];
+  assert(n == st.ops[FT_OP_INSERT_DIR].timed);
+  for(l = 1; l < FT_LATENCY_BUCKETS; l++)
+     assert(FT_latencyBucketLow(l) > FT_latencyBucketLow(l - 1));
+  FT_resetStats();
+  FT_getStats(&st);
+  assert(st.ops[FT_OP_INSERT_DIR].calls == 0);
+
+  /* trace hooks are shown each call as it starts and returns, until
+     they are removed, and a SlowTrace keeps the slowest calls */
+  assert(FT_init() == SUCCESS);
+  FT_setTraceHooks(traceHook, traceHook, &hookCalls);
+  assert(FT_insertDir("s/t") == SUCCESS);
+  assert(hookCalls == 2);
+  assert(lastEvent.op == FT_OP_INSERT_DIR);
+  assert(!strcmp(lastEvent.path, "s/t"));
+  assert(lastEvent.status == SUCCESS);
+  assert(lastEvent.endNanos >= lastEvent.startNanos);
+  assert(lastEvent.endTicks >= lastEvent.startTicks);
+  assert(FT_getFileContentsH(0) == NULL);
+  assert(lastEvent.path == NULL);
+  assert(lastEvent.status == NO_SUCH_PATH);
+  assert(!strcmp(FT_opName(lastEvent.op), "FT_getFileContentsH"));
+  FT_setTraceHooks(NULL, NULL, NULL);
+  assert(FT_containsDir("s/t") == TRUE);
+  assert(hookCalls == 4);
+  assert((slow = SlowTrace_new(3)) != NULL);
+  FT_setTraceHooks(NULL, SlowTrace_record, slow);
+  for(i = 0; i < 100; i++) {
+     sprintf(arr, "s/t/f%03d", i);
+     assert(FT_insertFile(arr, NULL, 0) == SUCCESS);
+  }
+  FT_setTraceHooks(NULL, NULL, NULL);
+  assert(SlowTrace_getLength(slow) == 3);
+  assert((out = tmpfile()) != NULL);
+  SlowTrace_dump(slow, out);
+  rewind(out);
+  for(n = 0; fgets(arr, sizeof(arr), out) != NULL; n++)
+     assert(strstr(arr, "FT_insertFile") != NULL);
+  assert(n == 3);
+  fclose(out);
+  SlowTrace_free(slow);
+  assert(FT_destroy() == SUCCESS);
+
+  /* a recorded trace reads back as the calls made, with their paths,
+     lengths and results */
+  assert((out = tmpfile()) != NULL);
+  assert((rec = Record_new(out)) != NULL);
+  FT_setTraceHooks(NULL, Record_call, rec);
+  assert(FT_init() == SUCCESS);
+  assert(FT_insertDir("r/s") == SUCCESS);
+  assert(FT_insertFile("r/s/t", "abc", 3) == SUCCESS);
+  assert(FT_insertFiles("r/s", 2, names, contents, lengths) == SUCCESS);
+  assert(FT_rmFile("r/s/q") == NO_SUCH_PATH);
+  assert((h = FT_open("r/s")) != 0);
+  assert(FT_containsAt(h, "x", TRUE) == TRUE);
+  assert(FT_destroy() == SUCCESS);
+  FT_setTraceHooks(NULL, NULL, NULL);
+  assert(Record_free(rec));
+  rewind(out);
+  assert((reader = RecordReader_new(out)) != NULL);
+  assert(RecordReader_next(reader, &call) == 1);
+  assert(call.eOp == FT_OP_INIT && call.pcPath == NULL);
+  assert(RecordReader_next(reader, &call) == 1);
+  assert(call.eOp == FT_OP_INSERT_DIR && !strcmp(call.pcPath, "r/s"));
+  assert(RecordReader_next(reader, &call) == 1);
+  assert(call.eOp == FT_OP_INSERT_FILE && call.uLength == 3);
+  assert(!strcmp(call.pcPath, "r/s/t"));
+  assert(RecordReader_next(reader, &call) == 1);
+  assert(call.eOp == FT_OP_INSERT_FILES && call.uLength == 2);
+  assert(!strcmp(call.ppcNames[1], "y"));
+  assert(RecordReader_next(reader, &call) == 1);
+  assert(call.iStatus == NO_SUCH_PATH);
+  assert(!strcmp(call.pcPath, "r/s/q"));
+  assert(RecordReader_next(reader, &call) == 1);
+  assert(call.eOp == FT_OP_OPEN && call.uHandle == h);
+  assert(RecordReader_next(reader, &call) == 1);
+  assert(call.eOp == FT_OP_CONTAINS_AT && call.uHandle == h);
+  assert(call.uLength == TRUE && !strcmp(call.pcPath, "x"));
+  assert(RecordReader_next(reader, &call) == 1);
+  assert(call.eOp == FT_OP_DESTROY);
+  assert(RecordReader_next(reader, &call) == 0);
+  RecordReader_free(reader);
+  fclose(out);
+
+  return 0;
+}
+
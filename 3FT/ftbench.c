@@ -0,0 +1,777 @@
+/*--------------------------------------------------------------------*/
+/* ftbench.c                                                          */
+/* Author: Alina Chen and Nickolas Casalinuovo                        */
+/*--------------------------------------------------------------------*/
+
+/* for clock_gettime, getopt and getrusage */
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include "ft.h"
+
+/* Builds trees of four generated shapes and times workloads on each,
+   printing one row per shape and workload to stdout as CSV, or as
+   JSON with -j.  Each row gives the number of nodes in the tree, the
+   calls timed, ns per call, calls per second, the peak resident set
+   size of the process so far, and the number of calls to malloc,
+   calloc and realloc made during the workload.  Must be linked with
+   -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc, for the count.
+
+   The shapes are:
+      chain     a chain of directories, -d deep (1000)
+      wide      -n files (100000) in one directory
+      balanced  a tree of -k (8) directories per directory, as deep
+                as keeps it within -n nodes, with files as leaves
+      realistic -n nodes, a fifth of them directories, each node put
+                beside the node before it half the time and in a
+                random directory otherwise, so that most paths are
+                about ln n deep, with file sizes of a heavy-tailed
+                distribution: half under 128 bytes, few over 64KB
+
+   The workloads, run in this order on each shape, are:
+      insert         inserting every node, parents first
+      lookup_hit     FT_contains* of every node, in random order
+      lookup_miss    FT_containsFile of a sibling of every node that
+                     is not in the tree, in random order
+      stat           FT_stat of every node, in random order
+      compact        FT_compact, laying the tree out afresh
+      lookup_compact lookup_hit again, on the compacted tree
+      to_string      FT_toString
+      remove_subtree removing each child of the root, with all below
+      destroy        FT_destroy of the tree, rebuilt first
+
+   With -m, each shape is instead built once and its memory, as
+   FT_memoryUsage counts it, printed in one row: the bytes of node
+   structures, paths, storage for children at its capacity and the
+   part of it in use, and owned contents, their total, and the total
+   per node.
+
+   Usage: ftbench [-j] [-o] [-m] [-n nodes] [-k fanout] [-d depth]
+                  [-s seed]
+   With -o, the tree owns copies of file contents (FT_initOwned);
+   otherwise it borrows one shared buffer. */
+
+/*--------------------------------------------------------------------*/
+
+/* A node of a generated tree. */
+
+struct Item
+{
+   /* The node's full path. */
+   char *pcPath;
+
+   /* The path of a node not in the tree, beside this one. */
+   char *pcMissing;
+
+   /* The index of the node's parent, or the node's own index for the
+      root. */
+   size_t uParent;
+
+   /* 1 (TRUE) for a file, 0 (FALSE) for a directory. */
+   int bFile;
+
+   /* The length of a file's contents. */
+   size_t uSize;
+};
+
+/* A generated tree, with its nodes in an order in which each parent
+   comes before its children. */
+
+struct Tree
+{
+   /* The shape's name. */
+   const char *pcShape;
+
+   /* The nodes, and their number and the number allocated. */
+   struct Item *psItems;
+   size_t uItems;
+   size_t uCapacity;
+
+   /* A random permutation of the indices of the nodes. */
+   size_t *puOrder;
+};
+
+/* The measurement of a workload. */
+
+struct Result
+{
+   /* The number of calls timed. */
+   size_t uCalls;
+
+   /* The time they took, in nanoseconds. */
+   unsigned long ulNanos;
+
+   /* The number of allocations they made. */
+   unsigned long ulMallocs;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* The number of calls to malloc, calloc and realloc so far. */
+
+static unsigned long ulMallocs;
+
+/* The buffer that borrowed file contents point into. */
+
+static char *pcContents;
+
+/* The most bytes of contents of any file. */
+
+enum { MAX_FILE_SIZE = 1 << 20 };
+
+/* 1 (TRUE) if the JSON output has had a row, so that the next needs
+   a separating comma. */
+
+static int bJsonRows;
+
+/*--------------------------------------------------------------------*/
+
+void *__real_malloc(size_t uSize);
+void *__real_calloc(size_t uCount, size_t uSize);
+void *__real_realloc(void *pvOld, size_t uSize);
+void *__wrap_malloc(size_t uSize);
+void *__wrap_calloc(size_t uCount, size_t uSize);
+void *__wrap_realloc(void *pvOld, size_t uSize);
+
+/* Count a call of malloc, and make it. */
+
+void *__wrap_malloc(size_t uSize)
+{
+   ulMallocs++;
+   return __real_malloc(uSize);
+}
+
+/* Count a call of calloc, and make it. */
+
+void *__wrap_calloc(size_t uCount, size_t uSize)
+{
+   ulMallocs++;
+   return __real_calloc(uCount, uSize);
+}
+
+/* Count a call of realloc, and make it. */
+
+void *__wrap_realloc(void *pvOld, size_t uSize)
+{
+   ulMallocs++;
+   return __real_realloc(pvOld, uSize);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the current time in nanoseconds. */
+
+static unsigned long now(void)
+{
+   struct timespec sTime;
+
+   (void)clock_gettime(CLOCK_MONOTONIC, &sTime);
+   return (unsigned long)sTime.tv_sec * 1000000000UL
+      + (unsigned long)sTime.tv_nsec;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the peak resident set size of the process, in kilobytes. */
+
+static long peakRss(void)
+{
+   struct rusage sUsage;
+
+   if (getrusage(RUSAGE_SELF, &sUsage) != 0)
+      return -1;
+   return sUsage.ru_maxrss;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Exit the program, reporting that memory ran out. */
+
+static void outOfMemory(void)
+{
+   fprintf(stderr, "ftbench: out of memory\n");
+   exit(EXIT_FAILURE);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return a uniformly random number from 0 to uBound - 1, for a
+   positive uBound. */
+
+static size_t randomBelow(size_t uBound)
+{
+   size_t uValue;
+
+   uValue = ((size_t)rand() << 16) ^ (size_t)rand();
+   return uValue % uBound;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return a file size from a heavy-tailed distribution: 64 to 127
+   bytes half the time, and each next power of 2 half as often as the
+   one before, up to MAX_FILE_SIZE. */
+
+static size_t randomFileSize(void)
+{
+   size_t uShift = 6;
+
+   while (uShift < 19 && rand() % 2 == 0)
+      uShift++;
+   return ((size_t)1 << uShift) + randomBelow((size_t)1 << uShift);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Add to psTree a node named by the format pcFormat with uNumber, as
+   a child of the node of index uParent, or as the root if psTree has
+   no nodes.  It is a file of uSize bytes if bFile is 1 (TRUE), and a
+   directory otherwise.  Return the new node's index. */
+
+static size_t addItem(struct Tree *psTree, size_t uParent,
+                      const char *pcFormat, size_t uNumber,
+                      int bFile, size_t uSize)
+{
+   struct Item *psItem;
+   const char *pcParentPath = "";
+   char acName[32];
+   size_t uLength;
+
+   if (psTree->uItems == psTree->uCapacity)
+   {
+      psTree->uCapacity = psTree->uCapacity == 0
+                          ? 1024 : psTree->uCapacity * 2;
+      psItem = (struct Item*)realloc(psTree->psItems,
+                                     psTree->uCapacity
+                                     * sizeof(struct Item));
+      if (psItem == NULL)
+         outOfMemory();
+      psTree->psItems = psItem;
+   }
+
+   sprintf(acName, pcFormat, (unsigned long)uNumber);
+   if (psTree->uItems == 0)
+      uParent = 0;
+   else
+      pcParentPath = psTree->psItems[uParent].pcPath;
+
+   psItem = &psTree->psItems[psTree->uItems];
+   uLength = strlen(pcParentPath) + 1 + strlen(acName) + 1;
+   psItem->pcPath = (char*)malloc(uLength);
+   psItem->pcMissing = (char*)malloc(uLength + 1);
+   if (psItem->pcPath == NULL || psItem->pcMissing == NULL)
+      outOfMemory();
+   if (psTree->uItems == 0)
+      strcpy(psItem->pcPath, acName);
+   else
+      sprintf(psItem->pcPath, "%s/%s", pcParentPath, acName);
+   sprintf(psItem->pcMissing, "%s~", psItem->pcPath);
+
+   psItem->uParent = psTree->uItems == 0 ? 0 : uParent;
+   psItem->bFile = bFile;
+   psItem->uSize = bFile ? uSize : 0;
+   return psTree->uItems++;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Generate a chain of uDepth directories into psTree. */
+
+static void makeChain(struct Tree *psTree, size_t uDepth)
+{
+   size_t uAt = 0;
+   size_t u;
+
+   psTree->pcShape = "chain";
+   for (u = 0; u < uDepth; u++)
+      uAt = addItem(psTree, uAt, "d%lu", u, 0, 0);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Generate a directory of uFiles files into psTree. */
+
+static void makeWide(struct Tree *psTree, size_t uFiles)
+{
+   size_t u;
+
+   psTree->pcShape = "wide";
+   (void)addItem(psTree, 0, "r", 0, 0, 0);
+   for (u = 0; u < uFiles; u++)
+      (void)addItem(psTree, 0, "f%lu", u, 1, randomFileSize());
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Generate into psTree a tree of uFanout directories per directory,
+   as deep as keeps it within uNodes nodes, with files as leaves. */
+
+static void makeBalanced(struct Tree *psTree, size_t uNodes,
+                         size_t uFanout)
+{
+   size_t uLevelStart = 0;
+   size_t uLevelEnd;
+   size_t uLevelSize = 1;
+   size_t uTotal = 1;
+   size_t uDepth = 0;
+   size_t uParent;
+   size_t uLevel;
+   size_t u;
+
+   psTree->pcShape = "balanced";
+   while (uTotal + uLevelSize * uFanout <= uNodes)
+   {
+      uLevelSize *= uFanout;
+      uTotal += uLevelSize;
+      uDepth++;
+   }
+
+   (void)addItem(psTree, 0, "r", 0, 0, 0);
+   for (uLevel = 1; uLevel <= uDepth; uLevel++)
+   {
+      uLevelEnd = psTree->uItems;
+      for (uParent = uLevelStart; uParent < uLevelEnd; uParent++)
+         for (u = 0; u < uFanout; u++)
+         {
+            if (uLevel == uDepth)
+               (void)addItem(psTree, uParent, "f%lu", u, 1,
+                             randomFileSize());
+            else
+               (void)addItem(psTree, uParent, "d%lu", u, 0, 0);
+         }
+      uLevelStart = uLevelEnd;
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Generate into psTree a tree of uNodes nodes, a fifth of them
+   directories, each put beside the node before it half the time and
+   in a random directory otherwise. */
+
+static void makeRealistic(struct Tree *psTree, size_t uNodes)
+{
+   size_t *puDirs;
+   size_t uDirs = 1;
+   size_t uParent = 0;
+   size_t uNode;
+   size_t u;
+
+   psTree->pcShape = "realistic";
+   puDirs = (size_t*)malloc(uNodes * sizeof(size_t) + 1);
+   if (puDirs == NULL)
+      outOfMemory();
+
+   puDirs[0] = addItem(psTree, 0, "r", 0, 0, 0);
+   for (u = 1; u < uNodes; u++)
+   {
+      if (rand() % 2 != 0)
+         uParent = puDirs[randomBelow(uDirs)];
+      if (rand() % 5 == 0)
+      {
+         uNode = addItem(psTree, uParent, "d%lu", u, 0, 0);
+         puDirs[uDirs++] = uNode;
+      }
+      else
+         (void)addItem(psTree, uParent, "f%lu", u, 1,
+                       randomFileSize());
+   }
+   free(puDirs);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Fill psTree's order with a random permutation of its nodes. */
+
+static void shuffle(struct Tree *psTree)
+{
+   size_t u;
+   size_t uOther;
+   size_t uTemp;
+
+   psTree->puOrder = (size_t*)malloc(psTree->uItems * sizeof(size_t)
+                                     + 1);
+   if (psTree->puOrder == NULL)
+      outOfMemory();
+   for (u = 0; u < psTree->uItems; u++)
+      psTree->puOrder[u] = u;
+   for (u = psTree->uItems; u > 1; u--)
+   {
+      uOther = randomBelow(u);
+      uTemp = psTree->puOrder[u - 1];
+      psTree->puOrder[u - 1] = psTree->puOrder[uOther];
+      psTree->puOrder[uOther] = uTemp;
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Free the nodes of psTree. */
+
+static void freeTree(struct Tree *psTree)
+{
+   size_t u;
+
+   for (u = 0; u < psTree->uItems; u++)
+   {
+      free(psTree->psItems[u].pcPath);
+      free(psTree->psItems[u].pcMissing);
+   }
+   free(psTree->psItems);
+   free(psTree->puOrder);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Start a new, empty tree, owning its contents if bOwned is 1
+   (TRUE), and insert every node of psTree into it.  Return the
+   number of insertions that failed. */
+
+static size_t build(const struct Tree *psTree, int bOwned)
+{
+   const struct Item *psItem;
+   size_t uFailed = 0;
+   size_t u;
+   int iStatus;
+
+   if (bOwned)
+      (void)FT_initOwned();
+   else
+      (void)FT_init();
+   for (u = 0; u < psTree->uItems; u++)
+   {
+      psItem = &psTree->psItems[u];
+      if (psItem->bFile)
+         iStatus = FT_insertFile(psItem->pcPath, pcContents,
+                                 psItem->uSize);
+      else
+         iStatus = FT_insertDir(psItem->pcPath);
+      if (iStatus != SUCCESS)
+         uFailed++;
+   }
+   return uFailed;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Start measuring a workload into *psResult. */
+
+static void begin(struct Result *psResult)
+{
+   psResult->uCalls = 0;
+   psResult->ulMallocs = ulMallocs;
+   psResult->ulNanos = now();
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Finish measuring a workload of uCalls calls into *psResult. */
+
+static void end(struct Result *psResult, size_t uCalls)
+{
+   psResult->ulNanos = now() - psResult->ulNanos;
+   psResult->ulMallocs = ulMallocs - psResult->ulMallocs;
+   psResult->uCalls = uCalls;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Print the row of workload pcWorkload on psTree, measured as
+   *psResult, as CSV, or as JSON if bJson is 1 (TRUE). */
+
+static void report(const struct Tree *psTree, const char *pcWorkload,
+                   const struct Result *psResult, int bJson)
+{
+   double dNsPerCall = 0;
+   double dCallsPerSec = 0;
+
+   if (psResult->uCalls > 0)
+      dNsPerCall = (double)psResult->ulNanos / (double)psResult->uCalls;
+   if (psResult->ulNanos > 0)
+      dCallsPerSec = (double)psResult->uCalls * 1e9
+                     / (double)psResult->ulNanos;
+
+   if (bJson)
+   {
+      printf("%s\n  {\"shape\": \"%s\", \"workload\": \"%s\", "
+             "\"nodes\": %lu, \"ops\": %lu, \"ns_per_op\": %.1f, "
+             "\"ops_per_s\": %.0f, \"peak_rss_kb\": %ld, "
+             "\"mallocs\": %lu}",
+             bJsonRows ? "," : "", psTree->pcShape, pcWorkload,
+             (unsigned long)psTree->uItems,
+             (unsigned long)psResult->uCalls, dNsPerCall,
+             dCallsPerSec, peakRss(), psResult->ulMallocs);
+      bJsonRows = 1;
+   }
+   else
+      printf("%s,%s,%lu,%lu,%.1f,%.0f,%ld,%lu\n", psTree->pcShape,
+             pcWorkload, (unsigned long)psTree->uItems,
+             (unsigned long)psResult->uCalls, dNsPerCall,
+             dCallsPerSec, peakRss(), psResult->ulMallocs);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Look up every node of psTree, which must be in the tree, in random
+   order.  Return the number of lookups that did not find it. */
+
+static size_t lookupAll(const struct Tree *psTree)
+{
+   const struct Item *psItem;
+   size_t uFailed = 0;
+   size_t u;
+
+   for (u = 0; u < psTree->uItems; u++)
+   {
+      psItem = &psTree->psItems[psTree->puOrder[u]];
+      if (psItem->bFile ? !FT_containsFile(psItem->pcPath)
+                        : !FT_containsDir(psItem->pcPath))
+         uFailed++;
+   }
+   return uFailed;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Run each workload on psTree, in a tree owning its contents if
+   bOwned is 1 (TRUE), and report them as JSON if bJson is 1 (TRUE)
+   or as CSV otherwise.  Return 0 (FALSE) if a call failed that
+   should not have, or 1 (TRUE) otherwise. */
+
+static int runWorkloads(const struct Tree *psTree, int bOwned,
+                        int bJson)
+{
+   const struct Item *psItem;
+   struct Result sResult;
+   boolean bType;
+   size_t uLength;
+   size_t uFailed = 0;
+   size_t uRemoved = 0;
+   size_t u;
+   char *pcString;
+
+   begin(&sResult);
+   uFailed += build(psTree, bOwned);
+   end(&sResult, psTree->uItems);
+   report(psTree, "insert", &sResult, bJson);
+
+   begin(&sResult);
+   uFailed += lookupAll(psTree);
+   end(&sResult, psTree->uItems);
+   report(psTree, "lookup_hit", &sResult, bJson);
+
+   begin(&sResult);
+   for (u = 0; u < psTree->uItems; u++)
+      if (FT_containsFile(psTree->psItems[psTree->puOrder[u]]
+                          .pcMissing))
+         uFailed++;
+   end(&sResult, psTree->uItems);
+   report(psTree, "lookup_miss", &sResult, bJson);
+
+   begin(&sResult);
+   for (u = 0; u < psTree->uItems; u++)
+      if (FT_stat(psTree->psItems[psTree->puOrder[u]].pcPath, &bType,
+                  &uLength) != SUCCESS)
+         uFailed++;
+   end(&sResult, psTree->uItems);
+   report(psTree, "stat", &sResult, bJson);
+
+   begin(&sResult);
+   if (FT_compact(NULL) != SUCCESS)
+      uFailed++;
+   end(&sResult, 1);
+   report(psTree, "compact", &sResult, bJson);
+
+   begin(&sResult);
+   uFailed += lookupAll(psTree);
+   end(&sResult, psTree->uItems);
+   report(psTree, "lookup_compact", &sResult, bJson);
+
+   begin(&sResult);
+   pcString = FT_toString();
+   end(&sResult, 1);
+   if (pcString == NULL)
+      uFailed++;
+   free(pcString);
+   report(psTree, "to_string", &sResult, bJson);
+
+   begin(&sResult);
+   for (u = 1; u < psTree->uItems; u++)
+   {
+      psItem = &psTree->psItems[u];
+      if (psItem->uParent != 0)
+         continue;
+      if ((psItem->bFile ? FT_rmFile(psItem->pcPath)
+                         : FT_rmDir(psItem->pcPath)) != SUCCESS)
+         uFailed++;
+      uRemoved++;
+   }
+   end(&sResult, uRemoved);
+   report(psTree, "remove_subtree", &sResult, bJson);
+   (void)FT_destroy();
+
+   uFailed += build(psTree, bOwned);
+   begin(&sResult);
+   if (FT_destroy() != SUCCESS)
+      uFailed++;
+   end(&sResult, 1);
+   report(psTree, "destroy", &sResult, bJson);
+
+   return uFailed == 0;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Build psTree, in a tree owning its contents if bOwned is 1 (TRUE),
+   and report its memory as JSON if bJson is 1 (TRUE) or as CSV
+   otherwise.  Return 0 (FALSE) if a call failed that should not
+   have, or 1 (TRUE) otherwise. */
+
+static int reportMemory(const struct Tree *psTree, int bOwned,
+                        int bJson)
+{
+   struct FT_MemStats sStats;
+   size_t uFailed;
+   double dPerNode = 0;
+
+   uFailed = build(psTree, bOwned);
+   if (FT_memoryUsage(&sStats) != SUCCESS)
+      uFailed++;
+   (void)FT_destroy();
+   if (sStats.nodes > 0)
+      dPerNode = (double)sStats.totalBytes / (double)sStats.nodes;
+
+   if (bJson)
+   {
+      printf("%s\n  {\"shape\": \"%s\", \"nodes\": %lu, "
+             "\"node_bytes\": %lu, \"path_bytes\": %lu, "
+             "\"child_bytes\": %lu, \"child_used_bytes\": %lu, "
+             "\"content_bytes\": %lu, \"total_bytes\": %lu, "
+             "\"bytes_per_node\": %.1f}",
+             bJsonRows ? "," : "", psTree->pcShape,
+             (unsigned long)sStats.nodes,
+             (unsigned long)sStats.nodeBytes,
+             (unsigned long)sStats.pathBytes,
+             (unsigned long)sStats.childBytes,
+             (unsigned long)sStats.childUsedBytes,
+             (unsigned long)sStats.contentBytes,
+             (unsigned long)sStats.totalBytes, dPerNode);
+      bJsonRows = 1;
+   }
+   else
+      printf("%s,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%.1f\n", psTree->pcShape,
+             (unsigned long)sStats.nodes,
+             (unsigned long)sStats.nodeBytes,
+             (unsigned long)sStats.pathBytes,
+             (unsigned long)sStats.childBytes,
+             (unsigned long)sStats.childUsedBytes,
+             (unsigned long)sStats.contentBytes,
+             (unsigned long)sStats.totalBytes, dPerNode);
+
+   return uFailed == 0;
+}
+
+/*--------------------------------------------------------------------*/
+
+int main(int argc, char *argv[])
+{
+   struct Tree sTree;
+   size_t uNodes = 100000;
+   size_t uFanout = 8;
+   size_t uDepth = 1000;
+   size_t uShape;
+   int bJson = 0;
+   int bOwned = 0;
+   int bMemory = 0;
+   int bPassed = 1;
+   int iOption;
+
+   while ((iOption = getopt(argc, argv, "jomn:k:d:s:")) != -1)
+      switch (iOption)
+      {
+         case 'j':
+            bJson = 1;
+            break;
+         case 'o':
+            bOwned = 1;
+            break;
+         case 'm':
+            bMemory = 1;
+            break;
+         case 'n':
+            uNodes = (size_t)strtoul(optarg, NULL, 10);
+            break;
+         case 'k':
+            uFanout = (size_t)strtoul(optarg, NULL, 10);
+            break;
+         case 'd':
+            uDepth = (size_t)strtoul(optarg, NULL, 10);
+            break;
+         case 's':
+            srand((unsigned)strtoul(optarg, NULL, 10));
+            break;
+         default:
+            fprintf(stderr, "usage: %s [-j] [-o] [-m] [-n nodes] "
+                    "[-k fanout] [-d depth] [-s seed]\n", argv[0]);
+            return EXIT_FAILURE;
+      }
+   if (uNodes < 2 || uFanout < 1 || uDepth < 1)
+   {
+      fprintf(stderr, "ftbench: nodes must be at least 2, and fanout "
+              "and depth at least 1\n");
+      return EXIT_FAILURE;
+   }
+
+   pcContents = (char*)calloc(MAX_FILE_SIZE, 1);
+   if (pcContents == NULL)
+      outOfMemory();
+
+   if (bJson)
+      printf("[");
+   else if (bMemory)
+      printf("shape,nodes,node_bytes,path_bytes,child_bytes,"
+             "child_used_bytes,content_bytes,total_bytes,"
+             "bytes_per_node\n");
+   else
+      printf("shape,workload,nodes,ops,ns_per_op,ops_per_s,"
+             "peak_rss_kb,mallocs\n");
+
+   for (uShape = 0; uShape < 4; uShape++)
+   {
+      memset(&sTree, 0, sizeof(sTree));
+      switch (uShape)
+      {
+         case 0:
+            makeChain(&sTree, uDepth);
+            break;
+         case 1:
+            makeWide(&sTree, uNodes - 1);
+            break;
+         case 2:
+            makeBalanced(&sTree, uNodes, uFanout);
+            break;
+         default:
+            makeRealistic(&sTree, uNodes);
+            break;
+      }
+      shuffle(&sTree);
+      if (bMemory ? !reportMemory(&sTree, bOwned, bJson)
+                  : !runWorkloads(&sTree, bOwned, bJson))
+      {
+         fprintf(stderr, "ftbench: a call failed on the %s tree\n",
+                 sTree.pcShape);
+         bPassed = 0;
+      }
+      freeTree(&sTree);
+   }
+
+   if (bJson)
+      printf("\n]\n");
+   free(pcContents);
+   return bPassed ? 0 : EXIT_FAILURE;
+}
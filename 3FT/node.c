@@ -6,235 +6,686 @@
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
+#include <stdint.h>
 
-#include "dynarray.h"
+#include "allocator.h"
+#include "typedarray.h"
+#include "btree.h"
+#include "rope.h"
 #include "node.h"
 
+/* the source of the memory of nodes, their paths and their arrays
+   of children; see Node_setAllocator */
+static const struct Allocator* allocator = &Allocator_heap;
+
+/* A NodeArray_T is an array of Node_T, searched and sorted with
+   inlined comparisons (see typedarray.h). */
+TYPEDARRAY_DEFINE_ALLOC(NodeArray, Node_T, allocator)
+
+/* The number of leading characters of a name kept in a NodeKey. */
+enum { KEY_PREFIX_LEN = 8 };
+
 /*
-   A node structure represents a file or a directory in the tree
+   The start of a child's name, kept beside the child so that most
+   steps of a search are decided without touching the child or its
+   path: prefix holds the first KEY_PREFIX_LEN characters of the name,
+   the first in the most significant byte and padded with zeros, so
+   that prefixes compare as the names do; length is the length of the
+   name.
 */
-struct node {
-   /* the full path of this node */
-   char* path;
+struct NodeKey {
+   uint64_t prefix;
+   size_t length;
+};
 
-   /* the parent of this node
-      NULL for the root of the tree */
-   Node_T parent;
+/* A KeyArray_T is an array of struct NodeKey. */
+TYPEDARRAY_DEFINE_ALLOC(KeyArray, struct NodeKey, allocator)
 
+/*
+   The children of a node of one type, held in a sorted NodeArray_T
+   while they are few, and in a BTree_T (see btree.h), sorted the same
+   way, while they are many enough that shifting the array on every
+   insert and remove would dominate. Exactly one of array and tree is
+   non-NULL. keys is non-NULL when array is, and holds the key of each
+   child in array at the same index.
+*/
+struct Children {
+   NodeArray_T array;
+   KeyArray_T keys;
+   BTree_T tree;
+};
+
+/* The part of a directory node after its header: its children. */
+struct NodeDir {
    /* the directory children nodes of this node
       stored in sorted order by name */
-   DynArray_T dirChildren;
+   struct Children dirChildren;
 
-    /* the file children nodes of this node
+   /* the file children nodes of this node
       stored in sorted order by name */
-    DynArray_T fileChildren;
+   struct Children fileChildren;
+};
 
-   /* if the node is a file, contains
-      contents. Otherwise, NULL  */
+/* The part of a file node after its header: its contents. */
+struct NodeFile {
+   /* the contents, if the tree does not own them. Otherwise, NULL */
    void* pvContents;
 
-   /* if the node is a file, contains
-      length. Otherwise, NULL */
+   /* the length of pvContents. Otherwise, 0 */
    size_t uLength;
 
+   /* if the contents are owned by the tree, holds them in place of
+      pvContents. Otherwise, NULL */
+   Rope_T oRope;
+};
+
+/*
+   A node structure represents a file or a directory in the tree.
+   A traversal reads only its header, the fields up to u, and the
+   children of the directories it passes through. A directory's
+   children and a file's contents are never needed together, so they
+   share the storage after the header, and a file node is allocated
+   only as long as its contents need (see Node_bytes).
+*/
+struct node {
+   /* the full path of this node */
+   char* path;
+
+   /* the parent of this node
+      NULL for the root of the tree */
+   Node_T parent;
+
    /* contains information on if the node
       is a file or a directory. */
    nodeType type;
+
+   /* the index + 1 of the tree's handle slot that names this node,
+      or 0 if no handle has been opened on it; kept in the space
+      type leaves before the next pointer */
+   uint32_t handle;
+
+   /* the children of a directory, or the contents of a file */
+   union {
+      struct NodeDir dir;
+      struct NodeFile file;
+   } u;
 };
 
+/* the memory held by all nodes that exist; see Node_getMemStats */
+static struct NodeMemStats memStats;
+
+/* Returns the number of bytes allocated for a node of type type. */
+static size_t Node_bytes(nodeType type) {
+   if(type == ISFILE)
+      return offsetof(struct node, u) + sizeof(struct NodeFile);
+   return sizeof(struct node);
+}
+
+/*
+   Compares node1 and node2 based on their paths.
+   Returns <0, 0, or >0 if node1 is less than or
+equal to, or greater than node2, respectively.
+*/
+static inline int Node_compare(Node_T node1, Node_T node2) {
+   assert(node1 != NULL);
+   assert(node2 != NULL);
+
+   return strcmp(node1->path, node2->path);
+}
+
+/*
+   A name sought among the children of a node: the length characters
+   at name, which need not be null-terminated, compared with the final
+   path component of each child, which starts prefixLen + 1 characters
+   into its path (prefixLen being the length of the parent's path).
+   prefix is the name's prefix, as in a NodeKey.
+*/
+struct NodeName {
+   const char* name;
+   size_t length;
+   size_t prefixLen;
+   uint64_t prefix;
+};
+
+/*
+   Returns the prefix, as in a NodeKey, of the length characters at
+   name.
+*/
+static inline uint64_t Node_prefixOf(const char* name, size_t length) {
+   uint64_t prefix = 0;
+   size_t i;
+
+   for(i = 0; i < KEY_PREFIX_LEN; i++)
+      prefix = (prefix << 8)
+               | (i < length ? (unsigned char) name[i] : 0);
+   return prefix;
+}
+
+/* Makes key name the length characters at name. */
+static inline void Node_setName(struct NodeName* key, const char* name,
+                                size_t length) {
+   key->name = name;
+   key->length = length;
+   key->prefix = Node_prefixOf(name, length);
+}
+
+/*
+   Returns the key of the child n of a node whose path is prefixLen
+   characters long.
+*/
+static struct NodeKey Node_keyOf(Node_T n, size_t prefixLen) {
+   struct NodeKey k;
+
+   k.length = strlen(n->path + prefixLen + 1);
+   k.prefix = Node_prefixOf(n->path + prefixLen + 1, k.length);
+   return k;
+}
+
+/*
+   Compares the name key with the final path component of the child n.
+   Returns <0, 0, or >0 if key is less than, equal to, or greater than
+   that component, respectively. Siblings share the prefix of their
+   paths, so this orders them as Node_compare does.
+*/
+static inline int Node_compareName(const struct NodeName* key,
+                                   Node_T n) {
+   const char* component = n->path + key->prefixLen + 1;
+   int result;
+
+   result = strncmp(key->name, component, key->length);
+   if(result == 0 && component[key->length] != '\0')
+      result = -1;
+   return result;
+}
+
+TYPEDARRAY_DEFINE_ORDER(NodeArray, Node_T, const struct NodeName*,
+                        Node_compareName, Node_compare)
+
+/*
+   Children move into a tree when there come to be more than
+   CHILDREN_TREE_MIN of them, and back into an array when there come
+   to be fewer than CHILDREN_ARRAY_MAX. The gap keeps a directory
+   whose size hovers near one threshold from converting back and
+   forth.
+*/
+enum { CHILDREN_TREE_MIN = 2048, CHILDREN_ARRAY_MAX = 512 };
+
+/*
+   Compares the name key with the final path component of the child
+   n, as Node_compareName does, for BTree_bsearch.
+*/
+static int Node_compareNameKey(const void* key, const void* n) {
+   return Node_compareName((const struct NodeName*) key,
+                           (Node_T) n);
+}
+
+/*
+   Adds the storage of c to memStats if add is TRUE, or takes it out
+   if add is FALSE. Every change to c is bracketed by the two, so that
+   memStats follows it without walking the children.
+*/
+static void Children_account(const struct Children* c, boolean add) {
+   size_t bytes = 0;
+   size_t used = 0;
+
+   if(c->tree != NULL) {
+      bytes = BTree_getBytes(c->tree);
+      used = BTree_getLength(c->tree) * sizeof(Node_T);
+   }
+   else if(c->array != NULL) {
+      bytes = sizeof(struct NodeArray) + sizeof(struct KeyArray)
+              + NodeArray_getPhysLength(c->array) * sizeof(Node_T)
+              + KeyArray_getPhysLength(c->keys)
+                * sizeof(struct NodeKey);
+      used = NodeArray_getLength(c->array)
+             * (sizeof(Node_T) + sizeof(struct NodeKey));
+   }
+   if(add) {
+      memStats.childBytes += bytes;
+      memStats.childUsedBytes += used;
+   }
+   else {
+      memStats.childBytes -= bytes;
+      memStats.childUsedBytes -= used;
+   }
+}
+
+/*
+   Makes c an empty set of children.
+   Returns TRUE, or FALSE if there is an allocation error.
+*/
+static boolean Children_init(struct Children* c) {
+   c->tree = NULL;
+   c->array = NodeArray_new(0);
+   c->keys = KeyArray_new(0);
+   if(c->array == NULL || c->keys == NULL) {
+      if(c->array != NULL) NodeArray_free(c->array);
+      if(c->keys != NULL) KeyArray_free(c->keys);
+      return FALSE;
+   }
+   Children_account(c, TRUE);
+   return TRUE;
+}
+
+/* Frees the storage of c, but not the children in it. */
+static void Children_free(struct Children* c) {
+   Children_account(c, FALSE);
+   if(c->array != NULL) NodeArray_free(c->array);
+   if(c->keys != NULL) KeyArray_free(c->keys);
+   if(c->tree != NULL) BTree_free(c->tree);
+   c->array = NULL;
+   c->keys = NULL;
+   c->tree = NULL;
+}
+
+/* Returns the number of children in c. */
+static size_t Children_getLength(const struct Children* c) {
+   if(c->tree != NULL) return BTree_getLength(c->tree);
+   if(c->array != NULL) return NodeArray_getLength(c->array);
+   return 0;
+}
+
+/* Returns the child at index i of c, in order by name. */
+static Node_T Children_get(const struct Children* c, size_t i) {
+   if(c->tree != NULL) return (Node_T) BTree_get(c->tree, i);
+   return NodeArray_get(c->array, i);
+}
+
+/*
+   Searches c for the child named by key. Returns 1 and sets *i to
+   its index if there is one, or else returns 0 and sets *i to the
+   index where it would belong.
+*/
+static int Children_bsearch(const struct Children* c,
+                            const struct NodeName* key, size_t* i) {
+   struct NodeKey k;
+   size_t lo = 0;
+   size_t hi;
+   size_t mid;
+   int result;
+
+   if(c->tree != NULL)
+      return BTree_bsearch(c->tree, key, i, Node_compareNameKey);
+
+   /* only names that share their whole prefix, and are both longer
+      than it, need the child's path to tell them apart */
+   hi = KeyArray_getLength(c->keys);
+   while(lo < hi) {
+      mid = lo + (hi - lo) / 2;
+      k = KeyArray_get(c->keys, mid);
+      if(key->prefix != k.prefix)
+         result = key->prefix < k.prefix ? -1 : 1;
+      else if(key->length <= KEY_PREFIX_LEN
+              || k.length <= KEY_PREFIX_LEN)
+         result = (key->length > k.length) - (key->length < k.length);
+      else
+         result = Node_compareName(key, NodeArray_get(c->array, mid));
+      if(result == 0) {
+         *i = mid;
+         return 1;
+      }
+      if(result < 0) hi = mid;
+      else lo = mid + 1;
+   }
+   *i = lo;
+   return 0;
+}
+
+/*
+   Returns a new array of the keys of the children in the array of c,
+   whose parent's path is prefixLen characters long, or NULL if there
+   is an allocation error.
+*/
+static KeyArray_T Children_makeKeys(const struct Children* c,
+                                    size_t prefixLen) {
+   KeyArray_T keys;
+   size_t length = NodeArray_getLength(c->array);
+   size_t i;
+
+   keys = KeyArray_new(length);
+   if(keys == NULL) return NULL;
+   for(i = 0; i < length; i++)
+      (void) KeyArray_set(keys, i,
+                          Node_keyOf(NodeArray_get(c->array, i),
+                                     prefixLen));
+   return keys;
+}
+
+/*
+   Moves the children of c, whose parent's path is prefixLen
+   characters long, into a tree if there are more than
+   CHILDREN_TREE_MIN, or into an array if there are fewer than
+   CHILDREN_ARRAY_MAX. If there is an allocation error, c is left
+   as it was, which is slower but still correct.
+*/
+static void Children_adapt(struct Children* c, size_t prefixLen) {
+   size_t length = Children_getLength(c);
+   size_t i;
+   BTree_T tree;
+   NodeArray_T array;
+   KeyArray_T keys;
+
+   if(c->array != NULL && length > CHILDREN_TREE_MIN) {
+      tree = BTree_new();
+      if(tree == NULL) return;
+      for(i = 0; i < length; i++)
+         if(!BTree_addAt(tree, i, NodeArray_get(c->array, i))) {
+            BTree_free(tree);
+            return;
+         }
+      NodeArray_free(c->array);
+      KeyArray_free(c->keys);
+      c->array = NULL;
+      c->keys = NULL;
+      c->tree = tree;
+   }
+   else if(c->tree != NULL && length < CHILDREN_ARRAY_MAX) {
+      array = NodeArray_new(0);
+      if(array == NULL) return;
+      if(!NodeArray_reserve(array, length)) {
+         NodeArray_free(array);
+         return;
+      }
+      for(i = 0; i < length; i++)
+         (void) NodeArray_add(array, (Node_T) BTree_get(c->tree, i));
+      c->array = array;
+      keys = Children_makeKeys(c, prefixLen);
+      if(keys == NULL) {
+         NodeArray_free(array);
+         c->array = NULL;
+         return;
+      }
+      BTree_free(c->tree);
+      c->tree = NULL;
+      c->keys = keys;
+   }
+}
+
+/*
+   Inserts child, named by key, into c at index i. Returns TRUE, or
+   FALSE if there is an allocation error, in which case c is
+   unchanged.
+*/
+static boolean Children_addAt(struct Children* c, size_t i,
+                              Node_T child,
+                              const struct NodeName* key) {
+   struct NodeKey k;
+   boolean added = TRUE;
+
+   Children_account(c, FALSE);
+   if(c->tree != NULL)
+      added = BTree_addAt(c->tree, i, child);
+   else {
+      k.prefix = key->prefix;
+      k.length = key->length;
+      if(!KeyArray_addAt(c->keys, i, k))
+         added = FALSE;
+      else if(!NodeArray_addAt(c->array, i, child)) {
+         (void) KeyArray_removeAt(c->keys, i);
+         added = FALSE;
+      }
+   }
+   if(added) Children_adapt(c, key->prefixLen);
+   Children_account(c, TRUE);
+   return added;
+}
+
+/*
+   Removes and returns the child at index i of c, whose parent's path
+   is prefixLen characters long.
+*/
+static Node_T Children_removeAt(struct Children* c, size_t i,
+                                size_t prefixLen) {
+   Node_T child;
+
+   Children_account(c, FALSE);
+   if(c->tree != NULL) child = (Node_T) BTree_removeAt(c->tree, i);
+   else {
+      child = NodeArray_removeAt(c->array, i);
+      (void) KeyArray_removeAt(c->keys, i);
+   }
+   Children_adapt(c, prefixLen);
+   Children_account(c, TRUE);
+   return child;
+}
+
+/*
+   Removes from c each of the count nodes at nodes, all of which must
+   be in c, whose parent's path is prefixLen characters long.
+*/
+static void Children_removeAll(struct Children* c, Node_T* nodes,
+                               size_t count, size_t prefixLen) {
+   struct NodeName key;
+   const char* name;
+   size_t i;
+   size_t j;
+
+   key.prefixLen = prefixLen;
+   for(i = 0; i < count; i++) {
+      name = nodes[i]->path + prefixLen + 1;
+      Node_setName(&key, name, strlen(name));
+      if(Children_bsearch(c, &key, &j))
+         (void) Children_removeAt(c, j, prefixLen);
+   }
+}
+
+/*
+   Merges into c the count nodes at nodes, which are sorted by path,
+   have names new to c, and have a parent whose path is prefixLen
+   characters long. Returns TRUE, or FALSE if there is an allocation
+   error, in which case c is unchanged.
+*/
+static boolean Children_addAllSorted(struct Children* c,
+                                     Node_T* nodes, size_t count,
+                                     size_t prefixLen) {
+   struct NodeName key;
+   const char* name;
+   KeyArray_T keys;
+   size_t i;
+   size_t j;
+
+   if(c->array != NULL) {
+      /* the keys are refilled after the merge, in its order */
+      keys = KeyArray_new(NodeArray_getLength(c->array) + count);
+      if(keys == NULL) return FALSE;
+      Children_account(c, FALSE);
+      if(!NodeArray_reserve(c->array,
+                            NodeArray_getLength(c->array) + count)) {
+         Children_account(c, TRUE);
+         KeyArray_free(keys);
+         return FALSE;
+      }
+      (void) NodeArray_addAllSorted(c->array, nodes, count);
+      for(i = 0; i < NodeArray_getLength(c->array); i++)
+         (void) KeyArray_set(keys, i,
+                             Node_keyOf(NodeArray_get(c->array, i),
+                                        prefixLen));
+      KeyArray_free(c->keys);
+      c->keys = keys;
+      Children_adapt(c, prefixLen);
+      Children_account(c, TRUE);
+      return TRUE;
+   }
+
+   /* a tree takes them one at a time, each in logarithmic time */
+   key.prefixLen = prefixLen;
+   Children_account(c, FALSE);
+   for(i = 0; i < count; i++) {
+      name = nodes[i]->path + prefixLen + 1;
+      Node_setName(&key, name, strlen(name));
+      (void) BTree_bsearch(c->tree, &key, &j, Node_compareNameKey);
+      if(!BTree_addAt(c->tree, j, nodes[i])) {
+         Children_account(c, TRUE);
+         Children_removeAll(c, nodes, i, prefixLen);
+         return FALSE;
+      }
+   }
+   Children_account(c, TRUE);
+   return TRUE;
+}
+
+/*
+   Adds the owned contents of the file n, if any, to memStats if add
+   is TRUE, or takes them out if add is FALSE, as Children_account
+   does for children.
+*/
+static void Node_accountContents(Node_T n, boolean add) {
+   if(n->u.file.oRope == NULL) return;
+   if(add) memStats.contentBytes += Rope_getBytes(n->u.file.oRope);
+   else memStats.contentBytes -= Rope_getBytes(n->u.file.oRope);
+}
 
 /*
   returns a path with contents
   n->path/dir
+  where dir is the nameLength characters at nodeName,
   or NULL if there is an allocation error.
 
-  Allocates memory for the returned string,
+  Allocates memory for the returned string from allocator,
   which is then owned by the caller!
 */
-static char* Node_buildPath(Node_T n, const char* nodeName) {
+static char* Node_buildPath(Node_T n, const char* nodeName,
+                            size_t nameLength) {
    char* path;
+   size_t prefixLen = 0;
 
    assert(nodeName != NULL);
 
-   if(n == NULL)
-      path = malloc(strlen(nodeName)+1);
-   else
-      path = malloc(strlen(n->path) + 1 + strlen(nodeName) + 1);
+   if(n != NULL)
+      prefixLen = strlen(n->path) + 1;
 
+   path = Allocator_alloc(allocator, prefixLen + nameLength + 1);
    if(path == NULL)
       return NULL;
-   *path = '\0';
 
    if(n != NULL) {
-      strcpy(path, n->path);
-      strcat(path, "/");
+      memcpy(path, n->path, prefixLen - 1);
+      path[prefixLen - 1] = '/';
    }
-   strcat(path, nodeName);
+   memcpy(path + prefixLen, nodeName, nameLength);
+   path[prefixLen + nameLength] = '\0';
 
    return path;
 }
 
+/* Frees path, which was returned by Node_buildPath. */
+static void Node_freePath(char* path) {
+   Allocator_free(allocator, path, strlen(path) + 1);
+}
+
 /* see node.h for specification */
-Node_T Node_create(const char* nodeName, Node_T parent, void* contents, size_t length, nodeType type){
+Node_T Node_create(const char* nodeName, size_t nameLength,
+                   Node_T parent, void* contents, size_t length,
+                   nodeType type){
    Node_T new;
 
    assert(nodeName != NULL);
 
-   new = malloc(sizeof(struct node));
+   new = Allocator_alloc(allocator, Node_bytes(type));
    if(new == NULL) {
       return NULL;
    }
 
-   new->path = Node_buildPath(parent, nodeName);
+   new->path = Node_buildPath(parent, nodeName, nameLength);
 
    if(new->path == NULL) {
-      free(new);
+      Allocator_free(allocator, new, Node_bytes(type));
       return NULL;
    }
 
    new->parent = parent;
+   new->handle = 0;
 
    if(type == ISFILE){
-       new->dirChildren = NULL;
-       new->fileChildren = NULL;
-       new->uLength= length;
-       new->pvContents = contents;
+       new->u.file.oRope = NULL;
+       new->u.file.uLength= length;
+       new->u.file.pvContents = contents;
        new->type = type;
    }
    else{
        new->type = type;
-       new->fileChildren = DynArray_new(0);
-       if(new->fileChildren == NULL) {
-          free(new->path);
-          free(new);
+       if(!Children_init(&new->u.dir.fileChildren)) {
+          Node_freePath(new->path);
+          Allocator_free(allocator, new, Node_bytes(type));
           return NULL;
        }
-       new->dirChildren = DynArray_new(0);
-       if(new->dirChildren == NULL) {
-           free(new->path);
-           free(new);
+       if(!Children_init(&new->u.dir.dirChildren)) {
+           Children_free(&new->u.dir.fileChildren);
+           Node_freePath(new->path);
+           Allocator_free(allocator, new, Node_bytes(type));
            return NULL;
        }
    }
 
+   memStats.nodes++;
+   memStats.nodeBytes += Node_bytes(type);
+   memStats.pathBytes += strlen(new->path) + 1;
    return new;
 }
 
-/* see node.h for specification */
-size_t Node_destroy(Node_T n, nodeType type) {
+/*
+   Frees n, of type type, and every node beneath it, as Node_destroy
+   does, and the contents the tree owns of each file among them if
+   withContents is TRUE; otherwise those contents are left to a copy
+   of the nodes. Returns the number of nodes freed.
+*/
+static size_t Node_free(Node_T n, nodeType type, boolean withContents) {
    size_t i;
    size_t count = 0;
    Node_T c;
 
-   assert(n != NULL);
-
    if (type == ISDIRECTORY) {
-       for (i = 0; i < DynArray_getLength(n->dirChildren); i++) {
-           c = DynArray_get(n->dirChildren, i);
-           count += Node_destroy(c, c->type);
+       for (i = 0; i < Children_getLength(&n->u.dir.dirChildren); i++) {
+           c = Children_get(&n->u.dir.dirChildren, i);
+           count += Node_free(c, c->type, withContents);
        }
-       DynArray_free(n->dirChildren);
-       for (i = 0; i < DynArray_getLength(n->fileChildren); i++) {
-           c = DynArray_get(n->fileChildren, i);
-           count += Node_destroy(c, c->type);
+       Children_free(&n->u.dir.dirChildren);
+       for (i = 0; i < Children_getLength(&n->u.dir.fileChildren);
+            i++) {
+           c = Children_get(&n->u.dir.fileChildren, i);
+           count += Node_free(c, c->type, withContents);
        }
-       DynArray_free(n->fileChildren);
+       Children_free(&n->u.dir.fileChildren);
    }
-   free(n->path);
-   free(n);
+   else if (n->u.file.oRope != NULL && withContents) {
+       Node_accountContents(n, FALSE);
+       Rope_free(n->u.file.oRope);
+   }
+   memStats.nodes--;
+   memStats.nodeBytes -= Node_bytes(type);
+   memStats.pathBytes -= strlen(n->path) + 1;
+   Node_freePath(n->path);
+   Allocator_free(allocator, n, Node_bytes(type));
    count++;
 
    return count;
 }
 
 /* see node.h for specification */
-const char* Node_getPath(Node_T n) {
+size_t Node_destroy(Node_T n, nodeType type) {
    assert(n != NULL);
 
-   return n->path;
+   return Node_free(n, type, TRUE);
 }
 
-/*
-   Compares node1 and node2 based on their paths.
-   Returns <0, 0, or >0 if node1 is less than or
-equal to, or greater than node2, respectively.
-*/
- static int Node_compare(Node_T node1, Node_T node2) {
-   assert(node1 != NULL);
-   assert(node2 != NULL);
+/* see node.h for specification */
+const char* Node_getPath(Node_T n) {
+   assert(n != NULL);
 
-   return strcmp(node1->path, node2->path);
+   return n->path;
 }
 
 /* see node.h for specification */
 size_t Node_getNumDirChildren(Node_T n) {
    assert(n != NULL);
    if(n->type == ISFILE) return 0;
-   else return DynArray_getLength(n->dirChildren);
+   else return Children_getLength(&n->u.dir.dirChildren);
 }
 
 size_t Node_getNumFileChildren(Node_T n) {
     assert(n != NULL);
     if(n->type == ISFILE) return 0;
-    else return DynArray_getLength(n->fileChildren);
-}
-
-/* see node.h for specification */
-static int Node_hasChildFile(Node_T n, const char* path, size_t* childID) {
-   size_t index;
-   int result;
-   Node_T checker;
-
-   assert(n != NULL);
-   assert(path != NULL);
-
-   if (n->type == ISFILE) return 0;
-
-   checker = Node_create(path, NULL, NULL, 0, ISDIRECTORY);
-   /* checker = Node_create(path, NULL); */
-
-   if(checker == NULL) {
-      return -1;
-   }
-   index = 0;
-   result = DynArray_bsearch(n->fileChildren, checker, &index,
-                                 (int (*)(const void*, const void*)) Node_compare);
-
-   (void) Node_destroy(checker, checker->type);
-
-   if(childID != NULL)
-      *childID = index;
-
-   return result;
-}
-
-/* see node.h for specification */
-static int Node_hasChildDirectory(Node_T n, const char* path, size_t* childID) {
-    size_t index;
-    int result;
-    Node_T checker;
-
-    assert(n != NULL);
-    assert(path != NULL);
-
-    if (n->type == ISFILE) return 0;
-
-    checker = Node_create(path, NULL, NULL, 0, ISDIRECTORY);
-    /* checker = Node_create(path, NULL); */
-
-    if(checker == NULL) {
-        return -1;
-    }
-    index=0;
-    result = DynArray_bsearch(n->dirChildren, checker, &index,
-                              (int (*)(const void*, const void*)) Node_compare);
-
-    (void) Node_destroy(checker, checker->type);
-
-    if(childID != NULL)
-        *childID = index;
-
-    return result;
+    else return Children_getLength(&n->u.dir.fileChildren);
 }
 
 /* see node.h for specification */
@@ -242,8 +693,8 @@ Node_T Node_getChildDirectory(Node_T n, size_t childID) {
    assert(n != NULL);
    if (n->type == ISFILE) return NULL;
 
-   if(DynArray_getLength(n->dirChildren) > childID) {
-      return DynArray_get(n->dirChildren, childID);
+   if(Children_getLength(&n->u.dir.dirChildren) > childID) {
+      return Children_get(&n->u.dir.dirChildren, childID);
    }
    else {
       return NULL;
@@ -255,14 +706,33 @@ Node_T Node_getChildFile(Node_T n, size_t childID) {
     assert(n != NULL);
     if (n->type == ISFILE) return NULL;
 
-    else if(DynArray_getLength(n->fileChildren) > childID) {
-        return DynArray_get(n->fileChildren, childID);
+    else if(Children_getLength(&n->u.dir.fileChildren) > childID) {
+        return Children_get(&n->u.dir.fileChildren, childID);
     }
     else {
         return NULL;
     }
 }
 
+/* see node.h for specification */
+Node_T Node_findChild(Node_T n, const char* name, size_t length) {
+   struct NodeName key;
+   size_t i;
+
+   assert(n != NULL);
+   assert(name != NULL);
+
+   if(n->type == ISFILE) return NULL;
+
+   Node_setName(&key, name, length);
+   key.prefixLen = strlen(n->path);
+   if(Children_bsearch(&n->u.dir.dirChildren, &key, &i))
+      return Children_get(&n->u.dir.dirChildren, i);
+   if(Children_bsearch(&n->u.dir.fileChildren, &key, &i))
+      return Children_get(&n->u.dir.fileChildren, i);
+   return NULL;
+}
+
 /* see node.h for specification */
 Node_T Node_getParent(Node_T n) {
    assert(n != NULL);
@@ -271,6 +741,7 @@ Node_T Node_getParent(Node_T n) {
 
 /* see node.h for specification */
 int Node_linkChild(Node_T parent, Node_T child) {
+   struct NodeName key;
    size_t i;
    char* rest;
 
@@ -281,57 +752,128 @@ int Node_linkChild(Node_T parent, Node_T child) {
        return PARENT_CHILD_ERROR;
    }
 
-   if(Node_hasChildDirectory(parent, child->path, NULL)) {
-      return ALREADY_IN_TREE;
-   }
-   if(Node_hasChildFile(parent, child->path, NULL)) {
-       return ALREADY_IN_TREE;
-   }
-   i = strlen(parent->path);
-   if(strncmp(child->path, parent->path, i)) {
+   key.prefixLen = strlen(parent->path);
+   if(strncmp(child->path, parent->path, key.prefixLen)) {
       return PARENT_CHILD_ERROR;
    }
-   rest = child->path + i;
-   if(strlen(child->path) >= i && rest[0] != '/') {
+   rest = child->path + key.prefixLen;
+   if(rest[0] != '/') {
       return PARENT_CHILD_ERROR;
    }
    rest++;
    if(strstr(rest, "/") != NULL) {
       return PARENT_CHILD_ERROR;
    }
+   Node_setName(&key, rest, strlen(rest));
+
+   /* a name may be taken by a directory or a file, but not both */
+   if(child->type == ISDIRECTORY) {
+      if(Children_bsearch(&parent->u.dir.fileChildren, &key, &i))
+         return ALREADY_IN_TREE;
+      if(Children_bsearch(&parent->u.dir.dirChildren, &key, &i))
+         return ALREADY_IN_TREE;
+      if(!Children_addAt(&parent->u.dir.dirChildren, i, child, &key))
+         return PARENT_CHILD_ERROR;
+   }
+   else {
+      if(Children_bsearch(&parent->u.dir.dirChildren, &key, &i))
+         return ALREADY_IN_TREE;
+      if(Children_bsearch(&parent->u.dir.fileChildren, &key, &i))
+         return ALREADY_IN_TREE;
+      if(!Children_addAt(&parent->u.dir.fileChildren, i, child, &key))
+         return PARENT_CHILD_ERROR;
+   }
    child->parent = parent;
-   if(child->type == ISDIRECTORY){
-       if (DynArray_bsearch(parent->dirChildren, child, &i,
-                            (int (*)(const void *, const void *)) Node_compare) == 1) {
-          return ALREADY_IN_TREE;
-       }
+
+   return SUCCESS;
+}
+
+/* see node.h for specification */
+int Node_linkChildren(Node_T parent, Node_T *children, size_t count) {
+   struct NodeName key;
+   Node_T* sorted;
+   size_t numDirs = 0;
+   size_t i;
+   size_t j;
+   const char* rest;
+
+   assert(parent != NULL);
+   assert(children != NULL || count == 0);
+
+   if(parent->type == ISFILE) return PARENT_CHILD_ERROR;
+   if(count == 0) return SUCCESS;
+
+   key.prefixLen = strlen(parent->path);
+   for(i = 0; i < count; i++) {
+      if(strncmp(children[i]->path, parent->path, key.prefixLen))
+         return PARENT_CHILD_ERROR;
+      rest = children[i]->path + key.prefixLen;
+      if(rest[0] != '/' || rest[1] == '\0' || strchr(rest + 1, '/'))
+         return PARENT_CHILD_ERROR;
+      if(children[i]->type == ISDIRECTORY) numDirs++;
    }
-   else if(child->type==ISFILE) {
-       if (DynArray_bsearch(parent->fileChildren, child, &i,
-                            (int (*)(const void *, const void *)) Node_compare) == 1) {
-           return ALREADY_IN_TREE;
-       }
+
+   /* sort a copy, directories first, so that each type is a sorted
+      run that can be merged into place */
+   sorted = malloc(count * sizeof(Node_T));
+   if(sorted == NULL) return MEMORY_ERROR;
+   for(i = 0, j = 0; i < count; i++) {
+      if(children[i]->type == ISDIRECTORY) sorted[j++] = children[i];
+      else sorted[numDirs + i - j] = children[i];
    }
-   /*check this*/
-   if(parent->type == ISDIRECTORY){
-       if(child->type == ISFILE){
-           if(DynArray_addAt(parent->fileChildren, i, child) == TRUE) {
-              return SUCCESS;
-           }
-       }
-       else{
-           if(DynArray_addAt(parent->dirChildren, i, child) == TRUE) {
-               return SUCCESS;
-           }
-       }
+   NodeArray_sortElements(sorted, numDirs);
+   NodeArray_sortElements(sorted + numDirs, count - numDirs);
+
+   /* names must be new, both to parent and within the batch */
+   for(i = 0; i < count; i++) {
+      rest = sorted[i]->path + key.prefixLen + 1;
+      Node_setName(&key, rest, strlen(rest));
+      if(Children_bsearch(&parent->u.dir.dirChildren, &key, &j)
+         || Children_bsearch(&parent->u.dir.fileChildren, &key, &j)
+         || (i > 0 && i != numDirs
+             && Node_compare(sorted[i - 1], sorted[i]) == 0)) {
+         free(sorted);
+         return ALREADY_IN_TREE;
+      }
+   }
+   if(numDirs > 0 && numDirs < count) {
+      /* a name may not be both a directory and a file */
+      for(i = 0, j = numDirs; i < numDirs && j < count; ) {
+         int result = Node_compare(sorted[i], sorted[j]);
+         if(result == 0) {
+            free(sorted);
+            return ALREADY_IN_TREE;
+         }
+         if(result < 0) i++;
+         else j++;
+      }
    }
 
-   return PARENT_CHILD_ERROR;
+   /* if the files cannot be merged, take the directories back out */
+   if(!Children_addAllSorted(&parent->u.dir.dirChildren, sorted,
+                             numDirs, key.prefixLen)) {
+      free(sorted);
+      return MEMORY_ERROR;
+   }
+   if(!Children_addAllSorted(&parent->u.dir.fileChildren,
+                             sorted + numDirs, count - numDirs,
+                             key.prefixLen)) {
+      Children_removeAll(&parent->u.dir.dirChildren, sorted, numDirs,
+                         key.prefixLen);
+      free(sorted);
+      return MEMORY_ERROR;
+   }
 
+   for(i = 0; i < count; i++)
+      children[i]->parent = parent;
+   free(sorted);
+   return SUCCESS;
 }
 
 /* see node.h for specification */
 int  Node_unlinkChild(Node_T parent, Node_T child) {
+   struct NodeName key;
+   struct Children* children;
    size_t i = 0;
 
    assert(parent != NULL);
@@ -339,21 +881,19 @@ int  Node_unlinkChild(Node_T parent, Node_T child) {
 
    if(parent->type == ISFILE) return PARENT_CHILD_ERROR;
 
-   if (child->type == ISDIRECTORY) {
-       if (DynArray_bsearch(parent->dirChildren, child, &i,
-                            (int (*)(const void *, const void *)) Node_compare) == 0) {
-           return PARENT_CHILD_ERROR;
-       }
-   }
+   key.prefixLen = strlen(parent->path);
+   if(strlen(child->path) <= key.prefixLen) return PARENT_CHILD_ERROR;
+   Node_setName(&key, child->path + key.prefixLen + 1,
+                strlen(child->path + key.prefixLen + 1));
 
-   else {
-       if (DynArray_bsearch(parent->fileChildren, child, &i,
-                            (int (*)(const void *, const void *)) Node_compare) == 0) {
-           return PARENT_CHILD_ERROR;
-       }
-   }
-   if(child->type == ISFILE) (void) DynArray_removeAt(parent->fileChildren, i);
-   else if(child->type == ISDIRECTORY) (void) DynArray_removeAt(parent->dirChildren, i);
+   if (child->type == ISDIRECTORY)
+      children = &parent->u.dir.dirChildren;
+   else children = &parent->u.dir.fileChildren;
+
+   if(!Children_bsearch(children, &key, &i)
+      || Children_get(children, i) != child)
+      return PARENT_CHILD_ERROR;
+   (void) Children_removeAt(children, i, key.prefixLen);
 
    return SUCCESS;
 }
@@ -369,9 +909,11 @@ int Node_addChild(Node_T parent, const char* newNode, void* contents,
    assert(newNode != NULL);
 
    if (type == ISFILE)
-       new = Node_create(newNode, parent, contents, length, type);
+       new = Node_create(newNode, strlen(newNode), parent, contents,
+                         length, type);
    else
-       new = Node_create(newNode, parent, NULL, 0,  type);
+       new = Node_create(newNode, strlen(newNode), parent, NULL, 0,
+                         type);
 
    if(new == NULL) {
       return PARENT_CHILD_ERROR;
@@ -403,15 +945,31 @@ char* Node_toString(Node_T n) {
 }
 
 void* getFileContents(Node_T n) {
+    const void* contents;
     assert(n != NULL);
     assert(isFile(n));
-    return (n->pvContents);
+    if(n->u.file.oRope != NULL) {
+        /* the first flattening may cache a contiguous copy */
+        Node_accountContents(n, FALSE);
+        contents = Rope_flatten(n->u.file.oRope);
+        Node_accountContents(n, TRUE);
+        return (void*) contents;
+    }
+    return (n->u.file.pvContents);
 }
 
 size_t getFileLength(Node_T n) {
     assert(n != NULL);
     assert(isFile(n));
-    return (n->uLength);
+    if(n->u.file.oRope != NULL) return Rope_getLength(n->u.file.oRope);
+    return (n->u.file.uLength);
+}
+
+boolean ownsFileContents(Node_T n) {
+    assert(n != NULL);
+    assert(isFile(n));
+    if(n->u.file.oRope != NULL) return TRUE;
+    else return FALSE;
 }
 
 /* see node.h for specification */
@@ -425,13 +983,303 @@ boolean isFile(Node_T n){
 void* replaceFileContents(Node_T n, void *newContents, size_t newLength) {
     void* oldContents;
     assert(n != NULL);
-    oldContents = n->pvContents;
-    n->pvContents = newContents;
-    n->uLength = newLength;
+    assert(isFile(n));
+    if(n->u.file.oRope != NULL) {
+        oldContents = Rope_toBuffer(n->u.file.oRope);
+        if(oldContents == NULL && Rope_getLength(n->u.file.oRope) != 0)
+            return NULL;
+        Node_accountContents(n, FALSE);
+        Rope_free(n->u.file.oRope);
+        n->u.file.oRope = NULL;
+    }
+    else oldContents = n->u.file.pvContents;
+    n->u.file.pvContents = newContents;
+    n->u.file.uLength = newLength;
     return oldContents;
 }
 
+/* see node.h for specification */
+int setOwnedFileContents(Node_T n, const void *contents, size_t length) {
+    Rope_T rope;
+
+    assert(n != NULL);
+    assert(isFile(n));
+
+    rope = Rope_new(contents, length);
+    if(rope == NULL) return MEMORY_ERROR;
+
+    if(n->u.file.oRope != NULL) {
+        Node_accountContents(n, FALSE);
+        Rope_free(n->u.file.oRope);
+    }
+    n->u.file.oRope = rope;
+    n->u.file.pvContents = NULL;
+    n->u.file.uLength = 0;
+    Node_accountContents(n, TRUE);
+    return SUCCESS;
+}
+
+/* see node.h for specification */
+size_t readFileRange(Node_T n, size_t offset, size_t length, void *buf) {
+    assert(n != NULL);
+    assert(isFile(n));
+    assert(buf != NULL || length == 0);
+
+    if(n->u.file.oRope != NULL)
+        return Rope_read(n->u.file.oRope, offset, length, buf);
+
+    if(offset >= n->u.file.uLength) return 0;
+    if(length > n->u.file.uLength - offset)
+        length = n->u.file.uLength - offset;
+    memcpy(buf, (char*) n->u.file.pvContents + offset, length);
+    return length;
+}
+
+/* see node.h for specification */
+int writeFileRange(Node_T n, size_t offset, const void *data,
+                   size_t length) {
+    int written;
+    assert(n != NULL);
+    assert(isFile(n));
+    assert(data != NULL || length == 0);
+
+    if(n->u.file.oRope == NULL &&
+       setOwnedFileContents(n, n->u.file.pvContents,
+                            n->u.file.uLength) != SUCCESS)
+        return MEMORY_ERROR;
+    Node_accountContents(n, FALSE);
+    written = Rope_write(n->u.file.oRope, offset, data, length);
+    Node_accountContents(n, TRUE);
+    if(!written) return MEMORY_ERROR;
+    return SUCCESS;
+}
+
 nodeType getType(Node_T n) {
     assert(n != NULL);
     return n->type;
 }
+
+/*
+   Returns TRUE if c is held in exactly one of an array, with one key
+   per child, or a tree, and FALSE otherwise.
+*/
+static boolean Children_isConsistent(const struct Children* c) {
+   if(c->tree != NULL)
+      return c->array == NULL && c->keys == NULL;
+   return c->array != NULL && c->keys != NULL
+          && KeyArray_getLength(c->keys)
+             == NodeArray_getLength(c->array);
+}
+
+/* see node.h for specification */
+boolean Node_isConsistent(Node_T n) {
+   assert(n != NULL);
+
+   if(n->type == ISFILE)
+      return n->u.file.oRope == NULL
+             || (n->u.file.pvContents == NULL
+                 && n->u.file.uLength == 0);
+   if(n->type != ISDIRECTORY)
+      return FALSE;
+   return Children_isConsistent(&n->u.dir.dirChildren)
+          && Children_isConsistent(&n->u.dir.fileChildren);
+}
+
+/* see node.h for specification */
+size_t Node_getHandle(Node_T n) {
+    assert(n != NULL);
+    return n->handle;
+}
+
+/* see node.h for specification */
+void Node_setHandle(Node_T n, size_t handle) {
+    assert(n != NULL);
+    assert(handle <= UINT32_MAX);
+    n->handle = (uint32_t) handle;
+}
+
+/* see node.h for specification */
+void Node_getMemStats(struct NodeMemStats* stats) {
+   assert(stats != NULL);
+   *stats = memStats;
+}
+
+/* see node.h for specification */
+void Node_setAllocator(const struct Allocator* a) {
+   assert(memStats.nodes == 0);
+   allocator = a != NULL ? a : &Allocator_heap;
+}
+
+/*
+   Returns a copy of n, from allocator, with parent parent, the same
+   path, contents and handle, and no storage for children, or NULL
+   if there is an allocation error. The copy shares n's contents.
+*/
+static Node_T Node_copyOne(Node_T n, Node_T parent) {
+   Node_T copy;
+   size_t pathLength = strlen(n->path) + 1;
+
+   copy = Allocator_alloc(allocator, Node_bytes(n->type));
+   if(copy == NULL) return NULL;
+   copy->path = Allocator_alloc(allocator, pathLength);
+   if(copy->path == NULL) {
+      Allocator_free(allocator, copy, Node_bytes(n->type));
+      return NULL;
+   }
+   memcpy(copy->path, n->path, pathLength);
+   copy->parent = parent;
+   if(n->type == ISFILE) copy->u.file = n->u.file;
+   else {
+      copy->u.dir.dirChildren.array = NULL;
+      copy->u.dir.dirChildren.keys = NULL;
+      copy->u.dir.dirChildren.tree = NULL;
+      copy->u.dir.fileChildren = copy->u.dir.dirChildren;
+   }
+   copy->type = n->type;
+   copy->handle = n->handle;
+
+   memStats.nodes++;
+   memStats.nodeBytes += Node_bytes(n->type);
+   memStats.pathBytes += pathLength;
+   return copy;
+}
+
+/*
+   Makes to, empty, into an array for as many children as from holds,
+   with from's keys, if from is an array; a tree is left to
+   Children_copyNodes, which builds it whole. Returns TRUE, or FALSE
+   if there is an allocation error, in which case to is left empty.
+*/
+static boolean Children_copyStorage(struct Children* to,
+                                    const struct Children* from) {
+   size_t length = Children_getLength(from);
+   size_t i;
+
+   if(from->tree != NULL) return TRUE;
+
+   to->array = NodeArray_new(length);
+   to->keys = KeyArray_new(length);
+   if(to->array == NULL || to->keys == NULL) {
+      if(to->array != NULL) NodeArray_free(to->array);
+      if(to->keys != NULL) KeyArray_free(to->keys);
+      to->array = NULL;
+      to->keys = NULL;
+      return FALSE;
+   }
+   for(i = 0; i < length; i++)
+      (void) KeyArray_set(to->keys, i, KeyArray_get(from->keys, i));
+   Children_account(to, TRUE);
+   return TRUE;
+}
+
+/*
+   Fills to, made by Children_copyStorage from from, with a copy of
+   each child in from, with parent parent, in order. Returns TRUE, or
+   FALSE if there is an allocation error, in which case to holds the
+   copies made so far, or none if from is a tree.
+*/
+static boolean Children_copyNodes(struct Children* to,
+                                  const struct Children* from,
+                                  Node_T parent) {
+   size_t length = Children_getLength(from);
+   size_t i;
+   Node_T copy;
+   Node_T* copies;
+
+   if(from->tree == NULL) {
+      for(i = 0; i < length; i++) {
+         copy = Node_copyOne(Children_get(from, i), parent);
+         if(copy != NULL) {
+            (void) NodeArray_set(to->array, i, copy);
+            continue;
+         }
+
+         /* the slots of the children not copied are dropped */
+         Children_account(to, FALSE);
+         while(NodeArray_getLength(to->array) > i) {
+            (void) NodeArray_removeAt(to->array, i);
+            (void) KeyArray_removeAt(to->keys, i);
+         }
+         Children_account(to, TRUE);
+         return FALSE;
+      }
+      return TRUE;
+   }
+
+   /* the copies are gathered first so that the tree is built full */
+   copies = malloc(length * sizeof(Node_T) + 1);
+   if(copies == NULL) return FALSE;
+   for(i = 0; i < length; i++) {
+      copies[i] = Node_copyOne(Children_get(from, i), parent);
+      if(copies[i] == NULL) break;
+   }
+   if(i == length)
+      to->tree = BTree_newFrom((void* const*) copies, length);
+   if(to->tree == NULL) {
+      while(i > 0) {
+         i--;
+         (void) Node_free(copies[i], copies[i]->type, FALSE);
+      }
+      free(copies);
+      return FALSE;
+   }
+   free(copies);
+   Children_account(to, TRUE);
+   return TRUE;
+}
+
+/*
+   Gives copy, a copy of the directory n made by Node_copyOne, a copy
+   of n's children and everything beneath them, from allocator. The
+   storage for copy's children comes first, then its children, and
+   then what is beneath each child directory in turn, so that a
+   search of a directory touches memory close together. Returns TRUE,
+   or FALSE if there is an allocation error, in which case copy holds
+   the part copied so far.
+*/
+static boolean Node_copyChildren(Node_T copy, Node_T n) {
+   size_t i;
+
+   struct NodeDir* to = &copy->u.dir;
+   struct NodeDir* from = &n->u.dir;
+
+   if(!Children_copyStorage(&to->dirChildren, &from->dirChildren)
+      || !Children_copyStorage(&to->fileChildren, &from->fileChildren)
+      || !Children_copyNodes(&to->dirChildren, &from->dirChildren, copy)
+      || !Children_copyNodes(&to->fileChildren, &from->fileChildren,
+                             copy))
+      return FALSE;
+
+   for(i = 0; i < Children_getLength(&from->dirChildren); i++)
+      if(!Node_copyChildren(Children_get(&to->dirChildren, i),
+                            Children_get(&from->dirChildren, i)))
+         return FALSE;
+   return TRUE;
+}
+
+/* see node.h for specification */
+Node_T Node_compact(Node_T root, const struct Allocator* a) {
+   const struct Allocator* old = allocator;
+   Node_T copy;
+
+   assert(root != NULL);
+   assert(root->parent == NULL);
+
+   allocator = a != NULL ? a : &Allocator_heap;
+   copy = Node_copyOne(root, NULL);
+   if(copy == NULL) {
+      allocator = old;
+      return NULL;
+   }
+   if(root->type == ISDIRECTORY && !Node_copyChildren(copy, root)) {
+      (void) Node_free(copy, copy->type, FALSE);
+      allocator = old;
+      return NULL;
+   }
+
+   /* the contents now belong to the copy */
+   allocator = old;
+   (void) Node_free(root, root->type, FALSE);
+   allocator = a != NULL ? a : &Allocator_heap;
+   return copy;
+}
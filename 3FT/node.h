@@ -8,6 +8,7 @@
 
 #include <stddef.h>
 #include "a4def.h"
+#include "allocator.h"
 
 /*
    a Node_T is an object that contains a path payload and references to
@@ -21,13 +22,14 @@ typedef enum {ISDIRECTORY, ISFILE} nodeType;
 
 
 /*
-   Given a parent node, a string newNode, contents, a length, and type,
-   returns a new Node_T or NULL if any allocation error occurs in
-   creating the node or its fields.
+   Given a parent node, the newNodeLength characters at newNode, which
+   need not be terminated, contents, a length, and type, returns a new
+   Node_T or NULL if any allocation error occurs in creating the node
+   or its fields.
 
    The new structure is initialized to have its path as the parent's
-   path (if it exists) prefixed to the directory/file string parameter,
-   separated by a slash. It is also initialized with its parent link
+   path (if it exists) prefixed to those characters, separated by a
+   slash. It is also initialized with its parent link
    as the parent parameter value, but the parent itself is not changed
    to link to the new node.  The children links are initialized but
    do not point to any children. It is also initialized with its
@@ -35,8 +37,9 @@ typedef enum {ISDIRECTORY, ISFILE} nodeType;
    and length with the length parameter. It is initialized with its type
    as the type parameter.
 */
-Node_T Node_create(const char* newNode, Node_T parent, void* contents,
-                   size_t length, nodeType type);
+Node_T Node_create(const char* newNode, size_t newNodeLength,
+                   Node_T parent, void* contents, size_t length,
+                   nodeType type);
 
 /*
   If the type is a file, destroys the file node n. If type is a directory,
@@ -75,6 +78,13 @@ Node_T Node_getChildDirectory(Node_T n, size_t childID);
 */
 Node_T Node_getChildFile(Node_T n, size_t childID);
 
+/*
+   Returns the child directory or file of n whose final path component
+   is the length characters at name, if one exists, otherwise returns
+   NULL. Does not allocate memory.
+*/
+Node_T Node_findChild(Node_T n, const char* name, size_t length);
+
 /*
    Returns the parent node of n, if it exists, otherwise returns NULL
 */
@@ -94,6 +104,21 @@ Node_T Node_getParent(Node_T n);
  */
 int Node_linkChild(Node_T parent, Node_T child);
 
+/*
+  Makes each of the count nodes in children a child of parent, as
+  Node_linkChild does, but all at once: the batch is sorted and then
+  merged into parent's children in a single pass per type, rather than
+  inserted one at a time. Either every node is linked and SUCCESS is
+  returned, or none is, in the following cases:
+  * parent is a file, or a node's path is not parent's path + / +
+    a nonempty name, in which case returns PARENT_CHILD_ERROR
+  * parent already has a child with a node's path, or two nodes have
+    the same path, in which case returns ALREADY_IN_TREE
+  * unable to allocate memory, in which case returns MEMORY_ERROR
+  The order of children is unchanged.
+ */
+int Node_linkChildren(Node_T parent, Node_T *children, size_t count);
+
 /*
   Unlinks node parent from its child node child. child is unchanged.
 
@@ -126,7 +151,9 @@ int Node_addChild(Node_T parent, const char* newNode, void* contents,
 char* Node_toString(Node_T n);
 
 /*
- Returns the contents of the node n, if n is a file.
+ Returns the contents of the node n, if n is a file. If the contents
+ are owned by the tree, the returned block belongs to n and remains
+ valid until n's contents are next changed.
  */
 void* getFileContents(Node_T n);
 
@@ -135,6 +162,13 @@ void* getFileContents(Node_T n);
  */
 size_t getFileLength(Node_T n);
 
+/*
+ Returns TRUE if the contents of the file node n are owned by the
+ tree, as after setOwnedFileContents or writeFileRange, and FALSE if
+ they are the pointer the client passed in.
+ */
+boolean ownsFileContents(Node_T n);
+
 /* Given a node n, returns TRUE if n is a file node. Returns FALSE
  * if n is a directory node/
 */
@@ -143,10 +177,111 @@ boolean isFile(Node_T n);
 /*
   Replaces current contents of the node n with the newContents. Replaces
   the length of the node n with the newLength. Returns the old contents i
-  f successful. (Note: contents may be NULL.)
+  f successful. (Note: contents may be NULL.) If the old contents were
+  owned by the tree, returns a newly allocated copy of them, which is
+  then owned by the client, or NULL without changing n if that copy
+  cannot be allocated.
 */
 void* replaceFileContents(Node_T n, void *newContents, size_t newLength);
 
+/*
+  Replaces the contents of the file node n with a copy of the length
+  bytes at contents, owned by the tree, and discards any contents the
+  tree already owned for n. Returns SUCCESS, or MEMORY_ERROR if the
+  copy cannot be allocated, in which case n is unchanged.
+*/
+int setOwnedFileContents(Node_T n, const void *contents, size_t length);
+
+/*
+  Copies at most length bytes of the contents of the file node n,
+  starting at offset, into buf. Returns the number of bytes copied,
+  which is less than length if the range extends past the end of the
+  contents.
+*/
+size_t readFileRange(Node_T n, size_t offset, size_t length, void *buf);
+
+/*
+  Overwrites length bytes of the contents of the file node n, starting
+  at offset, with data, extending the contents (and zero-filling any
+  gap before offset) if the range reaches past their end. Copies
+  n's contents into the tree first if the tree does not own them yet.
+  Returns SUCCESS, or MEMORY_ERROR if memory cannot be allocated, in
+  which case the contents are unchanged.
+*/
+int writeFileRange(Node_T n, size_t offset, const void *data,
+                   size_t length);
+
 /* Returns the type of the node n. */
 nodeType getType(Node_T n);
+
+/*
+  Returns TRUE if the fields of n are consistent with each other and
+  with its type, or FALSE otherwise. A file's contents owned by the
+  tree must be held only by its rope; each of a directory's sets of
+  children must be held in exactly one of an array, with one cached
+  key per child, or a tree. Does not look at n's children, so takes
+  constant time.
+*/
+boolean Node_isConsistent(Node_T n);
+
+/*
+  Returns the handle slot number recorded in n by Node_setHandle,
+  or 0 if none has been recorded.
+*/
+size_t Node_getHandle(Node_T n);
+
+/*
+  Records handle as the number of the tree's handle slot that names n.
+  The node layer only stores the number, which must fit in 32 bits;
+  the tree assigns and interprets it.
+*/
+void Node_setHandle(Node_T n, size_t handle);
+
+/*
+  Memory held by all nodes that exist, in bytes. It is kept up to date
+  as nodes are created, changed and destroyed, so reading it takes
+  constant time.
+*/
+struct NodeMemStats {
+   /* the number of nodes */
+   size_t nodes;
+   /* the node structures themselves */
+   size_t nodeBytes;
+   /* the paths of the nodes, with their terminating null characters */
+   size_t pathBytes;
+   /* the storage for the children of directories: the arrays, at
+      their capacity, with their cached keys, or the trees, with the
+      structures that hold them */
+   size_t childBytes;
+   /* the part of childBytes that holds a child or its key */
+   size_t childUsedBytes;
+   /* the contents of files that are owned by the tree */
+   size_t contentBytes;
+};
+
+/* Fills *stats with the memory held by all nodes that exist. */
+void Node_getMemStats(struct NodeMemStats* stats);
+
+/*
+  Makes a the source of the memory of nodes created from now on:
+  the nodes, their paths and their arrays of children. If a is NULL,
+  that memory comes from malloc, as it does to start with. May be
+  called only while no nodes exist, and a must remain valid until
+  the nodes created with it are destroyed.
+*/
+void Node_setAllocator(const struct Allocator* a);
+
+/*
+  Moves root, which must have no parent, and every node beneath it to
+  memory from a, or from malloc if a is NULL, and makes a the source
+  of memory for nodes from then on, as Node_setAllocator does. The
+  nodes are laid out depth first, each directory's storage for its
+  children followed by those children, so that a traversal touches
+  memory close together. Paths, contents and handle numbers carry
+  over; storage for children keeps no spare capacity.
+  Returns the new root, after which no Node_T of the old tree is
+  valid, or NULL if there is an allocation error, in which case the
+  tree is unchanged.
+*/
+Node_T Node_compact(Node_T root, const struct Allocator* a);
 #endif
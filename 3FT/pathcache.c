@@ -0,0 +1,301 @@
+/*--------------------------------------------------------------------*/
+/* pathcache.c                                                        */
+/* Author: Alina Chen and Nickolas Casalinuovo                        */
+/*--------------------------------------------------------------------*/
+
+#include "pathcache.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*--------------------------------------------------------------------*/
+
+/* The number of entries in each set.  A path may be held only in the
+   set its hash selects. */
+
+enum { WAYS = 4 };
+
+/*--------------------------------------------------------------------*/
+
+/* An entry of a PathCache.  The path is kept in the entry itself, so
+   that filling an entry never allocates and a lookup reads one
+   contiguous block; PATHCACHE_MAX_LENGTH makes an entry 128 bytes on
+   a 64-bit machine, two cache lines. */
+
+struct PathCacheEntry
+{
+   /* The hash of acKey. */
+   size_t uHash;
+
+   /* The value of the path, or NULL for a negative entry. */
+   const void *pvValue;
+
+   /* The tick at which the entry was last used. */
+   size_t uTick;
+
+   /* A copy of the path, or the empty string if the entry is
+      empty. */
+   char acKey[PATHCACHE_MAX_LENGTH + 1];
+};
+
+/* A PathCache consists of an array of sets of entries, along with
+   a clock for recency and its counters. */
+
+struct PathCache
+{
+   /* The number of sets, a power of 2. */
+   size_t uSets;
+
+   /* The uSets * WAYS entries, set by set. */
+   struct PathCacheEntry *psEntries;
+
+   /* The tick of the most recent use of any entry. */
+   size_t uTick;
+
+   /* The counters reported by PathCache_getStats. */
+   struct PathCacheStats sStats;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Return the FNV-1a hash of string pcPath, and assign its length to
+   *puLength. */
+
+static size_t PathCache_hash(const char *pcPath, size_t *puLength)
+{
+   size_t uHash = (size_t)2166136261U;
+   const char *pc;
+
+   assert(pcPath != NULL);
+   assert(puLength != NULL);
+
+   for (pc = pcPath; *pc != '\0'; pc++)
+   {
+      uHash ^= (unsigned char)*pc;
+      uHash *= (size_t)16777619U;
+   }
+   *puLength = (size_t)(pc - pcPath);
+   return uHash;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return 1 (TRUE) if a path of uLength characters can be held in an
+   entry, or 0 (FALSE) if not. */
+
+static int PathCache_fits(size_t uLength)
+{
+   return uLength != 0 && uLength <= PATHCACHE_MAX_LENGTH;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the entry of oPathCache that holds pcPath, whose hash is
+   uHash and whose length is uLength, or NULL if there is none. */
+
+static struct PathCacheEntry *PathCache_find(PathCache_T oPathCache,
+                                             const char *pcPath,
+                                             size_t uHash,
+                                             size_t uLength)
+{
+   struct PathCacheEntry *psSet;
+   size_t u;
+
+   assert(oPathCache != NULL);
+   assert(pcPath != NULL);
+
+   if (!PathCache_fits(uLength))
+      return NULL;
+
+   psSet = &oPathCache->psEntries[(uHash & (oPathCache->uSets - 1))
+                                  * WAYS];
+   /* An empty entry's key differs from pcPath in its first byte. */
+   for (u = 0; u < WAYS; u++)
+      if (psSet[u].uHash == uHash
+          && memcmp(psSet[u].acKey, pcPath, uLength + 1) == 0)
+         return &psSet[u];
+   return NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Make psEntry of oPathCache empty. */
+
+static void PathCache_empty(PathCache_T oPathCache,
+                            struct PathCacheEntry *psEntry)
+{
+   assert(oPathCache != NULL);
+   assert(psEntry != NULL);
+   assert(psEntry->acKey[0] != '\0');
+
+   psEntry->acKey[0] = '\0';
+   psEntry->pvValue = NULL;
+   oPathCache->sStats.uEntries--;
+}
+
+/*--------------------------------------------------------------------*/
+
+PathCache_T PathCache_new(size_t uCapacity)
+{
+   PathCache_T oPathCache;
+   size_t uSets = 1;
+
+   while (uSets * WAYS < uCapacity)
+      uSets *= 2;
+
+   oPathCache = (struct PathCache*)malloc(sizeof(struct PathCache));
+   if (oPathCache == NULL)
+      return NULL;
+
+   oPathCache->psEntries = (struct PathCacheEntry*)
+      calloc(uSets * WAYS, sizeof(struct PathCacheEntry));
+   if (oPathCache->psEntries == NULL)
+   {
+      free(oPathCache);
+      return NULL;
+   }
+
+   oPathCache->uSets = uSets;
+   oPathCache->uTick = 0;
+   memset(&oPathCache->sStats, 0, sizeof(struct PathCacheStats));
+   oPathCache->sStats.uCapacity = uSets * WAYS;
+
+   return oPathCache;
+}
+
+/*--------------------------------------------------------------------*/
+
+void PathCache_free(PathCache_T oPathCache)
+{
+   assert(oPathCache != NULL);
+
+   PathCache_clear(oPathCache);
+   free(oPathCache->psEntries);
+   free(oPathCache);
+}
+
+/*--------------------------------------------------------------------*/
+
+int PathCache_get(PathCache_T oPathCache, const char *pcPath,
+                  void **ppvValue)
+{
+   struct PathCacheEntry *psEntry;
+   size_t uHash;
+   size_t uLength;
+
+   assert(oPathCache != NULL);
+   assert(pcPath != NULL);
+   assert(ppvValue != NULL);
+
+   uHash = PathCache_hash(pcPath, &uLength);
+   psEntry = PathCache_find(oPathCache, pcPath, uHash, uLength);
+   if (psEntry == NULL)
+   {
+      oPathCache->sStats.uMisses++;
+      return 0;
+   }
+
+   psEntry->uTick = ++oPathCache->uTick;
+   if (psEntry->pvValue == NULL)
+      oPathCache->sStats.uNegativeHits++;
+   else
+      oPathCache->sStats.uPositiveHits++;
+
+   *ppvValue = (void*)psEntry->pvValue;
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+void PathCache_put(PathCache_T oPathCache, const char *pcPath,
+                   const void *pvValue)
+{
+   struct PathCacheEntry *psSet;
+   struct PathCacheEntry *psEntry;
+   size_t uHash;
+   size_t uLength;
+   size_t u;
+
+   assert(oPathCache != NULL);
+   assert(pcPath != NULL);
+
+   uHash = PathCache_hash(pcPath, &uLength);
+   if (!PathCache_fits(uLength))
+      return;
+   psEntry = PathCache_find(oPathCache, pcPath, uHash, uLength);
+
+   if (psEntry == NULL)
+   {
+      /* Use an empty entry of the set, or else its least recently
+         used one. */
+      psSet = &oPathCache->psEntries[(uHash & (oPathCache->uSets - 1))
+                                     * WAYS];
+      psEntry = &psSet[0];
+      for (u = 0; u < WAYS; u++)
+      {
+         if (psSet[u].acKey[0] == '\0')
+         {
+            psEntry = &psSet[u];
+            break;
+         }
+         if (psSet[u].uTick < psEntry->uTick)
+            psEntry = &psSet[u];
+      }
+      if (psEntry->acKey[0] != '\0')
+      {
+         PathCache_empty(oPathCache, psEntry);
+         oPathCache->sStats.uEvictions++;
+      }
+
+      memcpy(psEntry->acKey, pcPath, uLength + 1);
+      psEntry->uHash = uHash;
+      oPathCache->sStats.uEntries++;
+   }
+
+   psEntry->pvValue = pvValue;
+   psEntry->uTick = ++oPathCache->uTick;
+}
+
+/*--------------------------------------------------------------------*/
+
+void PathCache_remove(PathCache_T oPathCache, const char *pcPath)
+{
+   struct PathCacheEntry *psEntry;
+   size_t uHash;
+   size_t uLength;
+
+   assert(oPathCache != NULL);
+   assert(pcPath != NULL);
+
+   uHash = PathCache_hash(pcPath, &uLength);
+   psEntry = PathCache_find(oPathCache, pcPath, uHash, uLength);
+   if (psEntry != NULL)
+   {
+      PathCache_empty(oPathCache, psEntry);
+      oPathCache->sStats.uInvalidations++;
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+void PathCache_clear(PathCache_T oPathCache)
+{
+   size_t u;
+
+   assert(oPathCache != NULL);
+
+   for (u = 0; u < oPathCache->uSets * WAYS; u++)
+      if (oPathCache->psEntries[u].acKey[0] != '\0')
+         PathCache_empty(oPathCache, &oPathCache->psEntries[u]);
+}
+
+/*--------------------------------------------------------------------*/
+
+void PathCache_getStats(PathCache_T oPathCache,
+                        struct PathCacheStats *psStats)
+{
+   assert(oPathCache != NULL);
+   assert(psStats != NULL);
+
+   *psStats = oPathCache->sStats;
+}
@@ -0,0 +1,99 @@
+/*--------------------------------------------------------------------*/
+/* pathcache.h                                                        */
+/* Author: Alina Chen and Nickolas Casalinuovo                        */
+/*--------------------------------------------------------------------*/
+
+#ifndef PATHCACHE_INCLUDED
+#define PATHCACHE_INCLUDED
+
+#include <stddef.h>
+
+/* A PathCache_T object is a bounded map from path strings to values.
+   A cached NULL value is a negative entry: it records that the path
+   was looked up and found absent.  When the cache is full, adding an
+   entry evicts the least recently used entry of the same set.  Paths
+   are kept within the entries, so only paths of 1 to
+   PATHCACHE_MAX_LENGTH characters are cached; others always miss. */
+
+typedef struct PathCache *PathCache_T;
+
+/* The length of the longest path a PathCache_T object caches. */
+
+enum { PATHCACHE_MAX_LENGTH = 103 };
+
+/* The counters kept by a PathCache_T object. */
+
+struct PathCacheStats
+{
+   /* The number of lookups answered by a non-NULL entry. */
+   size_t uPositiveHits;
+
+   /* The number of lookups answered by a negative entry. */
+   size_t uNegativeHits;
+
+   /* The number of lookups that found no entry. */
+   size_t uMisses;
+
+   /* The number of entries removed to make room for others. */
+   size_t uEvictions;
+
+   /* The number of entries removed by PathCache_remove. */
+   size_t uInvalidations;
+
+   /* The number of entries currently held. */
+   size_t uEntries;
+
+   /* The maximum number of entries. */
+   size_t uCapacity;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Return a new empty PathCache_T object that holds at most about
+   uCapacity entries, or NULL if insufficient memory is available. */
+
+PathCache_T PathCache_new(size_t uCapacity);
+
+/*--------------------------------------------------------------------*/
+
+/* Free oPathCache. */
+
+void PathCache_free(PathCache_T oPathCache);
+
+/*--------------------------------------------------------------------*/
+
+/* Look up pcPath in oPathCache.  If it has an entry, assign the
+   entry's value (NULL for a negative entry) to *ppvValue and return
+   1 (TRUE).  Otherwise return 0 (FALSE). */
+
+int PathCache_get(PathCache_T oPathCache, const char *pcPath,
+                  void **ppvValue);
+
+/*--------------------------------------------------------------------*/
+
+/* Make pvValue the value of pcPath in oPathCache, copying pcPath,
+   unless pcPath is too long or too short to be cached. */
+
+void PathCache_put(PathCache_T oPathCache, const char *pcPath,
+                   const void *pvValue);
+
+/*--------------------------------------------------------------------*/
+
+/* Remove the entry for pcPath from oPathCache, if there is one. */
+
+void PathCache_remove(PathCache_T oPathCache, const char *pcPath);
+
+/*--------------------------------------------------------------------*/
+
+/* Remove every entry from oPathCache. */
+
+void PathCache_clear(PathCache_T oPathCache);
+
+/*--------------------------------------------------------------------*/
+
+/* Assign the counters of oPathCache to *psStats. */
+
+void PathCache_getStats(PathCache_T oPathCache,
+                        struct PathCacheStats *psStats);
+
+#endif
@@ -0,0 +1,163 @@
+/*--------------------------------------------------------------------*/
+/* pathsplit.c                                                        */
+/* Author: Alina Chen and Nickolas Casalinuovo                        */
+/*--------------------------------------------------------------------*/
+
+#include "pathsplit.h"
+#include <assert.h>
+#include <stdint.h>
+
+#if defined(__GNUC__) && defined(__AVX2__)
+#include <immintrin.h>
+#define PATHSPLIT_BLOCK 32
+#elif defined(__GNUC__) && defined(__SSE2__)
+#include <emmintrin.h>
+#define PATHSPLIT_BLOCK 16
+#endif
+
+/*--------------------------------------------------------------------*/
+
+#ifdef PATHSPLIT_BLOCK
+
+/* Reading whole aligned blocks may read past the end of a path, but
+   never onto another page, since pages are aligned to a multiple of
+   the block size.  AddressSanitizer cannot know this, so it is told
+   not to check the functions that read them. */
+
+#define PATHSPLIT_UNCHECKED __attribute__((no_sanitize_address))
+
+/* Return bit i set iff the i'th of the PATHSPLIT_BLOCK characters at
+   pcBlock, which must be aligned to PATHSPLIT_BLOCK, is '/', and set
+   *puZeros to the same for '\0'. */
+
+#if PATHSPLIT_BLOCK == 32
+
+PATHSPLIT_UNCHECKED
+static inline uint32_t PathSplit_scanBlock(const char *pcBlock,
+                                           uint32_t *puZeros)
+{
+   __m256i vChars = _mm256_load_si256((const __m256i*)pcBlock);
+
+   *puZeros = (uint32_t)_mm256_movemask_epi8(
+      _mm256_cmpeq_epi8(vChars, _mm256_setzero_si256()));
+   return (uint32_t)_mm256_movemask_epi8(
+      _mm256_cmpeq_epi8(vChars, _mm256_set1_epi8('/')));
+}
+
+#else
+
+PATHSPLIT_UNCHECKED
+static inline uint32_t PathSplit_scanBlock(const char *pcBlock,
+                                           uint32_t *puZeros)
+{
+   __m128i vChars = _mm_load_si128((const __m128i*)pcBlock);
+
+   *puZeros = (uint32_t)_mm_movemask_epi8(
+      _mm_cmpeq_epi8(vChars, _mm_setzero_si128()));
+   return (uint32_t)_mm_movemask_epi8(
+      _mm_cmpeq_epi8(vChars, _mm_set1_epi8('/')));
+}
+
+#endif
+
+PATHSPLIT_UNCHECKED
+size_t PathSplit_split(const char *pcPath, struct PathSpan *psSpans,
+                       size_t uMax, const char **ppcRest)
+{
+   const char *pcBlock;
+   uint32_t uSlashes;
+   uint32_t uZeros;
+   size_t uCount = 0;
+   size_t uStart = 0;
+   size_t uAt;
+
+   assert(pcPath != NULL);
+   assert(psSpans != NULL);
+   assert(uMax >= 1);
+   assert(ppcRest != NULL);
+
+   pcBlock = (const char*)((uintptr_t)pcPath
+                           & ~(uintptr_t)(PATHSPLIT_BLOCK - 1));
+   uSlashes = PathSplit_scanBlock(pcBlock, &uZeros);
+   /* Ignore the characters before pcPath. */
+   uSlashes &= ~(uint32_t)0 << (pcPath - pcBlock);
+   uZeros &= ~(uint32_t)0 << (pcPath - pcBlock);
+
+   for (;;)
+   {
+      /* Ignore the characters after the end of pcPath. */
+      if (uZeros != 0)
+         uSlashes &= (uZeros & (0 - uZeros)) - 1;
+
+      while (uSlashes != 0)
+      {
+         uAt = (size_t)(pcBlock - pcPath)
+               + (size_t)__builtin_ctz(uSlashes);
+         if (uCount == uMax)
+         {
+            *ppcRest = pcPath + uStart;
+            return uCount;
+         }
+         psSpans[uCount].uStart = uStart;
+         psSpans[uCount].uLength = uAt - uStart;
+         uCount++;
+         uStart = uAt + 1;
+         uSlashes &= uSlashes - 1;
+      }
+
+      if (uZeros != 0)
+      {
+         uAt = (size_t)(pcBlock - pcPath)
+               + (size_t)__builtin_ctz(uZeros);
+         if (uCount == uMax)
+         {
+            *ppcRest = pcPath + uStart;
+            return uCount;
+         }
+         psSpans[uCount].uStart = uStart;
+         psSpans[uCount].uLength = uAt - uStart;
+         *ppcRest = NULL;
+         return uCount + 1;
+      }
+
+      pcBlock += PATHSPLIT_BLOCK;
+      uSlashes = PathSplit_scanBlock(pcBlock, &uZeros);
+   }
+}
+
+#else
+
+size_t PathSplit_split(const char *pcPath, struct PathSpan *psSpans,
+                       size_t uMax, const char **ppcRest)
+{
+   size_t uCount = 0;
+   size_t uStart = 0;
+   size_t uAt;
+
+   assert(pcPath != NULL);
+   assert(psSpans != NULL);
+   assert(uMax >= 1);
+   assert(ppcRest != NULL);
+
+   for (uAt = 0; ; uAt++)
+   {
+      if (pcPath[uAt] != '/' && pcPath[uAt] != '\0')
+         continue;
+      if (uCount == uMax)
+      {
+         *ppcRest = pcPath + uStart;
+         return uCount;
+      }
+      psSpans[uCount].uStart = uStart;
+      psSpans[uCount].uLength = uAt - uStart;
+      uCount++;
+      if (pcPath[uAt] == '\0')
+      {
+         *ppcRest = NULL;
+         return uCount;
+      }
+      uStart = uAt + 1;
+   }
+}
+
+#endif
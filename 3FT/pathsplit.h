@@ -0,0 +1,38 @@
+/*--------------------------------------------------------------------*/
+/* pathsplit.h                                                        */
+/* Author: Alina Chen and Nickolas Casalinuovo                        */
+/*--------------------------------------------------------------------*/
+
+#ifndef PATHSPLIT_INCLUDED
+#define PATHSPLIT_INCLUDED
+
+#include <stddef.h>
+
+/* Splits a path into its components in one pass over it, finding
+   every '/' and the end of the path together, 16 or 32 characters at
+   a time where the compiler targets SSE2 or AVX2, and one at a time
+   otherwise.  The components of a path are the strings between its
+   '/' characters, so "a//b/" has the four components "a", "", "b" and
+   "". */
+
+/* A component of a path: the uLength characters starting uStart
+   characters into it. */
+
+struct PathSpan
+{
+   size_t uStart;
+   size_t uLength;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Store the components of the string pcPath, in order, into
+   psSpans[0...uMax-1], and return the number stored.  uMax must be
+   at least 1.  Set *ppcRest to NULL if every component was stored,
+   or else to the start of the first component that was not, so that
+   splitting *ppcRest continues where this call stopped. */
+
+size_t PathSplit_split(const char *pcPath, struct PathSpan *psSpans,
+                       size_t uMax, const char **ppcRest);
+
+#endif
@@ -0,0 +1,440 @@
+/*--------------------------------------------------------------------*/
+/* record.c                                                           */
+/* Author: Alina Chen and Nickolas Casalinuovo                        */
+/*--------------------------------------------------------------------*/
+
+/* for pthreads */
+#define _POSIX_C_SOURCE 200112L
+
+#include "record.h"
+#include <assert.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*--------------------------------------------------------------------*/
+
+/* The bytes that start a trace. */
+
+static const char acMagic[] = "FTTRACE1";
+
+/* The number of bytes that start a trace. */
+
+enum { MAGIC_LENGTH = sizeof(acMagic) - 1 };
+
+/*--------------------------------------------------------------------*/
+
+/* A Record consists of its file and the last path it wrote, which
+   the next path is written relative to. */
+
+struct Record
+{
+   /* The lock held while a call is written. */
+   pthread_mutex_t sLock;
+
+   /* The file written to. */
+   FILE *psFile;
+
+   /* The last path written, which is not terminated, and its length
+      and the number of bytes allocated for it. */
+   char *pcPrev;
+   size_t uPrevLength;
+   size_t uPrevCapacity;
+};
+
+/* A RecordReader consists of its file, the last path it read, and
+   the names of the last call of FT_insertFiles it read. */
+
+struct RecordReader
+{
+   /* The file read from. */
+   FILE *psFile;
+
+   /* The last path read, and the number of bytes allocated for it. */
+   char *pcPath;
+   size_t uPathLength;
+   size_t uPathCapacity;
+
+   /* The names and lengths of the last call read, and their
+      number, or NULL and 0. */
+   char **ppcNames;
+   size_t *puLengths;
+   size_t uNames;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Write u to psFile as an unsigned LEB128 varint. */
+
+static void Record_putVarint(FILE *psFile, size_t u)
+{
+   assert(psFile != NULL);
+
+   while (u >= 0x80)
+   {
+      putc((int)((u & 0x7f) | 0x80), psFile);
+      u >>= 7;
+   }
+   putc((int)u, psFile);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Write the path pcPath, or none if it is NULL, to oRecord's file,
+   relative to the last path written. */
+
+static void Record_putPath(Record_T oRecord, const char *pcPath)
+{
+   size_t uLength;
+   size_t uShared = 0;
+   char *pcPrev;
+
+   assert(oRecord != NULL);
+
+   if (pcPath == NULL)
+   {
+      Record_putVarint(oRecord->psFile, 0);
+      return;
+   }
+
+   uLength = strlen(pcPath);
+   while (uShared < uLength && uShared < oRecord->uPrevLength
+          && pcPath[uShared] == oRecord->pcPrev[uShared])
+      uShared++;
+   Record_putVarint(oRecord->psFile, uShared + 1);
+   Record_putVarint(oRecord->psFile, uLength - uShared);
+   fwrite(pcPath + uShared, 1, uLength - uShared, oRecord->psFile);
+
+   /* If the path cannot be remembered, the next is written relative
+      to the empty path, which a reader handles alike. */
+   if (uLength > oRecord->uPrevCapacity)
+   {
+      pcPrev = (char*)realloc(oRecord->pcPrev, uLength * 2);
+      if (pcPrev == NULL)
+      {
+         oRecord->uPrevLength = 0;
+         return;
+      }
+      oRecord->pcPrev = pcPrev;
+      oRecord->uPrevCapacity = uLength * 2;
+   }
+   memcpy(oRecord->pcPrev + uShared, pcPath + uShared,
+          uLength - uShared);
+   oRecord->uPrevLength = uLength;
+}
+
+/*--------------------------------------------------------------------*/
+
+Record_T Record_new(FILE *psFile)
+{
+   Record_T oRecord;
+
+   assert(psFile != NULL);
+
+   oRecord = (Record_T)malloc(sizeof(struct Record));
+   if (oRecord == NULL)
+      return NULL;
+   if (pthread_mutex_init(&oRecord->sLock, NULL) != 0)
+   {
+      free(oRecord);
+      return NULL;
+   }
+   if (fwrite(acMagic, 1, MAGIC_LENGTH, psFile) != MAGIC_LENGTH)
+   {
+      (void)pthread_mutex_destroy(&oRecord->sLock);
+      free(oRecord);
+      return NULL;
+   }
+   oRecord->psFile = psFile;
+   oRecord->pcPrev = NULL;
+   oRecord->uPrevLength = 0;
+   oRecord->uPrevCapacity = 0;
+   return oRecord;
+}
+
+/*--------------------------------------------------------------------*/
+
+int Record_free(Record_T oRecord)
+{
+   int iWritten;
+
+   assert(oRecord != NULL);
+
+   iWritten = fflush(oRecord->psFile) == 0
+              && !ferror(oRecord->psFile);
+   (void)pthread_mutex_destroy(&oRecord->sLock);
+   free(oRecord->pcPrev);
+   free(oRecord);
+   return iWritten;
+}
+
+/*--------------------------------------------------------------------*/
+
+void Record_call(const struct FT_TraceEvent *psEvent,
+                 void *pvRecord)
+{
+   Record_T oRecord = (Record_T)pvRecord;
+   FILE *psFile;
+   size_t u;
+
+   assert(psEvent != NULL);
+   assert(oRecord != NULL);
+
+   psFile = oRecord->psFile;
+   (void)pthread_mutex_lock(&oRecord->sLock);
+
+   putc((int)psEvent->op, psFile);
+   Record_putVarint(psFile, (size_t)psEvent->status);
+   Record_putPath(oRecord, psEvent->path);
+   Record_putVarint(psFile, psEvent->handle);
+   Record_putVarint(psFile, psEvent->offset);
+   Record_putVarint(psFile, psEvent->length);
+
+   if (psEvent->op == FT_OP_INSERT_FILES)
+   {
+      if (psEvent->names == NULL)
+         Record_putVarint(psFile, 0);
+      else
+      {
+         Record_putVarint(psFile, psEvent->length);
+         for (u = 0; u < psEvent->length; u++)
+         {
+            Record_putVarint(psFile, strlen(psEvent->names[u]));
+            fputs(psEvent->names[u], psFile);
+            Record_putVarint(psFile, psEvent->lengths != NULL
+                                     ? psEvent->lengths[u] : 0);
+         }
+      }
+   }
+
+   (void)pthread_mutex_unlock(&oRecord->sLock);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Read an unsigned LEB128 varint from psFile into *puValue.  Return 1
+   if one is read, 0 if psFile is at its end, or -1 if it ends part way
+   through the varint or the varint is too large. */
+
+static int RecordReader_getVarint(FILE *psFile, size_t *puValue)
+{
+   size_t uValue = 0;
+   size_t uShift = 0;
+   int iByte;
+
+   assert(psFile != NULL);
+   assert(puValue != NULL);
+
+   for (;;)
+   {
+      iByte = getc(psFile);
+      if (iByte == EOF)
+         return uShift == 0 ? 0 : -1;
+      if (uShift >= sizeof(size_t) * 8)
+         return -1;
+      uValue |= (size_t)(iByte & 0x7f) << uShift;
+      uShift += 7;
+      if ((iByte & 0x80) == 0)
+         break;
+   }
+   *puValue = uValue;
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Read a varint into *puValue from oRecordReader's file, which must
+   not end first.  Return 1 (TRUE) if it is read, or 0 (FALSE) if
+   not. */
+
+static int RecordReader_getField(RecordReader_T oRecordReader,
+                                 size_t *puValue)
+{
+   assert(oRecordReader != NULL);
+
+   return RecordReader_getVarint(oRecordReader->psFile, puValue) == 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Free the names of the last call read by oRecordReader. */
+
+static void RecordReader_freeNames(RecordReader_T oRecordReader)
+{
+   size_t u;
+
+   assert(oRecordReader != NULL);
+
+   for (u = 0; u < oRecordReader->uNames; u++)
+      free(oRecordReader->ppcNames[u]);
+   free(oRecordReader->ppcNames);
+   free(oRecordReader->puLengths);
+   oRecordReader->ppcNames = NULL;
+   oRecordReader->puLengths = NULL;
+   oRecordReader->uNames = 0;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Read a path relative to the last path read by oRecordReader, and
+   assign it, or NULL if there is none, to *ppcPath.  Return 1 (TRUE)
+   if successful, or 0 (FALSE) if the trace is malformed or
+   insufficient memory is available. */
+
+static int RecordReader_getPath(RecordReader_T oRecordReader,
+                                const char **ppcPath)
+{
+   size_t uShared;
+   size_t uRest;
+   char *pcPath;
+
+   assert(oRecordReader != NULL);
+   assert(ppcPath != NULL);
+
+   if (!RecordReader_getField(oRecordReader, &uShared))
+      return 0;
+   if (uShared == 0)
+   {
+      *ppcPath = NULL;
+      return 1;
+   }
+   uShared--;
+   if (uShared > oRecordReader->uPathLength
+       || !RecordReader_getField(oRecordReader, &uRest)
+       || uRest > (size_t)-1 / 2 - uShared)
+      return 0;
+
+   if (uShared + uRest + 1 > oRecordReader->uPathCapacity)
+   {
+      pcPath = (char*)realloc(oRecordReader->pcPath,
+                              (uShared + uRest + 1) * 2);
+      if (pcPath == NULL)
+         return 0;
+      oRecordReader->pcPath = pcPath;
+      oRecordReader->uPathCapacity = (uShared + uRest + 1) * 2;
+   }
+   if (fread(oRecordReader->pcPath + uShared, 1, uRest,
+             oRecordReader->psFile) != uRest)
+      return 0;
+   oRecordReader->pcPath[uShared + uRest] = '\0';
+   oRecordReader->uPathLength = uShared + uRest;
+   *ppcPath = oRecordReader->pcPath;
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Read the names and lengths of a call of FT_insertFiles into
+   oRecordReader.  Return 1 (TRUE) if successful, or 0 (FALSE) if the
+   trace is malformed or insufficient memory is available. */
+
+static int RecordReader_getNames(RecordReader_T oRecordReader)
+{
+   size_t uNames;
+   size_t uLength;
+   size_t u;
+
+   assert(oRecordReader != NULL);
+   assert(oRecordReader->uNames == 0);
+
+   if (!RecordReader_getField(oRecordReader, &uNames))
+      return 0;
+   if (uNames == 0)
+      return 1;
+   if (uNames > (size_t)-1 / sizeof(char*))
+      return 0;
+
+   oRecordReader->ppcNames = (char**)calloc(uNames, sizeof(char*));
+   oRecordReader->puLengths = (size_t*)calloc(uNames,
+                                              sizeof(size_t));
+   if (oRecordReader->ppcNames == NULL
+       || oRecordReader->puLengths == NULL)
+      return 0;
+   oRecordReader->uNames = uNames;
+
+   for (u = 0; u < uNames; u++)
+   {
+      if (!RecordReader_getField(oRecordReader, &uLength)
+          || uLength == (size_t)-1)
+         return 0;
+      oRecordReader->ppcNames[u] = (char*)malloc(uLength + 1);
+      if (oRecordReader->ppcNames[u] == NULL
+          || fread(oRecordReader->ppcNames[u], 1, uLength,
+                   oRecordReader->psFile) != uLength)
+         return 0;
+      oRecordReader->ppcNames[u][uLength] = '\0';
+      if (!RecordReader_getField(oRecordReader,
+                                 &oRecordReader->puLengths[u]))
+         return 0;
+   }
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+RecordReader_T RecordReader_new(FILE *psFile)
+{
+   RecordReader_T oRecordReader;
+   char acStart[MAGIC_LENGTH];
+
+   assert(psFile != NULL);
+
+   if (fread(acStart, 1, MAGIC_LENGTH, psFile) != MAGIC_LENGTH
+       || memcmp(acStart, acMagic, MAGIC_LENGTH) != 0)
+      return NULL;
+
+   oRecordReader = (RecordReader_T)calloc(1,
+                                          sizeof(struct RecordReader));
+   if (oRecordReader == NULL)
+      return NULL;
+   oRecordReader->psFile = psFile;
+   return oRecordReader;
+}
+
+/*--------------------------------------------------------------------*/
+
+void RecordReader_free(RecordReader_T oRecordReader)
+{
+   if (oRecordReader == NULL)
+      return;
+
+   RecordReader_freeNames(oRecordReader);
+   free(oRecordReader->pcPath);
+   free(oRecordReader);
+}
+
+/*--------------------------------------------------------------------*/
+
+int RecordReader_next(RecordReader_T oRecordReader,
+                      struct RecordedCall *psCall)
+{
+   size_t uStatus;
+   int iOp;
+
+   assert(oRecordReader != NULL);
+   assert(psCall != NULL);
+
+   RecordReader_freeNames(oRecordReader);
+
+   iOp = getc(oRecordReader->psFile);
+   if (iOp == EOF)
+      return 0;
+   if (iOp >= FT_OPS)
+      return -1;
+   psCall->eOp = (enum FT_Op)iOp;
+
+   if (!RecordReader_getField(oRecordReader, &uStatus)
+       || !RecordReader_getPath(oRecordReader, &psCall->pcPath)
+       || !RecordReader_getField(oRecordReader, &psCall->uHandle)
+       || !RecordReader_getField(oRecordReader, &psCall->uOffset)
+       || !RecordReader_getField(oRecordReader, &psCall->uLength))
+      return -1;
+   psCall->iStatus = (int)uStatus;
+
+   if (psCall->eOp == FT_OP_INSERT_FILES
+       && !RecordReader_getNames(oRecordReader))
+      return -1;
+   psCall->ppcNames = oRecordReader->ppcNames;
+   psCall->puLengths = oRecordReader->puLengths;
+   return 1;
+}
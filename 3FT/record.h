@@ -0,0 +1,107 @@
+/*--------------------------------------------------------------------*/
+/* record.h                                                           */
+/* Author: Alina Chen and Nickolas Casalinuovo                        */
+/*--------------------------------------------------------------------*/
+
+#ifndef RECORD_INCLUDED
+#define RECORD_INCLUDED
+
+#include <stddef.h>
+#include <stdio.h>
+#include "ft.h"
+
+/* A Record_T object writes each FT call it is shown to a file as a
+   compact binary trace, to be read back by a RecordReader_T object,
+   such as by replay.  It is meant to be registered as a post hook
+   before FT_init, so that the trace holds the whole life of the tree:
+
+      FT_setTraceHooks(NULL, Record_call, oRecord);
+
+   It may be shown calls by several threads at once.
+
+   A trace is the bytes "FTTRACE1" followed by one record per call.
+   All numbers are unsigned LEB128 varints.  A record is the call's
+   op; its status; one more than the length of the start its path
+   shares with the previous record's path, or 0 if it has no path;
+   the length and bytes of the rest of its path; its handle; its
+   offset; and its length.  A record of FT_insertFiles goes on with
+   the number of names recorded, 0 if it was passed none, then the
+   length and bytes of each name and the length passed with it.  File
+   contents are not recorded, only their lengths. */
+
+typedef struct Record *Record_T;
+
+/* A RecordReader_T object reads the calls of a trace one by one. */
+
+typedef struct RecordReader *RecordReader_T;
+
+/* A call read from a trace, with the fields of struct FT_TraceEvent
+   of the same names. */
+
+struct RecordedCall
+{
+   enum FT_Op eOp;
+   int iStatus;
+
+   /* The path, or NULL if the call had none. */
+   const char *pcPath;
+
+   FT_Handle uHandle;
+   size_t uOffset;
+   size_t uLength;
+
+   /* For FT_insertFiles, the uLength names and lengths passed, and
+      NULL otherwise. */
+   char **ppcNames;
+   size_t *puLengths;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Return a new Record_T object that writes a trace to psFile, having
+   written its start, or NULL if insufficient memory is available or
+   the start cannot be written. */
+
+Record_T Record_new(FILE *psFile);
+
+/*--------------------------------------------------------------------*/
+
+/* Free oRecord, which must no longer be registered as a hook, and
+   flush its file, which it does not close.  Return 1 (TRUE) if the
+   whole trace was written, or 0 (FALSE) if a write failed. */
+
+int Record_free(Record_T oRecord);
+
+/*--------------------------------------------------------------------*/
+
+/* Write the finished call psEvent to the trace of pvRecord, a
+   Record_T. */
+
+void Record_call(const struct FT_TraceEvent *psEvent,
+                 void *pvRecord);
+
+/*--------------------------------------------------------------------*/
+
+/* Return a new RecordReader_T object that reads the trace in psFile,
+   having read its start, or NULL if psFile does not start a trace or
+   insufficient memory is available. */
+
+RecordReader_T RecordReader_new(FILE *psFile);
+
+/*--------------------------------------------------------------------*/
+
+/* Free oRecordReader.  Its file is not closed. */
+
+void RecordReader_free(RecordReader_T oRecordReader);
+
+/*--------------------------------------------------------------------*/
+
+/* Read the next call of oRecordReader's trace into *psCall, whose
+   path and names remain valid until the next read.  Return 1 if a
+   call is read, 0 at the end of the trace, or -1 if the trace is
+   malformed or insufficient memory is available. */
+
+int RecordReader_next(RecordReader_T oRecordReader,
+                      struct RecordedCall *psCall);
+
+#endif
@@ -0,0 +1,519 @@
+/*--------------------------------------------------------------------*/
+/* replay.c                                                           */
+/* Author: Alina Chen and Nickolas Casalinuovo                        */
+/*--------------------------------------------------------------------*/
+
+/* for clock_gettime */
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "ft.h"
+#include "record.h"
+
+/* Replays a trace written by a Record_T object against a new tree:
+   reads the whole trace into memory, then makes its calls one after
+   another as fast as possible, and prints to stdout the calls made
+   per second and percentiles of their latencies.  File contents are
+   zero bytes of the recorded lengths, or NULL for length 0.
+
+   Usage: replay [-c] tracefile
+
+   With -c, checks that each call ends with the status it was
+   recorded with (as counted in struct FT_OpStats), reports to stderr
+   the first few that do not, and exits with failure if any does not.
+   The statuses of calls that return none are taken from a trace hook,
+   so with -c every call is timed, which slows the replay a little. */
+
+/*--------------------------------------------------------------------*/
+
+/* The most mismatched calls reported individually. */
+
+enum { REPORTED_MISMATCHES = 10 };
+
+/*--------------------------------------------------------------------*/
+
+/* A call of the trace, with its own copies of its path and names. */
+
+struct ReplayCall
+{
+   struct RecordedCall sCall;
+   char *pcPath;
+   char **ppcNames;
+   size_t *puLengths;
+};
+
+/* A map from the handles FT_open returned when the trace was recorded
+   to those it returned when replayed, in open addressing. */
+
+struct HandleMap
+{
+   /* The number of slots, a power of 2. */
+   size_t uSlots;
+
+   /* The recorded handles, 0 for an empty slot, and the replayed
+      handles they map to. */
+   FT_Handle *puRecorded;
+   FT_Handle *puReplayed;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Return the current time in nanoseconds. */
+
+static uint64_t now(void)
+{
+   struct timespec sTime;
+
+   (void)clock_gettime(CLOCK_MONOTONIC, &sTime);
+   return (uint64_t)sTime.tv_sec * 1000000000u
+          + (uint64_t)sTime.tv_nsec;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return a new copy of string pcString, or NULL if insufficient
+   memory is available. */
+
+static char *copyString(const char *pcString)
+{
+   char *pcCopy;
+
+   pcCopy = (char*)malloc(strlen(pcString) + 1);
+   if (pcCopy != NULL)
+      strcpy(pcCopy, pcString);
+   return pcCopy;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Copy the call just read, psCall, into psReplay.  Return 1 (TRUE)
+   if successful, or 0 (FALSE) if insufficient memory is available. */
+
+static int copyCall(struct ReplayCall *psReplay,
+                    const struct RecordedCall *psCall)
+{
+   size_t u;
+
+   psReplay->sCall = *psCall;
+   psReplay->pcPath = NULL;
+   psReplay->ppcNames = NULL;
+   psReplay->puLengths = NULL;
+
+   if (psCall->pcPath != NULL)
+   {
+      psReplay->pcPath = copyString(psCall->pcPath);
+      if (psReplay->pcPath == NULL)
+         return 0;
+   }
+
+   if (psCall->ppcNames != NULL)
+   {
+      psReplay->ppcNames = (char**)calloc(psCall->uLength,
+                                          sizeof(char*));
+      psReplay->puLengths = (size_t*)malloc(psCall->uLength
+                                            * sizeof(size_t));
+      if (psReplay->ppcNames == NULL || psReplay->puLengths == NULL)
+         return 0;
+      for (u = 0; u < psCall->uLength; u++)
+      {
+         psReplay->ppcNames[u] = copyString(psCall->ppcNames[u]);
+         if (psReplay->ppcNames[u] == NULL)
+            return 0;
+         psReplay->puLengths[u] = psCall->puLengths[u];
+      }
+   }
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Free the copies held by the uCalls calls of psCalls, and psCalls. */
+
+static void freeCalls(struct ReplayCall *psCalls, size_t uCalls)
+{
+   size_t u;
+   size_t uName;
+
+   for (u = 0; u < uCalls; u++)
+   {
+      free(psCalls[u].pcPath);
+      if (psCalls[u].ppcNames != NULL)
+         for (uName = 0; uName < psCalls[u].sCall.uLength; uName++)
+            free(psCalls[u].ppcNames[uName]);
+      free(psCalls[u].ppcNames);
+      free(psCalls[u].puLengths);
+   }
+   free(psCalls);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Read the trace in psFile into a new array of calls, assigning it
+   to *ppsCalls and its length to *puCalls.  Return 1 (TRUE) if
+   successful, or 0 (FALSE) if the trace is malformed or insufficient
+   memory is available. */
+
+static int readCalls(FILE *psFile, struct ReplayCall **ppsCalls,
+                     size_t *puCalls)
+{
+   RecordReader_T oReader;
+   struct RecordedCall sCall;
+   struct ReplayCall *psCalls = NULL;
+   struct ReplayCall *psMore;
+   size_t uCalls = 0;
+   size_t uCapacity = 0;
+   int iRead;
+
+   oReader = RecordReader_new(psFile);
+   if (oReader == NULL)
+      return 0;
+
+   while ((iRead = RecordReader_next(oReader, &sCall)) == 1)
+   {
+      if (uCalls == uCapacity)
+      {
+         uCapacity = uCapacity == 0 ? 1024 : uCapacity * 2;
+         psMore = (struct ReplayCall*)
+            realloc(psCalls, uCapacity * sizeof(struct ReplayCall));
+         if (psMore == NULL)
+            break;
+         psCalls = psMore;
+      }
+      if (!copyCall(&psCalls[uCalls], &sCall))
+      {
+         uCalls++;
+         break;
+      }
+      uCalls++;
+   }
+   RecordReader_free(oReader);
+
+   if (iRead != 0)
+   {
+      freeCalls(psCalls, uCalls);
+      return 0;
+   }
+   *ppsCalls = psCalls;
+   *puCalls = uCalls;
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the slot of psMap holding uRecorded, or the empty slot where
+   it belongs. */
+
+static size_t findHandle(const struct HandleMap *psMap,
+                         FT_Handle uRecorded)
+{
+   size_t uSlot;
+
+   uSlot = (uRecorded * (size_t)0x9E3779B97F4A7C15ULL)
+           & (psMap->uSlots - 1);
+   while (psMap->puRecorded[uSlot] != 0
+          && psMap->puRecorded[uSlot] != uRecorded)
+      uSlot = (uSlot + 1) & (psMap->uSlots - 1);
+   return uSlot;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the handle that recorded handle uRecorded maps to in psMap,
+   or 0, which is never valid, if it maps to none. */
+
+static FT_Handle mapHandle(const struct HandleMap *psMap,
+                           FT_Handle uRecorded)
+{
+   if (uRecorded == 0)
+      return 0;
+   return psMap->puReplayed[findHandle(psMap, uRecorded)];
+}
+
+/*--------------------------------------------------------------------*/
+
+/* The status the last call ended with, as noted by noteStatus. */
+
+static int iLastStatus;
+
+/* Note the status psEvent ended with, as a trace hook called after
+   each call. */
+
+static void noteStatus(const struct FT_TraceEvent *psEvent,
+                       void *pvContext)
+{
+   (void)pvContext;
+   iLastStatus = psEvent->status;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Make the call psReplay, with the file contents pvContents, which
+   are zero bytes at least as long as any recorded length, and the
+   array of pointers to it ppvContents, at least as long as any call
+   of FT_insertFiles.  pvBuffer is as long, to be read into.  Map
+   handles through psMap.  Return the call's status, as
+   counted in struct FT_OpStats; for calls that return no status this
+   is only known if noteStatus is registered as a trace hook. */
+
+static int makeCall(const struct ReplayCall *psReplay,
+                    void *pvContents, void **ppvContents,
+                    void *pvBuffer, struct HandleMap *psMap)
+{
+   const struct RecordedCall *psCall = &psReplay->sCall;
+   char *pcPath = psReplay->pcPath;
+   size_t uLength = psCall->uLength;
+   void *pvGiven = uLength == 0 ? NULL : pvContents;
+   FT_Handle uHandle;
+   boolean bType;
+   size_t uSize;
+   void *pvOld;
+   char *pcString;
+   size_t uSlot;
+
+   switch (psCall->eOp)
+   {
+      case FT_OP_INSERT_DIR:
+         return FT_insertDir(pcPath);
+      case FT_OP_CONTAINS_DIR:
+         (void)FT_containsDir(pcPath);
+         return iLastStatus;
+      case FT_OP_RM_DIR:
+         return FT_rmDir(pcPath);
+      case FT_OP_INSERT_FILE:
+         return FT_insertFile(pcPath, pvGiven, uLength);
+      case FT_OP_INSERT_FILES:
+         if (psReplay->ppcNames == NULL)
+            uLength = 0;
+         return FT_insertFiles(pcPath, uLength, psReplay->ppcNames,
+                               ppvContents, psReplay->puLengths);
+      case FT_OP_CONTAINS_FILE:
+         (void)FT_containsFile(pcPath);
+         return iLastStatus;
+      case FT_OP_RM_FILE:
+         return FT_rmFile(pcPath);
+      case FT_OP_GET_FILE_CONTENTS:
+         (void)FT_getFileContents(pcPath);
+         return iLastStatus;
+      case FT_OP_REPLACE_FILE_CONTENTS:
+         pvOld = FT_replaceFileContents(pcPath, pvGiven, uLength);
+         /* Old contents other than those passed in are a copy the
+            tree made, whether in owned mode or because the file was
+            written by FT_writeFileRange or FT_appendFile. */
+         if (pvOld != pvContents)
+            free(pvOld);
+         return iLastStatus;
+      case FT_OP_READ_FILE_RANGE:
+         (void)FT_readFileRange(pcPath, psCall->uOffset, uLength,
+                                pvBuffer);
+         return iLastStatus;
+      case FT_OP_WRITE_FILE_RANGE:
+         return FT_writeFileRange(pcPath, psCall->uOffset,
+                                  pvContents, uLength);
+      case FT_OP_APPEND_FILE:
+         return FT_appendFile(pcPath, pvContents, uLength);
+      case FT_OP_STAT:
+         return FT_stat(pcPath, &bType, &uSize);
+      case FT_OP_OPEN:
+         uHandle = FT_open(pcPath);
+         if (psCall->uHandle != 0 && uHandle != 0)
+         {
+            uSlot = findHandle(psMap, psCall->uHandle);
+            psMap->puRecorded[uSlot] = psCall->uHandle;
+            psMap->puReplayed[uSlot] = uHandle;
+         }
+         return iLastStatus;
+      case FT_OP_GET_FILE_CONTENTS_H:
+         (void)FT_getFileContentsH(mapHandle(psMap, psCall->uHandle));
+         return iLastStatus;
+      case FT_OP_REPLACE_FILE_CONTENTS_H:
+         pvOld = FT_replaceFileContentsH(
+            mapHandle(psMap, psCall->uHandle), pvGiven, uLength);
+         if (pvOld != pvContents)
+            free(pvOld);
+         return iLastStatus;
+      case FT_OP_STAT_H:
+         return FT_statH(mapHandle(psMap, psCall->uHandle), &bType,
+                         &uSize);
+      case FT_OP_INSERT_FILE_AT:
+         return FT_insertFileAt(mapHandle(psMap, psCall->uHandle),
+                                pcPath, pvGiven, uLength);
+      case FT_OP_CONTAINS_AT:
+         (void)FT_containsAt(mapHandle(psMap, psCall->uHandle),
+                             pcPath, (boolean)uLength);
+         return iLastStatus;
+      case FT_OP_RM_FILE_AT:
+         return FT_rmFileAt(mapHandle(psMap, psCall->uHandle),
+                            pcPath);
+      case FT_OP_TO_STRING:
+         pcString = FT_toString();
+         free(pcString);
+         return iLastStatus;
+      case FT_OP_INIT:
+         return FT_init();
+      case FT_OP_INIT_OWNED:
+         return FT_initOwned();
+      case FT_OP_DESTROY:
+         return FT_destroy();
+      case FT_OP_COMPACT:
+         return FT_compact(NULL);
+      default:
+         return psCall->iStatus;
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Compare the latencies pvOne and pvTwo, for qsort. */
+
+static int compareLatencies(const void *pvOne, const void *pvTwo)
+{
+   uint64_t uOne = *(const uint64_t*)pvOne;
+   uint64_t uTwo = *(const uint64_t*)pvTwo;
+
+   if (uOne < uTwo)
+      return -1;
+   return uOne > uTwo;
+}
+
+/*--------------------------------------------------------------------*/
+
+int main(int argc, char *argv[])
+{
+   static const double adPercentiles[] = { 50, 90, 99, 99.9, 100 };
+   const char *pcTrace;
+   FILE *psFile;
+   struct ReplayCall *psCalls;
+   struct HandleMap sMap;
+   uint64_t *puLatencies;
+   void *pvContents;
+   void **ppvContents;
+   void *pvBuffer;
+   size_t uCalls;
+   size_t uLongest = 1;
+   size_t uMostFiles = 1;
+   size_t uMismatches = 0;
+   size_t u;
+   uint64_t uStart;
+   uint64_t uEnd;
+   uint64_t uTotal = 0;
+   int bCheck = 0;
+   int iStatus;
+
+   if (argc == 3 && strcmp(argv[1], "-c") == 0)
+   {
+      bCheck = 1;
+      pcTrace = argv[2];
+   }
+   else if (argc == 2)
+      pcTrace = argv[1];
+   else
+   {
+      fprintf(stderr, "usage: %s [-c] tracefile\n", argv[0]);
+      return EXIT_FAILURE;
+   }
+
+   psFile = fopen(pcTrace, "rb");
+   if (psFile == NULL)
+   {
+      perror(pcTrace);
+      return EXIT_FAILURE;
+   }
+   iStatus = readCalls(psFile, &psCalls, &uCalls);
+   fclose(psFile);
+   if (!iStatus)
+   {
+      fprintf(stderr, "replay: %s: malformed trace or out of memory\n",
+              pcTrace);
+      return EXIT_FAILURE;
+   }
+
+   sMap.uSlots = 16;
+   for (u = 0; u < uCalls; u++)
+   {
+      if (psCalls[u].sCall.eOp == FT_OP_OPEN)
+         sMap.uSlots++;
+      if (psCalls[u].sCall.eOp == FT_OP_INSERT_FILES)
+      {
+         if (psCalls[u].sCall.uLength > uMostFiles)
+            uMostFiles = psCalls[u].sCall.uLength;
+      }
+      else if (psCalls[u].sCall.uLength > uLongest)
+         uLongest = psCalls[u].sCall.uLength;
+   }
+   /* Keep the map at most half full. */
+   u = 16;
+   while (u < 2 * sMap.uSlots)
+      u *= 2;
+   sMap.uSlots = u;
+
+   sMap.puRecorded = (FT_Handle*)calloc(sMap.uSlots, sizeof(FT_Handle));
+   sMap.puReplayed = (FT_Handle*)calloc(sMap.uSlots, sizeof(FT_Handle));
+   puLatencies = (uint64_t*)malloc((uCalls + 1) * sizeof(uint64_t));
+   pvContents = calloc(uLongest, 1);
+   pvBuffer = malloc(uLongest);
+   ppvContents = (void**)malloc(uMostFiles * sizeof(void*));
+   if (sMap.puRecorded == NULL || sMap.puReplayed == NULL
+       || puLatencies == NULL || pvContents == NULL || pvBuffer == NULL
+       || ppvContents == NULL)
+   {
+      fprintf(stderr, "replay: out of memory\n");
+      return EXIT_FAILURE;
+   }
+   for (u = 0; u < uMostFiles; u++)
+      ppvContents[u] = pvContents;
+   if (bCheck)
+      FT_setTraceHooks(NULL, noteStatus, NULL);
+
+   for (u = 0; u < uCalls; u++)
+   {
+      uStart = now();
+      iStatus = makeCall(&psCalls[u], pvContents, ppvContents,
+                         pvBuffer, &sMap);
+      uEnd = now();
+      puLatencies[u] = uEnd - uStart;
+      uTotal += uEnd - uStart;
+
+      if (bCheck && iStatus != psCalls[u].sCall.iStatus)
+      {
+         if (uMismatches < REPORTED_MISMATCHES)
+            fprintf(stderr, "replay: call %lu, %s %s: returned %d, "
+                    "recorded %d\n", (unsigned long)u,
+                    FT_opName(psCalls[u].sCall.eOp),
+                    psCalls[u].pcPath != NULL ? psCalls[u].pcPath
+                                              : "-",
+                    iStatus, psCalls[u].sCall.iStatus);
+         uMismatches++;
+      }
+   }
+   (void)FT_destroy();
+
+   printf("%-12s %14lu\n", "calls", (unsigned long)uCalls);
+   printf("%-12s %14.3f\n", "seconds", (double)uTotal / 1e9);
+   printf("%-12s %14.0f\n", "calls/s",
+          uTotal == 0 ? 0.0 : (double)uCalls * 1e9 / (double)uTotal);
+   if (uCalls > 0)
+   {
+      qsort(puLatencies, uCalls, sizeof(uint64_t), compareLatencies);
+      for (u = 0; u < sizeof(adPercentiles) / sizeof(adPercentiles[0]);
+           u++)
+         printf("p%-5g ns %14lu\n", adPercentiles[u],
+                (unsigned long)puLatencies[(size_t)
+                   ((double)(uCalls - 1) * adPercentiles[u] / 100)]);
+   }
+   if (bCheck)
+      printf("%-12s %14lu\n", "mismatches", (unsigned long)uMismatches);
+
+   free(sMap.puRecorded);
+   free(sMap.puReplayed);
+   free(puLatencies);
+   free(pvContents);
+   free(pvBuffer);
+   free(ppvContents);
+   freeCalls(psCalls, uCalls);
+
+   return uMismatches == 0 ? 0 : EXIT_FAILURE;
+}
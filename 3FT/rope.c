@@ -0,0 +1,377 @@
+/*--------------------------------------------------------------------*/
+/* rope.c                                                             */
+/* Author: Alina Chen and Nickolas Casalinuovo                        */
+/*--------------------------------------------------------------------*/
+
+#include "rope.h"
+#include "dynarray.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*--------------------------------------------------------------------*/
+
+/* The number of bytes held by every chunk but the last. */
+
+enum { CHUNK_SIZE = 4096 };
+
+/* The smallest physical size of the last chunk. */
+
+enum { MIN_TAIL_SIZE = 16 };
+
+/*--------------------------------------------------------------------*/
+
+/* A Rope consists of a table of chunks, along with its length, the
+   physical size of its last chunk, and a cached contiguous copy. */
+
+struct Rope
+{
+   /* The number of bytes in the Rope. */
+   size_t uLength;
+
+   /* The chunks that hold the bytes, in order.  Every chunk but the
+      last holds exactly CHUNK_SIZE bytes. */
+   DynArray_T oChunks;
+
+   /* The number of bytes allocated for the last chunk. */
+   size_t uTailSize;
+
+   /* A contiguous copy of the bytes, or NULL if there is none.  When
+      the Rope has a single chunk, this is that chunk. */
+   char *pcFlat;
+};
+
+/*--------------------------------------------------------------------*/
+
+#ifndef NDEBUG
+
+/* Check the invariants of oRope.  Return 1 (TRUE) iff oRope is in a
+   valid state. */
+
+static int Rope_isValid(Rope_T oRope)
+{
+   size_t uChunks;
+
+   if (oRope->oChunks == NULL) return 0;
+   uChunks = DynArray_getLength(oRope->oChunks);
+   if (oRope->uLength > uChunks * CHUNK_SIZE) return 0;
+   if (uChunks > 0 && oRope->uLength <= (uChunks - 1) * CHUNK_SIZE)
+      return 0;
+   if (uChunks > 0 && oRope->uTailSize > CHUNK_SIZE) return 0;
+   if (uChunks > 0
+       && oRope->uLength - (uChunks - 1) * CHUNK_SIZE > oRope->uTailSize)
+      return 0;
+   return 1;
+}
+
+#endif
+
+/*--------------------------------------------------------------------*/
+
+/* Discard the contiguous copy of oRope, if it owns one. */
+
+static void Rope_dropFlat(Rope_T oRope)
+{
+   assert(oRope != NULL);
+
+   if (DynArray_getLength(oRope->oChunks) > 1)
+      free(oRope->pcFlat);
+   oRope->pcFlat = NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Allocate the chunks that oRope needs to hold uNewLength bytes.
+   Return 1 (TRUE) if successful, or 0 (FALSE) if insufficient memory
+   is available, in which case no chunk is added.  The cached copy of
+   oRope must already have been dropped. */
+
+static int Rope_reserve(Rope_T oRope, size_t uNewLength)
+{
+   size_t uChunks;
+   size_t uOldChunks;
+   size_t uTailNeed;
+   size_t uNewTailSize;
+   char *pcChunk;
+
+   assert(oRope != NULL);
+
+   uOldChunks = DynArray_getLength(oRope->oChunks);
+   uChunks = uOldChunks;
+
+   /* Fill out the current last chunk. */
+   if (uChunks > 0)
+   {
+      uTailNeed = uNewLength - (uChunks - 1) * CHUNK_SIZE;
+      if (uTailNeed > CHUNK_SIZE)
+         uTailNeed = CHUNK_SIZE;
+      if (uTailNeed > oRope->uTailSize)
+      {
+         uNewTailSize = oRope->uTailSize;
+         while (uNewTailSize < uTailNeed)
+            uNewTailSize *= 2;
+         if (uNewTailSize > CHUNK_SIZE)
+            uNewTailSize = CHUNK_SIZE;
+         pcChunk = realloc(DynArray_get(oRope->oChunks, uChunks - 1),
+                           uNewTailSize);
+         if (pcChunk == NULL)
+            return 0;
+         (void)DynArray_set(oRope->oChunks, uChunks - 1, pcChunk);
+         oRope->uTailSize = uNewTailSize;
+      }
+   }
+
+   /* Add new chunks, full-sized except for the last one. */
+   while (uChunks * CHUNK_SIZE < uNewLength)
+   {
+      uTailNeed = uNewLength - uChunks * CHUNK_SIZE;
+      if (uTailNeed >= CHUNK_SIZE)
+         uNewTailSize = CHUNK_SIZE;
+      else
+      {
+         uNewTailSize = MIN_TAIL_SIZE;
+         while (uNewTailSize < uTailNeed)
+            uNewTailSize *= 2;
+      }
+      pcChunk = malloc(uNewTailSize);
+      if (pcChunk == NULL || ! DynArray_add(oRope->oChunks, pcChunk))
+      {
+         free(pcChunk);
+         while (DynArray_getLength(oRope->oChunks) > uOldChunks)
+            free(DynArray_removeAt(oRope->oChunks,
+                                   DynArray_getLength(oRope->oChunks)
+                                   - 1));
+         return 0;
+      }
+      uChunks++;
+      oRope->uTailSize = uNewTailSize;
+   }
+
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+Rope_T Rope_new(const void *pvData, size_t uLength)
+{
+   Rope_T oRope;
+
+   oRope = (struct Rope*)malloc(sizeof(struct Rope));
+   if (oRope == NULL)
+      return NULL;
+
+   oRope->uLength = 0;
+   oRope->uTailSize = 0;
+   oRope->pcFlat = NULL;
+   oRope->oChunks = DynArray_new(0);
+   if (oRope->oChunks == NULL)
+   {
+      free(oRope);
+      return NULL;
+   }
+
+   if (uLength > 0 && ! Rope_write(oRope, 0, pvData, uLength))
+   {
+      Rope_free(oRope);
+      return NULL;
+   }
+
+   assert(Rope_isValid(oRope));
+
+   return oRope;
+}
+
+/*--------------------------------------------------------------------*/
+
+void Rope_free(Rope_T oRope)
+{
+   size_t u;
+
+   assert(oRope != NULL);
+   assert(Rope_isValid(oRope));
+
+   Rope_dropFlat(oRope);
+   for (u = 0; u < DynArray_getLength(oRope->oChunks); u++)
+      free(DynArray_get(oRope->oChunks, u));
+   DynArray_free(oRope->oChunks);
+   free(oRope);
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t Rope_getLength(Rope_T oRope)
+{
+   assert(oRope != NULL);
+   assert(Rope_isValid(oRope));
+
+   return oRope->uLength;
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t Rope_getBytes(Rope_T oRope)
+{
+   size_t uChunks;
+   size_t uBytes;
+
+   assert(oRope != NULL);
+
+   uChunks = DynArray_getLength(oRope->oChunks);
+   uBytes = sizeof(struct Rope) + uChunks * sizeof(char*);
+   if (uChunks > 0)
+      uBytes += (uChunks - 1) * CHUNK_SIZE + oRope->uTailSize;
+   if (oRope->pcFlat != NULL && uChunks > 1)
+      uBytes += oRope->uLength;
+   return uBytes;
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t Rope_read(Rope_T oRope, size_t uOffset, size_t uLength,
+                 void *pvBuf)
+{
+   char *pcBuf = pvBuf;
+   size_t uCopied = 0;
+   size_t uIndex;
+   size_t uInner;
+   size_t uPart;
+
+   assert(oRope != NULL);
+   assert(pvBuf != NULL || uLength == 0);
+   assert(Rope_isValid(oRope));
+
+   if (uOffset >= oRope->uLength)
+      return 0;
+   if (uLength > oRope->uLength - uOffset)
+      uLength = oRope->uLength - uOffset;
+
+   uIndex = uOffset / CHUNK_SIZE;
+   uInner = uOffset % CHUNK_SIZE;
+   while (uCopied < uLength)
+   {
+      uPart = CHUNK_SIZE - uInner;
+      if (uPart > uLength - uCopied)
+         uPart = uLength - uCopied;
+      memcpy(pcBuf + uCopied,
+             (char*)DynArray_get(oRope->oChunks, uIndex) + uInner,
+             uPart);
+      uCopied += uPart;
+      uIndex++;
+      uInner = 0;
+   }
+
+   return uCopied;
+}
+
+/*--------------------------------------------------------------------*/
+
+int Rope_write(Rope_T oRope, size_t uOffset, const void *pvData,
+               size_t uLength)
+{
+   const char *pcData = pvData;
+   size_t uStart;
+   size_t uEnd;
+   size_t uDone;
+   size_t uIndex;
+   size_t uInner;
+   size_t uPart;
+   char *pcChunk;
+
+   assert(oRope != NULL);
+   assert(Rope_isValid(oRope));
+
+   if (uLength == 0)
+      return 1;
+
+   /* The range written includes any gap before uOffset. */
+   uStart = uOffset;
+   if (uStart > oRope->uLength)
+      uStart = oRope->uLength;
+   uEnd = uOffset + uLength;
+   if (uEnd < uOffset)
+      return 0;
+
+   /* The cached copy may alias a chunk that is about to move. */
+   Rope_dropFlat(oRope);
+
+   if (uEnd > oRope->uLength && ! Rope_reserve(oRope, uEnd))
+      return 0;
+
+   uIndex = uStart / CHUNK_SIZE;
+   uInner = uStart % CHUNK_SIZE;
+   for (uDone = uStart; uDone < uEnd; uDone += uPart)
+   {
+      uPart = CHUNK_SIZE - uInner;
+      if (uPart > uEnd - uDone)
+         uPart = uEnd - uDone;
+      pcChunk = (char*)DynArray_get(oRope->oChunks, uIndex) + uInner;
+      if (uDone < uOffset)
+      {
+         /* Zero-fill the gap, stopping where the data begins. */
+         if (uPart > uOffset - uDone)
+            uPart = uOffset - uDone;
+         memset(pcChunk, 0, uPart);
+      }
+      else if (pcData == NULL)
+         memset(pcChunk, 0, uPart);
+      else
+         memcpy(pcChunk, pcData + (uDone - uOffset), uPart);
+      uInner += uPart;
+      if (uInner == CHUNK_SIZE)
+      {
+         uIndex++;
+         uInner = 0;
+      }
+   }
+
+   if (uEnd > oRope->uLength)
+      oRope->uLength = uEnd;
+
+   assert(Rope_isValid(oRope));
+
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+const void *Rope_flatten(Rope_T oRope)
+{
+   assert(oRope != NULL);
+   assert(Rope_isValid(oRope));
+
+   if (oRope->uLength == 0)
+      return NULL;
+
+   if (oRope->pcFlat != NULL)
+      return oRope->pcFlat;
+
+   /* A single chunk is already contiguous. */
+   if (DynArray_getLength(oRope->oChunks) == 1)
+   {
+      oRope->pcFlat = DynArray_get(oRope->oChunks, 0);
+      return oRope->pcFlat;
+   }
+
+   oRope->pcFlat = Rope_toBuffer(oRope);
+   return oRope->pcFlat;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *Rope_toBuffer(Rope_T oRope)
+{
+   void *pvBuf;
+
+   assert(oRope != NULL);
+   assert(Rope_isValid(oRope));
+
+   if (oRope->uLength == 0)
+      return NULL;
+
+   pvBuf = malloc(oRope->uLength);
+   if (pvBuf == NULL)
+      return NULL;
+
+   (void)Rope_read(oRope, 0, oRope->uLength, pvBuf);
+   return pvBuf;
+}
@@ -0,0 +1,85 @@
+/*--------------------------------------------------------------------*/
+/* rope.h                                                             */
+/* Author: Alina Chen and Nickolas Casalinuovo                        */
+/*--------------------------------------------------------------------*/
+
+#ifndef ROPE_INCLUDED
+#define ROPE_INCLUDED
+
+#include <stddef.h>
+
+/* A Rope_T object is a byte sequence stored as a table of fixed-size
+   chunks, so that reading or overwriting a range touches only the
+   chunks that hold it and appending never moves existing bytes. */
+
+typedef struct Rope *Rope_T;
+
+/*--------------------------------------------------------------------*/
+
+/* Return a new Rope_T object holding a copy of the uLength bytes at
+   pvData, or NULL if insufficient memory is available.  If pvData is
+   NULL, the rope holds uLength zero bytes. */
+
+Rope_T Rope_new(const void *pvData, size_t uLength);
+
+/*--------------------------------------------------------------------*/
+
+/* Free oRope. */
+
+void Rope_free(Rope_T oRope);
+
+/*--------------------------------------------------------------------*/
+
+/* Return the number of bytes in oRope. */
+
+size_t Rope_getLength(Rope_T oRope);
+
+/*--------------------------------------------------------------------*/
+
+/* Return the number of bytes of memory that oRope holds: its
+   chunks, including the unused end of the last one, its cached
+   contiguous copy, and its own structure and table of chunks (the
+   table counted at its length rather than its capacity). */
+
+size_t Rope_getBytes(Rope_T oRope);
+
+/*--------------------------------------------------------------------*/
+
+/* Copy at most uLength bytes of oRope, starting at uOffset, into
+   pvBuf.  Return the number of bytes copied, which is less than
+   uLength if the range extends past the end of oRope. */
+
+size_t Rope_read(Rope_T oRope, size_t uOffset, size_t uLength,
+                 void *pvBuf);
+
+/*--------------------------------------------------------------------*/
+
+/* Overwrite uLength bytes of oRope, starting at uOffset, with the
+   bytes at pvData (or with zero bytes if pvData is NULL), extending
+   oRope if the range reaches past its end.  If uOffset is past the
+   end of oRope, the gap is filled with zero bytes; if uLength is 0,
+   oRope is left unchanged.  Return 1 (TRUE) if successful, or 0
+   (FALSE) if insufficient memory is available, in which case oRope
+   is unchanged. */
+
+int Rope_write(Rope_T oRope, size_t uOffset, const void *pvData,
+               size_t uLength);
+
+/*--------------------------------------------------------------------*/
+
+/* Return a pointer to the contents of oRope as one contiguous block,
+   or NULL if oRope is empty or insufficient memory is available.
+   The block is owned by oRope and remains valid until oRope is next
+   written or freed. */
+
+const void *Rope_flatten(Rope_T oRope);
+
+/*--------------------------------------------------------------------*/
+
+/* Return a newly allocated copy of the contents of oRope, which is
+   then owned by the caller, or NULL if oRope is empty or insufficient
+   memory is available. */
+
+void *Rope_toBuffer(Rope_T oRope);
+
+#endif
@@ -0,0 +1,204 @@
+/*--------------------------------------------------------------------*/
+/* searchbench.c                                                      */
+/* Author: Alina Chen and Nickolas Casalinuovo                        */
+/*--------------------------------------------------------------------*/
+
+/* for clock_gettime */
+#define _POSIX_C_SOURCE 199309L
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "dynarray.h"
+#include "typedarray.h"
+
+/* Times binary searches of the children of a directory, held as the
+   node layer holds them: sorted by path, looked up by final path
+   component.  For 8, 64, 1k and 100k children, compares
+   DynArray_bsearch, which calls its comparison through a function
+   pointer, with the bsearch of a typed array (see typedarray.h),
+   which inlines it.  Prints ns per probe to stdout. */
+
+/*--------------------------------------------------------------------*/
+
+/* The number of searches timed for each size and array, of children
+   chosen at random. */
+
+enum { PROBES = 2000000 };
+
+/* The path of the parent directory of every child. */
+
+static const char PARENT[] = "root/some/directory";
+
+/*--------------------------------------------------------------------*/
+
+/* A child: only its path matters to the search. */
+
+struct Child
+{
+   char *pcPath;
+};
+
+typedef struct Child *Child_T;
+
+/* A name sought among the children: the final path component, and
+   the length of the parent's path before it. */
+
+struct Name
+{
+   const char *pcName;
+   size_t uPrefixLen;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Return <0, 0, or >0 depending upon whether the path of child
+   pvChild1 is less than, equal to, or greater than that of
+   pvChild2.  Called through a function pointer by DynArray_bsearch,
+   so the sought child must be a whole Child. */
+
+static int compareChildren(const void *pvChild1, const void *pvChild2)
+{
+   assert(pvChild1 != NULL);
+   assert(pvChild2 != NULL);
+
+   return strcmp(((const struct Child*)pvChild1)->pcPath,
+                 ((const struct Child*)pvChild2)->pcPath);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return <0, 0, or >0 depending upon whether psName is less than,
+   equal to, or greater than the final component of oChild's path. */
+
+static inline int compareName(const struct Name *psName,
+                              Child_T oChild)
+{
+   return strcmp(psName->pcName,
+                 oChild->pcPath + psName->uPrefixLen + 1);
+}
+
+/* Return <0, 0, or >0 as compareChildren does. */
+
+static inline int compareTyped(Child_T oChild1, Child_T oChild2)
+{
+   return strcmp(oChild1->pcPath, oChild2->pcPath);
+}
+
+TYPEDARRAY_DEFINE(ChildArray, Child_T)
+TYPEDARRAY_DEFINE_ORDER(ChildArray, Child_T, const struct Name*,
+                        compareName, compareTyped)
+
+/*--------------------------------------------------------------------*/
+
+/* Return the current time in seconds. */
+
+static double now(void)
+{
+   struct timespec sTime;
+
+   (void)clock_gettime(CLOCK_MONOTONIC, &sTime);
+   return (double)sTime.tv_sec + (double)sTime.tv_nsec / 1e9;
+}
+
+/*--------------------------------------------------------------------*/
+
+int main(void)
+{
+   static const size_t auSizes[] = { 8, 64, 1000, 100000 };
+   size_t uSize;
+   size_t u;
+   size_t uProbe;
+   size_t uIndex;
+   size_t uFound;
+   struct Child *psChildren;
+   struct Name sName;
+   char **ppcNames;
+   size_t *puProbes;
+   DynArray_T oDynArray;
+   ChildArray_T oChildArray;
+   double dStart;
+   double dGeneric;
+   double dTyped;
+
+   printf("%10s %12s %12s %8s\n",
+          "children", "dynarray ns", "typed ns", "speedup");
+
+   for (u = 0; u < sizeof(auSizes) / sizeof(auSizes[0]); u++)
+   {
+      uSize = auSizes[u];
+      psChildren = (struct Child*)calloc(uSize, sizeof(struct Child));
+      ppcNames = (char**)calloc(uSize, sizeof(char*));
+      oDynArray = DynArray_new(0);
+      oChildArray = ChildArray_new(0);
+      puProbes = (size_t*)malloc(PROBES * sizeof(size_t));
+      if (psChildren == NULL || ppcNames == NULL || oDynArray == NULL
+          || oChildArray == NULL || puProbes == NULL)
+      {
+         fprintf(stderr, "searchbench: out of memory\n");
+         return EXIT_FAILURE;
+      }
+
+      for (uIndex = 0; uIndex < uSize; uIndex++)
+      {
+         psChildren[uIndex].pcPath =
+            (char*)malloc(sizeof(PARENT) + 32);
+         if (psChildren[uIndex].pcPath == NULL)
+         {
+            fprintf(stderr, "searchbench: out of memory\n");
+            return EXIT_FAILURE;
+         }
+         sprintf(psChildren[uIndex].pcPath, "%s/file%07lu", PARENT,
+                 (unsigned long)uIndex);
+         ppcNames[uIndex] = psChildren[uIndex].pcPath + sizeof(PARENT);
+         (void)DynArray_add(oDynArray, &psChildren[uIndex]);
+         (void)ChildArray_add(oChildArray, &psChildren[uIndex]);
+      }
+
+      for (uProbe = 0; uProbe < PROBES; uProbe++)
+         puProbes[uProbe] = (size_t)rand() % uSize;
+
+      /* DynArray_bsearch is given a whole child holding the path
+         sought, as the node layer gave it. */
+      uFound = 0;
+      dStart = now();
+      for (uProbe = 0; uProbe < PROBES; uProbe++)
+         uFound += (size_t)DynArray_bsearch(
+            oDynArray, &psChildren[puProbes[uProbe]], &uIndex,
+            compareChildren);
+      dGeneric = now() - dStart;
+
+      /* The typed array is given only the name. */
+      sName.uPrefixLen = sizeof(PARENT) - 1;
+      dStart = now();
+      for (uProbe = 0; uProbe < PROBES; uProbe++)
+      {
+         sName.pcName = ppcNames[puProbes[uProbe]];
+         uFound += (size_t)ChildArray_bsearch(oChildArray, &sName,
+                                              &uIndex);
+      }
+      dTyped = now() - dStart;
+
+      if (uFound != 2 * PROBES)
+      {
+         fprintf(stderr, "searchbench: a search failed\n");
+         return EXIT_FAILURE;
+      }
+
+      printf("%10lu %12.1f %12.1f %8.2f\n", (unsigned long)uSize,
+             dGeneric * 1e9 / PROBES, dTyped * 1e9 / PROBES,
+             dGeneric / dTyped);
+
+      for (uIndex = 0; uIndex < uSize; uIndex++)
+         free(psChildren[uIndex].pcPath);
+      free(puProbes);
+      free(psChildren);
+      free(ppcNames);
+      DynArray_free(oDynArray);
+      ChildArray_free(oChildArray);
+   }
+
+   return 0;
+}
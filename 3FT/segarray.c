@@ -0,0 +1,501 @@
+/*--------------------------------------------------------------------*/
+/* segarray.c                                                         */
+/* Author: Alina Chen and Nickolas Casalinuovo                        */
+/*--------------------------------------------------------------------*/
+
+#include "segarray.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*--------------------------------------------------------------------*/
+
+/* The number of elements a chunk can hold: large enough that the
+   index of chunks stays small, small enough that shifting within a
+   chunk is cheap. */
+
+enum { CHUNK_LENGTH = 512 };
+
+/* The minimum number of entries in the index of chunks. */
+
+enum { MIN_INDEX_LENGTH = 4 };
+
+/*--------------------------------------------------------------------*/
+
+/* A chunk of a SegArray: its elements are apvElements[0...uCount-1]. */
+
+struct SegChunk
+{
+   /* The number of elements in the chunk, at least 1. */
+   size_t uCount;
+
+   /* The elements. */
+   const void *apvElements[CHUNK_LENGTH];
+};
+
+/* A SegArray consists of an index of chunks, in order, along with
+   the index of each chunk's first element and its length. */
+
+struct SegArray
+{
+   /* The number of elements in the SegArray. */
+   size_t uLength;
+
+   /* The number of chunks. */
+   size_t uChunks;
+
+   /* The number of entries the index arrays can hold. */
+   size_t uIndexLength;
+
+   /* The chunks. */
+   struct SegChunk **ppsChunks;
+
+   /* puStarts[i] is the index of the first element of ppsChunks[i]. */
+   size_t *puStarts;
+
+   /* The chunk that held the element last located, as a hint for the
+      next. */
+   size_t uLastChunk;
+};
+
+/*--------------------------------------------------------------------*/
+
+#ifndef NDEBUG
+
+/* Check the invariants of oSegArray.  Return 1 (TRUE) iff oSegArray
+   is in a valid state.  Checks every chunk, so is used sparingly. */
+
+static int SegArray_isValid(SegArray_T oSegArray)
+{
+   size_t u;
+   size_t uStart = 0;
+
+   if (oSegArray->uChunks > oSegArray->uIndexLength) return 0;
+   if (oSegArray->ppsChunks == NULL) return 0;
+   if (oSegArray->puStarts == NULL) return 0;
+   for (u = 0; u < oSegArray->uChunks; u++)
+   {
+      if (oSegArray->puStarts[u] != uStart) return 0;
+      if (oSegArray->ppsChunks[u]->uCount == 0) return 0;
+      if (oSegArray->ppsChunks[u]->uCount > CHUNK_LENGTH) return 0;
+      uStart += oSegArray->ppsChunks[u]->uCount;
+   }
+   if (uStart != oSegArray->uLength) return 0;
+   return 1;
+}
+
+#endif
+
+/*--------------------------------------------------------------------*/
+
+/* Return the index of the chunk of oSegArray that holds its uIndex'th
+   element.  uIndex must be less than the length of oSegArray. */
+
+static size_t SegArray_locate(SegArray_T oSegArray, size_t uIndex)
+{
+   size_t uLo;
+   size_t uHi;
+   size_t uMid;
+   size_t uChunk;
+
+   assert(oSegArray != NULL);
+   assert(uIndex < oSegArray->uLength);
+
+   uChunk = oSegArray->uLastChunk;
+   if (uChunk < oSegArray->uChunks
+       && uIndex >= oSegArray->puStarts[uChunk]
+       && uIndex - oSegArray->puStarts[uChunk]
+          < oSegArray->ppsChunks[uChunk]->uCount)
+      return uChunk;
+
+   /* Find the last chunk that starts at or before uIndex. */
+   uLo = 0;
+   uHi = oSegArray->uChunks - 1;
+   while (uLo < uHi)
+   {
+      uMid = uLo + (uHi - uLo + 1) / 2;
+      if (oSegArray->puStarts[uMid] <= uIndex)
+         uLo = uMid;
+      else
+         uHi = uMid - 1;
+   }
+   oSegArray->uLastChunk = uLo;
+   return uLo;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Insert a new empty chunk into oSegArray's index at uChunk, starting
+   at element uStart.  Return it, or NULL if insufficient memory is
+   available. */
+
+static struct SegChunk *SegArray_insertChunk(SegArray_T oSegArray,
+                                             size_t uChunk,
+                                             size_t uStart)
+{
+   struct SegChunk *psChunk;
+   struct SegChunk **ppsNewChunks;
+   size_t *puNewStarts;
+   size_t uNewLength;
+
+   assert(oSegArray != NULL);
+   assert(uChunk <= oSegArray->uChunks);
+
+   if (oSegArray->uChunks == oSegArray->uIndexLength)
+   {
+      /* Only the index grows, never the chunks. */
+      uNewLength = 2 * oSegArray->uIndexLength;
+      ppsNewChunks = (struct SegChunk**)realloc(
+         oSegArray->ppsChunks, sizeof(struct SegChunk*) * uNewLength);
+      if (ppsNewChunks == NULL)
+         return NULL;
+      oSegArray->ppsChunks = ppsNewChunks;
+      puNewStarts = (size_t*)realloc(
+         oSegArray->puStarts, sizeof(size_t) * uNewLength);
+      if (puNewStarts == NULL)
+         return NULL;
+      oSegArray->puStarts = puNewStarts;
+      oSegArray->uIndexLength = uNewLength;
+   }
+
+   psChunk = (struct SegChunk*)malloc(sizeof(struct SegChunk));
+   if (psChunk == NULL)
+      return NULL;
+   psChunk->uCount = 0;
+
+   memmove(&oSegArray->ppsChunks[uChunk + 1],
+           &oSegArray->ppsChunks[uChunk],
+           sizeof(struct SegChunk*) * (oSegArray->uChunks - uChunk));
+   memmove(&oSegArray->puStarts[uChunk + 1],
+           &oSegArray->puStarts[uChunk],
+           sizeof(size_t) * (oSegArray->uChunks - uChunk));
+   oSegArray->ppsChunks[uChunk] = psChunk;
+   oSegArray->puStarts[uChunk] = uStart;
+   oSegArray->uChunks++;
+   return psChunk;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Remove the chunk at uChunk, which must be empty, from oSegArray. */
+
+static void SegArray_removeChunk(SegArray_T oSegArray, size_t uChunk)
+{
+   assert(oSegArray != NULL);
+   assert(uChunk < oSegArray->uChunks);
+   assert(oSegArray->ppsChunks[uChunk]->uCount == 0);
+
+   free(oSegArray->ppsChunks[uChunk]);
+   memmove(&oSegArray->ppsChunks[uChunk],
+           &oSegArray->ppsChunks[uChunk + 1],
+           sizeof(struct SegChunk*)
+           * (oSegArray->uChunks - uChunk - 1));
+   memmove(&oSegArray->puStarts[uChunk],
+           &oSegArray->puStarts[uChunk + 1],
+           sizeof(size_t) * (oSegArray->uChunks - uChunk - 1));
+   oSegArray->uChunks--;
+}
+
+/*--------------------------------------------------------------------*/
+
+SegArray_T SegArray_new(size_t uLength)
+{
+   SegArray_T oSegArray;
+   struct SegChunk *psChunk;
+   size_t uCount;
+
+   oSegArray = (struct SegArray*)malloc(sizeof(struct SegArray));
+   if (oSegArray == NULL)
+      return NULL;
+
+   oSegArray->uLength = 0;
+   oSegArray->uChunks = 0;
+   oSegArray->uIndexLength = MIN_INDEX_LENGTH;
+   oSegArray->uLastChunk = 0;
+   while (oSegArray->uIndexLength * CHUNK_LENGTH < uLength)
+      oSegArray->uIndexLength *= 2;
+   oSegArray->ppsChunks = (struct SegChunk**)
+      malloc(sizeof(struct SegChunk*) * oSegArray->uIndexLength);
+   oSegArray->puStarts = (size_t*)
+      malloc(sizeof(size_t) * oSegArray->uIndexLength);
+   if (oSegArray->ppsChunks == NULL || oSegArray->puStarts == NULL)
+   {
+      SegArray_free(oSegArray);
+      return NULL;
+   }
+
+   /* Make full chunks of NULL elements. */
+   while (oSegArray->uLength < uLength)
+   {
+      psChunk = SegArray_insertChunk(oSegArray, oSegArray->uChunks,
+                                     oSegArray->uLength);
+      if (psChunk == NULL)
+      {
+         SegArray_free(oSegArray);
+         return NULL;
+      }
+      uCount = uLength - oSegArray->uLength;
+      if (uCount > CHUNK_LENGTH)
+         uCount = CHUNK_LENGTH;
+      memset(psChunk->apvElements, 0, sizeof(void*) * uCount);
+      psChunk->uCount = uCount;
+      oSegArray->uLength += uCount;
+   }
+
+   assert(SegArray_isValid(oSegArray));
+
+   return oSegArray;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SegArray_free(SegArray_T oSegArray)
+{
+   size_t u;
+
+   assert(oSegArray != NULL);
+
+   if (oSegArray->ppsChunks != NULL)
+      for (u = 0; u < oSegArray->uChunks; u++)
+         free(oSegArray->ppsChunks[u]);
+   free(oSegArray->ppsChunks);
+   free(oSegArray->puStarts);
+   free(oSegArray);
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SegArray_getLength(SegArray_T oSegArray)
+{
+   assert(oSegArray != NULL);
+
+   return oSegArray->uLength;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SegArray_get(SegArray_T oSegArray, size_t uIndex)
+{
+   size_t uChunk;
+
+   assert(oSegArray != NULL);
+   assert(uIndex < oSegArray->uLength);
+
+   uChunk = SegArray_locate(oSegArray, uIndex);
+   return (void*)oSegArray->ppsChunks[uChunk]->apvElements[
+      uIndex - oSegArray->puStarts[uChunk]];
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SegArray_set(SegArray_T oSegArray, size_t uIndex,
+                   const void *pvElement)
+{
+   size_t uChunk;
+   const void **ppvSlot;
+   const void *pvOldElement;
+
+   assert(oSegArray != NULL);
+   assert(uIndex < oSegArray->uLength);
+
+   uChunk = SegArray_locate(oSegArray, uIndex);
+   ppvSlot = &oSegArray->ppsChunks[uChunk]->apvElements[
+      uIndex - oSegArray->puStarts[uChunk]];
+   pvOldElement = *ppvSlot;
+   *ppvSlot = pvElement;
+   return (void*)pvOldElement;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SegArray_add(SegArray_T oSegArray, const void *pvElement)
+{
+   assert(oSegArray != NULL);
+
+   return SegArray_addAt(oSegArray, oSegArray->uLength, pvElement);
+}
+
+/*--------------------------------------------------------------------*/
+
+int SegArray_addAt(SegArray_T oSegArray, size_t uIndex,
+                   const void *pvElement)
+{
+   size_t uChunk;
+   size_t uOffset;
+   size_t u;
+   struct SegChunk *psChunk;
+   struct SegChunk *psNext;
+
+   assert(oSegArray != NULL);
+   assert(uIndex <= oSegArray->uLength);
+
+   /* Find the chunk and offset at which to insert.  An index between
+      two chunks goes at the end of the first. */
+   if (oSegArray->uChunks == 0)
+   {
+      if (SegArray_insertChunk(oSegArray, 0, 0) == NULL)
+         return 0;
+      uChunk = 0;
+   }
+   else if (uIndex == oSegArray->uLength)
+      uChunk = oSegArray->uChunks - 1;
+   else
+   {
+      uChunk = SegArray_locate(oSegArray, uIndex);
+      if (uIndex == oSegArray->puStarts[uChunk] && uChunk > 0)
+         uChunk--;
+   }
+   psChunk = oSegArray->ppsChunks[uChunk];
+   uOffset = uIndex - oSegArray->puStarts[uChunk];
+
+   if (psChunk->uCount == CHUNK_LENGTH)
+   {
+      if (uOffset == CHUNK_LENGTH)
+      {
+         /* Start a new chunk rather than split a full one, so that
+            adding at the end leaves full chunks behind. */
+         psNext = SegArray_insertChunk(oSegArray, uChunk + 1, uIndex);
+         if (psNext == NULL)
+            return 0;
+         uChunk++;
+         psChunk = psNext;
+         uOffset = 0;
+      }
+      else
+      {
+         /* Split the chunk in two halves. */
+         psNext = SegArray_insertChunk(
+            oSegArray, uChunk + 1,
+            oSegArray->puStarts[uChunk] + CHUNK_LENGTH / 2);
+         if (psNext == NULL)
+            return 0;
+         memcpy(psNext->apvElements,
+                &psChunk->apvElements[CHUNK_LENGTH / 2],
+                sizeof(void*) * (CHUNK_LENGTH - CHUNK_LENGTH / 2));
+         psNext->uCount = CHUNK_LENGTH - CHUNK_LENGTH / 2;
+         psChunk->uCount = CHUNK_LENGTH / 2;
+         if (uOffset > CHUNK_LENGTH / 2)
+         {
+            uChunk++;
+            psChunk = psNext;
+            uOffset -= CHUNK_LENGTH / 2;
+         }
+      }
+   }
+
+   memmove(&psChunk->apvElements[uOffset + 1],
+           &psChunk->apvElements[uOffset],
+           sizeof(void*) * (psChunk->uCount - uOffset));
+   psChunk->apvElements[uOffset] = pvElement;
+   psChunk->uCount++;
+   for (u = uChunk + 1; u < oSegArray->uChunks; u++)
+      oSegArray->puStarts[u]++;
+   oSegArray->uLength++;
+
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *SegArray_removeAt(SegArray_T oSegArray, size_t uIndex)
+{
+   size_t uChunk;
+   size_t uOffset;
+   size_t u;
+   struct SegChunk *psChunk;
+   const void *pvOldElement;
+
+   assert(oSegArray != NULL);
+   assert(uIndex < oSegArray->uLength);
+
+   uChunk = SegArray_locate(oSegArray, uIndex);
+   psChunk = oSegArray->ppsChunks[uChunk];
+   uOffset = uIndex - oSegArray->puStarts[uChunk];
+
+   pvOldElement = psChunk->apvElements[uOffset];
+   memmove(&psChunk->apvElements[uOffset],
+           &psChunk->apvElements[uOffset + 1],
+           sizeof(void*) * (psChunk->uCount - uOffset - 1));
+   psChunk->uCount--;
+   for (u = uChunk + 1; u < oSegArray->uChunks; u++)
+      oSegArray->puStarts[u]--;
+   if (psChunk->uCount == 0)
+      SegArray_removeChunk(oSegArray, uChunk);
+   oSegArray->uLength--;
+
+   return (void*)pvOldElement;
+}
+
+/*--------------------------------------------------------------------*/
+
+int SegArray_bsearch(SegArray_T oSegArray,
+                     void *pvSoughtElement,
+                     size_t *puIndex,
+                     int (*pfCompare)(const void *pvElement1,
+                                      const void *pvElement2))
+{
+   size_t uLo;
+   size_t uHi;
+   size_t uMid;
+   int iCompare;
+   struct SegChunk *psChunk;
+
+   assert(oSegArray != NULL);
+   assert(puIndex != NULL);
+   assert(pfCompare != NULL);
+
+   /* Find the first chunk whose last element is not less than the
+      sought element. */
+   uLo = 0;
+   uHi = oSegArray->uChunks;
+   while (uLo < uHi)
+   {
+      uMid = uLo + (uHi - uLo) / 2;
+      psChunk = oSegArray->ppsChunks[uMid];
+      if ((*pfCompare)(psChunk->apvElements[psChunk->uCount - 1],
+                       pvSoughtElement) < 0)
+         uLo = uMid + 1;
+      else
+         uHi = uMid;
+   }
+   if (uLo == oSegArray->uChunks)
+   {
+      *puIndex = oSegArray->uLength;
+      return 0;
+   }
+
+   /* Search within it. */
+   psChunk = oSegArray->ppsChunks[uLo];
+   *puIndex = oSegArray->puStarts[uLo];
+   uLo = 0;
+   uHi = psChunk->uCount;
+   while (uLo < uHi)
+   {
+      uMid = uLo + (uHi - uLo) / 2;
+      iCompare = (*pfCompare)(pvSoughtElement,
+                              psChunk->apvElements[uMid]);
+      if (iCompare == 0)
+      {
+         *puIndex += uMid;
+         return 1;
+      }
+      if (iCompare < 0)
+         uHi = uMid;
+      else
+         uLo = uMid + 1;
+   }
+   *puIndex += uLo;
+   return 0;
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SegArray_getBytes(SegArray_T oSegArray)
+{
+   assert(oSegArray != NULL);
+
+   return sizeof(struct SegArray)
+      + oSegArray->uIndexLength
+        * (sizeof(struct SegChunk*) + sizeof(size_t))
+      + oSegArray->uChunks * sizeof(struct SegChunk);
+}
@@ -0,0 +1,100 @@
+/*--------------------------------------------------------------------*/
+/* segarray.h                                                         */
+/* Author: Alina Chen and Nickolas Casalinuovo                        */
+/*--------------------------------------------------------------------*/
+
+#ifndef SEGARRAY_INCLUDED
+#define SEGARRAY_INCLUDED
+
+#include <stddef.h>
+
+/* A SegArray_T object is an array whose length can expand
+   dynamically, as a DynArray_T is, but which is stored as a sequence
+   of fixed-size chunks rather than one contiguous block.  Growing it
+   never copies existing elements, and adding or removing an element
+   in the middle moves elements within one chunk only.  Chunks may be
+   partly full, so finding an element by index takes a binary search
+   of the chunks; consecutive accesses within a chunk skip it. */
+
+typedef struct SegArray *SegArray_T;
+
+/*--------------------------------------------------------------------*/
+
+/* Return a new SegArray_T object whose length is uLength, each of
+   whose elements is NULL, or NULL if insufficient memory is
+   available. */
+
+SegArray_T SegArray_new(size_t uLength);
+
+/*--------------------------------------------------------------------*/
+
+/* Free oSegArray. */
+
+void SegArray_free(SegArray_T oSegArray);
+
+/*--------------------------------------------------------------------*/
+
+/* Return the length of oSegArray. */
+
+size_t SegArray_getLength(SegArray_T oSegArray);
+
+/*--------------------------------------------------------------------*/
+
+/* Return the uIndex'th element of oSegArray. */
+
+void *SegArray_get(SegArray_T oSegArray, size_t uIndex);
+
+/*--------------------------------------------------------------------*/
+
+/* Assign pvElement to the uIndex'th element of oSegArray.  Return the
+   old element. */
+
+void *SegArray_set(SegArray_T oSegArray, size_t uIndex,
+                   const void *pvElement);
+
+/*--------------------------------------------------------------------*/
+
+/* Add pvElement to the end of oSegArray, thus incrementing its
+   length.  Return 1 (TRUE) if successful, or 0 (FALSE) if
+   insufficient memory is available. */
+
+int SegArray_add(SegArray_T oSegArray, const void *pvElement);
+
+/*--------------------------------------------------------------------*/
+
+/* Add pvElement to oSegArray such that it is the uIndex'th element.
+   Return 1 (TRUE) if successful, or 0 (FALSE) if insufficient memory
+   is available. */
+
+int SegArray_addAt(SegArray_T oSegArray, size_t uIndex,
+                   const void *pvElement);
+
+/*--------------------------------------------------------------------*/
+
+/* Remove and return the uIndex'th element of oSegArray. */
+
+void *SegArray_removeAt(SegArray_T oSegArray, size_t uIndex);
+
+/*--------------------------------------------------------------------*/
+
+/* Binary search oSegArray for *pvSoughtElement using *pfCompare to
+   determine equality.  If the element is found, then assign its
+   index to *puIndex and return 1.  If the element is not found, then
+   assign the index where it would belong to *puIndex and return 0.
+   *pfCompare must return <0, 0, or >0 if *pvElement1 is less than,
+   equal to, or greater than *pvElement2.
+   oSegArray must be sorted as determined by *pfCompare. */
+
+int SegArray_bsearch(SegArray_T oSegArray,
+                     void *pvSoughtElement,
+                     size_t *puIndex,
+                     int (*pfCompare)(const void *pvElement1,
+                                      const void *pvElement2));
+
+/*--------------------------------------------------------------------*/
+
+/* Return the number of bytes of memory used by oSegArray. */
+
+size_t SegArray_getBytes(SegArray_T oSegArray);
+
+#endif
@@ -0,0 +1,182 @@
+/*--------------------------------------------------------------------*/
+/* segbench.c                                                         */
+/* Author: Alina Chen and Nickolas Casalinuovo                        */
+/*--------------------------------------------------------------------*/
+
+/* for clock_gettime */
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "dynarray.h"
+#include "segarray.h"
+
+/* Times each insert into a DynArray_T and into a SegArray_T, and
+   prints the latency distribution of each to stdout: first adding
+   elements at the end (10M unless given as the first command-line
+   argument), then adding elements in sorted order at positions found
+   by binary search, as a directory's children are added (200k unless
+   given as the second). */
+
+/*--------------------------------------------------------------------*/
+
+/* Return the current time in nanoseconds. */
+
+static unsigned long now(void)
+{
+   struct timespec sTime;
+
+   (void)clock_gettime(CLOCK_MONOTONIC, &sTime);
+   return (unsigned long)sTime.tv_sec * 1000000000UL
+      + (unsigned long)sTime.tv_nsec;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return <0, 0, or >0 depending upon whether pvElement1 is less than,
+   equal to, or greater than pvElement2, as addresses. */
+
+static int compareAddresses(const void *pvElement1,
+                            const void *pvElement2)
+{
+   return (pvElement1 > pvElement2) - (pvElement1 < pvElement2);
+}
+
+/* Return <0, 0, or >0 depending upon whether the latency at
+   pvLatency1 is less than, equal to, or greater than that at
+   pvLatency2.  For qsort. */
+
+static int compareLatencies(const void *pvLatency1,
+                            const void *pvLatency2)
+{
+   unsigned long ul1 = *(const unsigned long*)pvLatency1;
+   unsigned long ul2 = *(const unsigned long*)pvLatency2;
+
+   return (ul1 > ul2) - (ul1 < ul2);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Sort the uCount latencies at pulLatencies and print their
+   distribution, labelled with pcArray and pcWork. */
+
+static void report(const char *pcArray, const char *pcWork,
+                   unsigned long *pulLatencies, size_t uCount)
+{
+   unsigned long ulTotal = 0;
+   size_t u;
+
+   for (u = 0; u < uCount; u++)
+      ulTotal += pulLatencies[u];
+   qsort(pulLatencies, uCount, sizeof(unsigned long),
+         compareLatencies);
+
+   printf("%-8s %-7s %9lu %8lu %8lu %8lu %10lu %9.3f\n", pcArray,
+          pcWork, (unsigned long)uCount, pulLatencies[uCount / 2],
+          pulLatencies[uCount / 100 * 99],
+          pulLatencies[uCount / 1000 * 999], pulLatencies[uCount - 1],
+          (double)ulTotal / 1e9);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the uIndex'th key of a pseudo-random sequence of distinct
+   non-NULL keys. */
+
+static void *key(size_t uIndex)
+{
+   return (void*)(((uIndex * 2654435761UL) % 4294967291UL + 1) * 8);
+}
+
+/*--------------------------------------------------------------------*/
+
+int main(int argc, char *argv[])
+{
+   size_t uAppends = 10000000;
+   size_t uSorted = 200000;
+   size_t u;
+   size_t uIndex;
+   unsigned long *pulLatencies;
+   unsigned long ulStart;
+   DynArray_T oDynArray;
+   SegArray_T oSegArray;
+
+   if (argc > 1)
+      uAppends = (size_t)strtoul(argv[1], NULL, 10);
+   if (argc > 2)
+      uSorted = (size_t)strtoul(argv[2], NULL, 10);
+
+   pulLatencies = (unsigned long*)malloc(sizeof(unsigned long)
+      * (uAppends > uSorted ? uAppends : uSorted));
+   oDynArray = DynArray_new(0);
+   oSegArray = SegArray_new(0);
+   if (pulLatencies == NULL || oDynArray == NULL || oSegArray == NULL)
+   {
+      fprintf(stderr, "segbench: out of memory\n");
+      return EXIT_FAILURE;
+   }
+
+   printf("%-8s %-7s %9s %8s %8s %8s %10s %9s\n", "array", "inserts",
+          "count", "p50 ns", "p99 ns", "p99.9 ns", "max ns",
+          "total s");
+
+   for (u = 0; u < uAppends; u++)
+   {
+      ulStart = now();
+      if (! DynArray_add(oDynArray, key(u)))
+         return EXIT_FAILURE;
+      pulLatencies[u] = now() - ulStart;
+   }
+   report("dynarray", "append", pulLatencies, uAppends);
+   DynArray_free(oDynArray);
+
+   for (u = 0; u < uAppends; u++)
+   {
+      ulStart = now();
+      if (! SegArray_add(oSegArray, key(u)))
+         return EXIT_FAILURE;
+      pulLatencies[u] = now() - ulStart;
+   }
+   report("segarray", "append", pulLatencies, uAppends);
+   SegArray_free(oSegArray);
+
+   oDynArray = DynArray_new(0);
+   oSegArray = SegArray_new(0);
+   if (oDynArray == NULL || oSegArray == NULL)
+      return EXIT_FAILURE;
+
+   for (u = 0; u < uSorted; u++)
+   {
+      ulStart = now();
+      (void)DynArray_bsearch(oDynArray, key(u), &uIndex,
+                             compareAddresses);
+      if (! DynArray_addAt(oDynArray, uIndex, key(u)))
+         return EXIT_FAILURE;
+      pulLatencies[u] = now() - ulStart;
+   }
+   report("dynarray", "sorted", pulLatencies, uSorted);
+
+   for (u = 0; u < uSorted; u++)
+   {
+      ulStart = now();
+      (void)SegArray_bsearch(oSegArray, key(u), &uIndex,
+                             compareAddresses);
+      if (! SegArray_addAt(oSegArray, uIndex, key(u)))
+         return EXIT_FAILURE;
+      pulLatencies[u] = now() - ulStart;
+   }
+   report("segarray", "sorted", pulLatencies, uSorted);
+
+   for (u = 0; u < uSorted; u++)
+      if (DynArray_get(oDynArray, u) != SegArray_get(oSegArray, u))
+      {
+         fprintf(stderr, "segbench: arrays differ\n");
+         return EXIT_FAILURE;
+      }
+
+   DynArray_free(oDynArray);
+   SegArray_free(oSegArray);
+   free(pulLatencies);
+   return 0;
+}
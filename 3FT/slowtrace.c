@@ -0,0 +1,280 @@
+/*--------------------------------------------------------------------*/
+/* slowtrace.c                                                        */
+/* Author: Alina Chen and Nickolas Casalinuovo                        */
+/*--------------------------------------------------------------------*/
+
+/* for pthreads */
+#define _POSIX_C_SOURCE 200112L
+
+#include "slowtrace.h"
+#include <assert.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*--------------------------------------------------------------------*/
+
+/* The most bytes of a path kept, including its terminating '\0'. */
+
+enum { PATH_KEPT = 96 };
+
+/*--------------------------------------------------------------------*/
+
+/* A call kept by a SlowTrace. */
+
+struct SlowTraceEntry
+{
+   /* The call.  Entries move within the heap, so sEvent.path is not
+      followed: it is NULL if the call had no path, and otherwise
+      acPath holds the path. */
+   struct FT_TraceEvent sEvent;
+
+   /* How long the call took, in nanoseconds. */
+   uint64_t uNanos;
+
+   /* A copy of the call's path, cut short if it is too long. */
+   char acPath[PATH_KEPT];
+};
+
+/* A SlowTrace consists of a min-heap of the slowest calls shown to it
+   by duration, so that its fastest entry, the next to be replaced, is
+   at the top. */
+
+struct SlowTrace
+{
+   /* The lock held while recording or reading the entries. */
+   pthread_mutex_t sLock;
+
+   /* The number of entries held. */
+   size_t uLength;
+
+   /* The most entries held. */
+   size_t uCapacity;
+
+   /* The uCapacity entries, the first uLength of them in use. */
+   struct SlowTraceEntry *psEntries;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Swap the entries psOne and psTwo. */
+
+static void SlowTrace_swap(struct SlowTraceEntry *psOne,
+                           struct SlowTraceEntry *psTwo)
+{
+   struct SlowTraceEntry sTemp;
+
+   assert(psOne != NULL);
+   assert(psTwo != NULL);
+
+   sTemp = *psOne;
+   *psOne = *psTwo;
+   *psTwo = sTemp;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Restore the heap order of oSlowTrace's entries by moving the entry
+   at uAt, which may be faster than its children, down. */
+
+static void SlowTrace_siftDown(SlowTrace_T oSlowTrace, size_t uAt)
+{
+   struct SlowTraceEntry *psEntries;
+   size_t uChild;
+
+   assert(oSlowTrace != NULL);
+
+   psEntries = oSlowTrace->psEntries;
+   for (;;)
+   {
+      uChild = 2 * uAt + 1;
+      if (uChild >= oSlowTrace->uLength)
+         return;
+      if (uChild + 1 < oSlowTrace->uLength
+          && psEntries[uChild + 1].uNanos < psEntries[uChild].uNanos)
+         uChild++;
+      if (psEntries[uAt].uNanos <= psEntries[uChild].uNanos)
+         return;
+      SlowTrace_swap(&psEntries[uAt], &psEntries[uChild]);
+      uAt = uChild;
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Restore the heap order of oSlowTrace's entries by moving the entry
+   at uAt, which may be faster than its parent, up. */
+
+static void SlowTrace_siftUp(SlowTrace_T oSlowTrace, size_t uAt)
+{
+   struct SlowTraceEntry *psEntries;
+
+   assert(oSlowTrace != NULL);
+
+   psEntries = oSlowTrace->psEntries;
+   while (uAt > 0
+          && psEntries[uAt].uNanos < psEntries[(uAt - 1) / 2].uNanos)
+   {
+      SlowTrace_swap(&psEntries[uAt], &psEntries[(uAt - 1) / 2]);
+      uAt = (uAt - 1) / 2;
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Make psEntry a copy of psEvent, which took uNanos. */
+
+static void SlowTrace_copy(struct SlowTraceEntry *psEntry,
+                           const struct FT_TraceEvent *psEvent,
+                           uint64_t uNanos)
+{
+   size_t uLength;
+
+   assert(psEntry != NULL);
+   assert(psEvent != NULL);
+
+   psEntry->sEvent = *psEvent;
+   psEntry->uNanos = uNanos;
+   if (psEvent->path == NULL)
+      return;
+
+   uLength = strlen(psEvent->path);
+   if (uLength < PATH_KEPT)
+      memcpy(psEntry->acPath, psEvent->path, uLength + 1);
+   else
+   {
+      memcpy(psEntry->acPath, psEvent->path, PATH_KEPT - 4);
+      strcpy(psEntry->acPath + PATH_KEPT - 4, "...");
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Compare the entries pvOne and pvTwo by duration, for qsort. */
+
+static int SlowTrace_compare(const void *pvOne, const void *pvTwo)
+{
+   const struct SlowTraceEntry *psOne = pvOne;
+   const struct SlowTraceEntry *psTwo = pvTwo;
+
+   if (psOne->uNanos < psTwo->uNanos)
+      return -1;
+   return psOne->uNanos > psTwo->uNanos;
+}
+
+/*--------------------------------------------------------------------*/
+
+SlowTrace_T SlowTrace_new(size_t uCapacity)
+{
+   SlowTrace_T oSlowTrace;
+
+   assert(uCapacity > 0);
+
+   oSlowTrace = (SlowTrace_T)malloc(sizeof(struct SlowTrace));
+   if (oSlowTrace == NULL)
+      return NULL;
+   oSlowTrace->psEntries = (struct SlowTraceEntry*)
+      calloc(uCapacity, sizeof(struct SlowTraceEntry));
+   if (oSlowTrace->psEntries == NULL)
+   {
+      free(oSlowTrace);
+      return NULL;
+   }
+   if (pthread_mutex_init(&oSlowTrace->sLock, NULL) != 0)
+   {
+      free(oSlowTrace->psEntries);
+      free(oSlowTrace);
+      return NULL;
+   }
+   oSlowTrace->uLength = 0;
+   oSlowTrace->uCapacity = uCapacity;
+   return oSlowTrace;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SlowTrace_free(SlowTrace_T oSlowTrace)
+{
+   if (oSlowTrace == NULL)
+      return;
+
+   (void)pthread_mutex_destroy(&oSlowTrace->sLock);
+   free(oSlowTrace->psEntries);
+   free(oSlowTrace);
+}
+
+/*--------------------------------------------------------------------*/
+
+void SlowTrace_record(const struct FT_TraceEvent *psEvent,
+                      void *pvSlowTrace)
+{
+   SlowTrace_T oSlowTrace = (SlowTrace_T)pvSlowTrace;
+   uint64_t uNanos;
+
+   assert(psEvent != NULL);
+   assert(oSlowTrace != NULL);
+
+   uNanos = psEvent->endNanos - psEvent->startNanos;
+
+   (void)pthread_mutex_lock(&oSlowTrace->sLock);
+   if (oSlowTrace->uLength < oSlowTrace->uCapacity)
+   {
+      SlowTrace_copy(&oSlowTrace->psEntries[oSlowTrace->uLength],
+                     psEvent, uNanos);
+      oSlowTrace->uLength++;
+      SlowTrace_siftUp(oSlowTrace, oSlowTrace->uLength - 1);
+   }
+   /* Most calls are no slower than the fastest kept, and are dropped
+      without copying anything. */
+   else if (uNanos > oSlowTrace->psEntries[0].uNanos)
+   {
+      SlowTrace_copy(&oSlowTrace->psEntries[0], psEvent, uNanos);
+      SlowTrace_siftDown(oSlowTrace, 0);
+   }
+   (void)pthread_mutex_unlock(&oSlowTrace->sLock);
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t SlowTrace_getLength(SlowTrace_T oSlowTrace)
+{
+   size_t uLength;
+
+   assert(oSlowTrace != NULL);
+
+   (void)pthread_mutex_lock(&oSlowTrace->sLock);
+   uLength = oSlowTrace->uLength;
+   (void)pthread_mutex_unlock(&oSlowTrace->sLock);
+   return uLength;
+}
+
+/*--------------------------------------------------------------------*/
+
+void SlowTrace_dump(SlowTrace_T oSlowTrace, FILE *psFile)
+{
+   const struct SlowTraceEntry *psEntry;
+   size_t u;
+
+   assert(oSlowTrace != NULL);
+   assert(psFile != NULL);
+
+   (void)pthread_mutex_lock(&oSlowTrace->sLock);
+
+   /* An array sorted from fastest to slowest is still a min-heap, so
+      sorting leaves the entries fit to record into. */
+   qsort(oSlowTrace->psEntries, oSlowTrace->uLength,
+         sizeof(struct SlowTraceEntry), SlowTrace_compare);
+   for (u = oSlowTrace->uLength; u > 0; u--)
+   {
+      psEntry = &oSlowTrace->psEntries[u - 1];
+      fprintf(psFile, "%12lu ns %14lu cycles %8lu nodes %-24s %d %s\n",
+              (unsigned long)psEntry->uNanos,
+              (unsigned long)(psEntry->sEvent.endTicks
+                              - psEntry->sEvent.startTicks),
+              (unsigned long)psEntry->sEvent.nodesVisited,
+              FT_opName(psEntry->sEvent.op), psEntry->sEvent.status,
+              psEntry->sEvent.path != NULL ? psEntry->acPath : "-");
+   }
+
+   (void)pthread_mutex_unlock(&oSlowTrace->sLock);
+}
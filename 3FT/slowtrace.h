@@ -0,0 +1,61 @@
+/*--------------------------------------------------------------------*/
+/* slowtrace.h                                                        */
+/* Author: Alina Chen and Nickolas Casalinuovo                        */
+/*--------------------------------------------------------------------*/
+
+#ifndef SLOWTRACE_INCLUDED
+#define SLOWTRACE_INCLUDED
+
+#include <stddef.h>
+#include <stdio.h>
+#include "ft.h"
+
+/* A SlowTrace_T object keeps the slowest of the FT calls it is shown,
+   up to a fixed number of them, in a buffer allocated when it is
+   created, so that recording a call never allocates memory.  It is
+   meant to be registered as a post hook:
+
+      FT_setTraceHooks(NULL, SlowTrace_record, oSlowTrace);
+
+   It may be shown calls by several threads at once. */
+
+typedef struct SlowTrace *SlowTrace_T;
+
+/*--------------------------------------------------------------------*/
+
+/* Return a new SlowTrace_T object that keeps the uCapacity slowest
+   calls it is shown, or NULL if insufficient memory is available.
+   uCapacity must be positive. */
+
+SlowTrace_T SlowTrace_new(size_t uCapacity);
+
+/*--------------------------------------------------------------------*/
+
+/* Free oSlowTrace, which must no longer be registered as a hook. */
+
+void SlowTrace_free(SlowTrace_T oSlowTrace);
+
+/*--------------------------------------------------------------------*/
+
+/* Show the finished call psEvent to pvSlowTrace, a SlowTrace_T, which
+   keeps it if it is among the slowest shown so far.  Paths longer
+   than the buffer keeps are cut short, ending in "...". */
+
+void SlowTrace_record(const struct FT_TraceEvent *psEvent,
+                      void *pvSlowTrace);
+
+/*--------------------------------------------------------------------*/
+
+/* Return the number of calls oSlowTrace keeps. */
+
+size_t SlowTrace_getLength(SlowTrace_T oSlowTrace);
+
+/*--------------------------------------------------------------------*/
+
+/* Write the calls kept by oSlowTrace to psFile, slowest first, one a
+   line: nanoseconds, cycles, nodes visited, function, status and
+   path ("-" if none). */
+
+void SlowTrace_dump(SlowTrace_T oSlowTrace, FILE *psFile);
+
+#endif
@@ -0,0 +1,253 @@
+/*--------------------------------------------------------------------*/
+/* sortbench.c                                                        */
+/* Author: Alina Chen and Nickolas Casalinuovo                        */
+/*--------------------------------------------------------------------*/
+
+/* for clock_gettime */
+#define _POSIX_C_SOURCE 199309L
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "dynarray.h"
+
+/* Times DynArray_sort on sorted, reverse-sorted, all-equal and random
+   inputs of 1k elements up to a maximum (10M unless given as the
+   first command-line argument), checking every result.  Then times
+   DynArray_sortParallel on the random input of the maximum size with
+   1, 2, 4, ... threads up to a maximum (16 unless given as the second
+   command-line argument), checking that each result is identical to
+   DynArray_sort's.  Each measurement repeats the sort until
+   MIN_SECONDS of sorting have accumulated.  Prints one line per
+   measurement to stdout.  The random input is a permutation, so that
+   the order is total. */
+
+/*--------------------------------------------------------------------*/
+
+/* The least total sorting time measured for each input and size. */
+
+static const double MIN_SECONDS = 0.2;
+
+/* The kinds of input. */
+
+enum Input { SORTED, REVERSED, EQUAL, RANDOM, NUM_INPUTS };
+
+static const char *INPUT_NAMES[NUM_INPUTS] =
+   { "sorted", "reversed", "equal", "random" };
+
+/*--------------------------------------------------------------------*/
+
+/* Return <0, 0, or >0 depending upon whether the int at pvElement1 is
+   less than, equal to, or greater than the int at pvElement2. */
+
+static int compareInts(const void *pvElement1, const void *pvElement2)
+{
+   int i1 = *(const int*)pvElement1;
+   int i2 = *(const int*)pvElement2;
+
+   return (i1 > i2) - (i1 < i2);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Fill the uLength ints at piKeys as input eInput requires, and make
+   the elements of oDynArray point to them in order. */
+
+static void fill(DynArray_T oDynArray, int *piKeys, size_t uLength,
+                 enum Input eInput)
+{
+   size_t u;
+   size_t uOther;
+   int iTemp;
+
+   for (u = 0; u < uLength; u++)
+   {
+      switch (eInput)
+      {
+         case REVERSED: piKeys[u] = (int)(uLength - u);    break;
+         case EQUAL:    piKeys[u] = 42;                    break;
+         /* SORTED, and RANDOM before it is shuffled */
+         default:       piKeys[u] = (int)u;                break;
+      }
+   }
+
+   if (eInput == RANDOM)
+      for (u = uLength; u > 1; u--)
+      {
+         /* Swap piKeys[u-1] with a random earlier element. */
+         uOther = ((size_t)rand() * ((size_t)RAND_MAX + 1)
+                   + (size_t)rand()) % u;
+         iTemp = piKeys[u - 1];
+         piKeys[u - 1] = piKeys[uOther];
+         piKeys[uOther] = iTemp;
+      }
+
+   for (u = 0; u < uLength; u++)
+      (void)DynArray_set(oDynArray, u, &piKeys[u]);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the current time in seconds, by a clock that is not set
+   back or forward.  Unlike clock(), it measures elapsed time rather
+   than the sum of the CPU times of all threads. */
+
+static double now(void)
+{
+   struct timespec sTime;
+
+   (void)clock_gettime(CLOCK_MONOTONIC, &sTime);
+   return (double)sTime.tv_sec + (double)sTime.tv_nsec / 1e9;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return 1 (TRUE) iff the elements of oDynArray are in ascending
+   order. */
+
+static int isSorted(DynArray_T oDynArray)
+{
+   size_t u;
+
+   for (u = 1; u < DynArray_getLength(oDynArray); u++)
+      if (compareInts(DynArray_get(oDynArray, u - 1),
+                      DynArray_get(oDynArray, u)) > 0)
+         return 0;
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Time DynArray_sortParallel with 1, 2, 4, ... up to uMaxThreads
+   threads on the random input of uLength elements, checking each
+   result against DynArray_sort's.  Return 1 (TRUE) if successful, or
+   0 (FALSE) if insufficient memory is available or a result
+   differs. */
+
+static int benchThreads(size_t uLength, size_t uMaxThreads)
+{
+   int *piKeys;
+   DynArray_T oDynArray;
+   DynArray_T oExpected;
+   size_t uThreads;
+   size_t uReps;
+   size_t u;
+   double dStart;
+   double dSeconds;
+   double dOneThread = 0.0;
+
+   piKeys = (int*)malloc(uLength * sizeof(int));
+   oDynArray = DynArray_new(uLength);
+   oExpected = DynArray_new(uLength);
+   if (piKeys == NULL || oDynArray == NULL || oExpected == NULL)
+      return 0;
+
+   srand(1);
+   fill(oExpected, piKeys, uLength, RANDOM);
+   DynArray_sort(oExpected, compareInts);
+
+   printf("\n%-9s %10s %7s %6s %12s %8s\n",
+          "input", "elements", "threads", "reps", "ms/sort", "speedup");
+
+   for (uThreads = 1; uThreads <= uMaxThreads; uThreads *= 2)
+   {
+      srand(1);
+      dSeconds = 0.0;
+      for (uReps = 0; dSeconds < MIN_SECONDS; uReps++)
+      {
+         fill(oDynArray, piKeys, uLength, RANDOM);
+         dStart = now();
+         DynArray_sortParallel(oDynArray, compareInts, uThreads);
+         dSeconds += now() - dStart;
+         for (u = 0; u < uLength; u++)
+            if (DynArray_get(oDynArray, u)
+                != DynArray_get(oExpected, u))
+            {
+               fprintf(stderr, "sortbench: %lu threads differ from "
+                       "DynArray_sort\n", (unsigned long)uThreads);
+               return 0;
+            }
+      }
+      dSeconds /= (double)uReps;
+      if (uThreads == 1)
+         dOneThread = dSeconds;
+      printf("%-9s %10lu %7lu %6lu %12.3f %8.2f\n",
+             INPUT_NAMES[RANDOM], (unsigned long)uLength,
+             (unsigned long)uThreads, (unsigned long)uReps,
+             dSeconds * 1e3, dOneThread / dSeconds);
+      fflush(stdout);
+   }
+
+   DynArray_free(oExpected);
+   DynArray_free(oDynArray);
+   free(piKeys);
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+int main(int argc, char *argv[])
+{
+   size_t uMax = 10000000;
+   size_t uMaxThreads = 16;
+   size_t uLength;
+   size_t uReps;
+   int eInput;
+   int *piKeys;
+   DynArray_T oDynArray;
+   double dStart;
+   double dSeconds;
+
+   if (argc > 1)
+      uMax = (size_t)strtoul(argv[1], NULL, 10);
+   if (argc > 2)
+      uMaxThreads = (size_t)strtoul(argv[2], NULL, 10);
+
+   printf("%-9s %10s %6s %12s %10s\n",
+          "input", "elements", "reps", "ms/sort", "ns/elem");
+
+   for (uLength = 1000; uLength <= uMax; uLength *= 10)
+   {
+      piKeys = (int*)malloc(uLength * sizeof(int));
+      oDynArray = DynArray_new(uLength);
+      if (piKeys == NULL || oDynArray == NULL)
+      {
+         fprintf(stderr, "sortbench: out of memory\n");
+         return EXIT_FAILURE;
+      }
+
+      for (eInput = 0; eInput < NUM_INPUTS; eInput++)
+      {
+         srand(1);
+         dSeconds = 0.0;
+         for (uReps = 0; dSeconds < MIN_SECONDS; uReps++)
+         {
+            fill(oDynArray, piKeys, uLength, (enum Input)eInput);
+            dStart = now();
+            DynArray_sort(oDynArray, compareInts);
+            dSeconds += now() - dStart;
+            if (! isSorted(oDynArray))
+            {
+               fprintf(stderr, "sortbench: %s input of %lu "
+                       "not sorted\n", INPUT_NAMES[eInput],
+                       (unsigned long)uLength);
+               return EXIT_FAILURE;
+            }
+         }
+         printf("%-9s %10lu %6lu %12.3f %10.1f\n",
+                INPUT_NAMES[eInput], (unsigned long)uLength,
+                (unsigned long)uReps, dSeconds * 1e3 / (double)uReps,
+                dSeconds * 1e9 / (double)uReps / (double)uLength);
+         fflush(stdout);
+      }
+
+      DynArray_free(oDynArray);
+      free(piKeys);
+   }
+
+   if (! benchThreads(uMax, uMaxThreads))
+      return EXIT_FAILURE;
+
+   return 0;
+}
@@ -0,0 +1,169 @@
+/*--------------------------------------------------------------------*/
+/* splitbench.c                                                       */
+/* Author: Alina Chen and Nickolas Casalinuovo                        */
+/*--------------------------------------------------------------------*/
+
+/* for clock_gettime */
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "pathsplit.h"
+
+/* Times three ways of finding the components of a path: strtok on a
+   copy, as insertion did; strchr and strlen, as resolution did; and
+   PathSplit_split.  For paths of 2, 8 and 32 components of 3 to 16
+   characters each, prints ns per path to stdout. */
+
+/*--------------------------------------------------------------------*/
+
+/* The number of distinct paths of each depth, cycled through. */
+
+enum { PATHS = 4096 };
+
+/* The number of paths split for each depth and method. */
+
+enum { SPLITS = 4000000 };
+
+/* The most components split out at a time by PathSplit_split. */
+
+enum { SPANS = 32 };
+
+/*--------------------------------------------------------------------*/
+
+/* Return the current time in seconds. */
+
+static double now(void)
+{
+   struct timespec sTime;
+
+   (void)clock_gettime(CLOCK_MONOTONIC, &sTime);
+   return (double)sTime.tv_sec + (double)sTime.tv_nsec / 1e9;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return a new random path of uDepth components, or NULL if
+   insufficient memory is available. */
+
+static char *makePath(size_t uDepth)
+{
+   char *pcPath;
+   size_t uComponent;
+   size_t uLength;
+   size_t u;
+   size_t uAt = 0;
+
+   pcPath = (char*)malloc(uDepth * 17 + 1);
+   if (pcPath == NULL)
+      return NULL;
+   for (uComponent = 0; uComponent < uDepth; uComponent++)
+   {
+      if (uComponent > 0)
+         pcPath[uAt++] = '/';
+      uLength = 3 + (size_t)rand() % 14;
+      for (u = 0; u < uLength; u++)
+         pcPath[uAt++] = (char)('a' + rand() % 26);
+   }
+   pcPath[uAt] = '\0';
+   return pcPath;
+}
+
+/*--------------------------------------------------------------------*/
+
+int main(void)
+{
+   static const size_t auDepths[] = { 2, 8, 32 };
+   struct PathSpan asSpans[SPANS];
+   char *apcPaths[PATHS];
+   char acCopy[32 * 17 + 1];
+   const char *pcRest;
+   const char *pcEnd;
+   const char *pcAt;
+   char *pcToken;
+   size_t uDepth;
+   size_t uSplit;
+   size_t auTotals[3];
+   size_t u;
+   double dStart;
+   double dStrtok;
+   double dStrchr;
+   double dSplit;
+
+   printf("%6s %10s %10s %10s\n",
+          "depth", "strtok ns", "strchr ns", "split ns");
+
+   for (u = 0; u < sizeof(auDepths) / sizeof(auDepths[0]); u++)
+   {
+      uDepth = auDepths[u];
+      for (uSplit = 0; uSplit < PATHS; uSplit++)
+      {
+         apcPaths[uSplit] = makePath(uDepth);
+         if (apcPaths[uSplit] == NULL)
+         {
+            fprintf(stderr, "splitbench: out of memory\n");
+            return EXIT_FAILURE;
+         }
+      }
+
+      /* Each method sums the lengths of the components it finds, so
+         that its work cannot be optimized away. */
+      auTotals[0] = auTotals[1] = auTotals[2] = 0;
+      dStart = now();
+      for (uSplit = 0; uSplit < SPLITS; uSplit++)
+      {
+         strcpy(acCopy, apcPaths[uSplit % PATHS]);
+         for (pcToken = strtok(acCopy, "/"); pcToken != NULL;
+              pcToken = strtok(NULL, "/"))
+            auTotals[0] += strlen(pcToken);
+      }
+      dStrtok = now() - dStart;
+
+      dStart = now();
+      for (uSplit = 0; uSplit < SPLITS; uSplit++)
+      {
+         pcAt = apcPaths[uSplit % PATHS];
+         while (*pcAt != '\0')
+         {
+            pcEnd = strchr(pcAt, '/');
+            if (pcEnd == NULL)
+               pcEnd = pcAt + strlen(pcAt);
+            auTotals[1] += (size_t)(pcEnd - pcAt);
+            pcAt = (*pcEnd == '/') ? pcEnd + 1 : pcEnd;
+         }
+      }
+      dStrchr = now() - dStart;
+
+      dStart = now();
+      for (uSplit = 0; uSplit < SPLITS; uSplit++)
+      {
+         pcRest = apcPaths[uSplit % PATHS];
+         do
+         {
+            size_t uCount = PathSplit_split(pcRest, asSpans, SPANS,
+                                            &pcRest);
+            size_t uSpan;
+            for (uSpan = 0; uSpan < uCount; uSpan++)
+               auTotals[2] += asSpans[uSpan].uLength;
+         } while (pcRest != NULL);
+      }
+      dSplit = now() - dStart;
+
+      if (auTotals[0] != auTotals[1] || auTotals[1] != auTotals[2])
+      {
+         fprintf(stderr, "splitbench: the methods disagree\n");
+         return EXIT_FAILURE;
+      }
+
+      printf("%6lu %10.1f %10.1f %10.1f\n", (unsigned long)uDepth,
+             dStrtok * 1e9 / SPLITS, dStrchr * 1e9 / SPLITS,
+             dSplit * 1e9 / SPLITS);
+
+      for (uSplit = 0; uSplit < PATHS; uSplit++)
+         free(apcPaths[uSplit]);
+   }
+
+   return 0;
+}
@@ -0,0 +1,408 @@
+/*--------------------------------------------------------------------*/
+/* tlbbench.c                                                         */
+/* Author: Alina Chen and Nickolas Casalinuovo                        */
+/*--------------------------------------------------------------------*/
+
+/* for getopt, fork and perf_event_open */
+#define _DEFAULT_SOURCE 1
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <linux/perf_event.h>
+#include "ft.h"
+#include "arena.h"
+
+/* Times random lookups in a large tree whose memory comes from each
+   of three sources in turn: malloc, an arena backed by transparent
+   huge pages, and an arena in the hugetlbfs pool (which falls back
+   to transparent huge pages if the pool is too small).  Prints one
+   CSV row per source to stdout: the backing the arena got, the
+   number of nodes, ns per insert and per lookup, dTLB load misses
+   per lookup, the kilobytes of the process backed by transparent
+   huge pages, and its peak resident set size.  Each source is run
+   in a child process of its own, so that none inherits the memory
+   of another.
+
+   The tree is a complete tree of -k (16) directories per directory,
+   of -n (10M) nodes in all, its leaves files, inserted in random
+   order, so that a node is rarely placed near its parent or
+   siblings.  Then -l (2M) nodes chosen at random, the same for each
+   source, are looked up with FT_containsDir or FT_containsFile, with
+   the lookup cache off.  dTLB misses are counted with the
+   processor's performance counters, and reported as n/a where they
+   cannot be read, as in most virtual machines.
+
+   Usage: tlbbench [-n nodes] [-l lookups] [-k fanout] [-s seed] */
+
+/*--------------------------------------------------------------------*/
+
+/* The sources of memory, in the order they are run. */
+
+enum Source { SOURCE_MALLOC, SOURCE_TRANSPARENT, SOURCE_HUGETLB,
+              SOURCES };
+
+/* The name of each source. */
+
+static const char *const apcSourceNames[SOURCES] =
+   { "malloc", "arena", "arena_hugetlb" };
+
+/* The name of each backing of an arena. */
+
+static const char *const apcBackingNames[] =
+   { "hugetlb", "transparent", "plain" };
+
+/* The most characters in the path of a node. */
+
+enum { MAX_PATH = 256 };
+
+/* The bytes of arena reserved per node in the hugetlbfs pool, ample
+   for a node, its path and its share of the arrays of children. */
+
+enum { HUGETLB_BYTES_PER_NODE = 256 };
+
+/*--------------------------------------------------------------------*/
+
+/* The shape of the tree and the lookups in it. */
+
+struct Bench
+{
+   /* The number of nodes, and of directories per directory. */
+   size_t uNodes;
+   size_t uFanout;
+
+   /* A random permutation of the indices of the nodes. */
+   size_t *puOrder;
+
+   /* The number of lookups, and the index of the node of each. */
+   size_t uLookups;
+   size_t *puLookups;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Return the current time in nanoseconds. */
+
+static unsigned long now(void)
+{
+   struct timespec sTime;
+
+   (void)clock_gettime(CLOCK_MONOTONIC, &sTime);
+   return (unsigned long)sTime.tv_sec * 1000000000UL
+      + (unsigned long)sTime.tv_nsec;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Exit the program, reporting that memory ran out. */
+
+static void outOfMemory(void)
+{
+   fprintf(stderr, "tlbbench: out of memory\n");
+   exit(EXIT_FAILURE);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return a uniformly random number from 0 to uBound - 1, for a
+   positive uBound. */
+
+static size_t randomBelow(size_t uBound)
+{
+   size_t uValue;
+
+   uValue = ((size_t)rand() << 31) ^ ((size_t)rand() << 16)
+            ^ (size_t)rand();
+   return uValue % uBound;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Write the path of node uNode of psBench to pcPath: the root, node
+   0, is "r", and the j'th child of node u, node u * fanout + j + 1,
+   is named "d" and j. */
+
+static void pathOf(const struct Bench *psBench, size_t uNode,
+                   char *pcPath)
+{
+   size_t auChain[64];
+   size_t uDepth = 0;
+   size_t uLength;
+
+   while (uNode != 0)
+   {
+      auChain[uDepth++] = (uNode - 1) % psBench->uFanout;
+      uNode = (uNode - 1) / psBench->uFanout;
+   }
+
+   strcpy(pcPath, "r");
+   uLength = 1;
+   while (uDepth > 0)
+      uLength += (size_t)sprintf(pcPath + uLength, "/d%lu",
+                                 (unsigned long)auChain[--uDepth]);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return 1 (TRUE) if node uNode of psBench is a file, a leaf, or 0
+   (FALSE) if it is a directory. */
+
+static int isLeaf(const struct Bench *psBench, size_t uNode)
+{
+   return uNode * psBench->uFanout + 1 >= psBench->uNodes;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Open a counter of the dTLB load misses of this process, disabled.
+   Return its file descriptor, or -1 if it cannot be opened. */
+
+static int openTlbCounter(void)
+{
+   struct perf_event_attr sAttr;
+
+   memset(&sAttr, 0, sizeof(sAttr));
+   sAttr.size = sizeof(sAttr);
+   sAttr.type = PERF_TYPE_HW_CACHE;
+   sAttr.config = PERF_COUNT_HW_CACHE_DTLB
+                  | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                  | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+   sAttr.disabled = 1;
+   sAttr.exclude_kernel = 1;
+   sAttr.exclude_hv = 1;
+   return (int)syscall(SYS_perf_event_open, &sAttr, 0, -1, -1, 0);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the kilobytes of this process backed by transparent huge
+   pages, or -1 if they cannot be read. */
+
+static long anonHugeKb(void)
+{
+   FILE *psFile;
+   char acLine[256];
+   long lKb = -1;
+
+   psFile = fopen("/proc/self/smaps_rollup", "r");
+   if (psFile == NULL)
+      return -1;
+   while (fgets(acLine, sizeof(acLine), psFile) != NULL)
+      if (sscanf(acLine, "AnonHugePages: %ld", &lKb) == 1)
+         break;
+   fclose(psFile);
+   return lKb;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Build the tree of psBench with memory from source eSource, time
+   its lookups, and print its row.  Return 0 (FALSE) if a call
+   failed that should not have, or 1 (TRUE) otherwise. */
+
+static int run(const struct Bench *psBench, enum Source eSource)
+{
+   Arena_T oArena = NULL;
+   struct ArenaStats sStats;
+   struct rusage sUsage;
+   const char *pcBacking = "-";
+   char acPath[MAX_PATH];
+   char acMisses[32];
+   char *pcPaths;
+   size_t *puOffsets;
+   size_t uFailed = 0;
+   size_t uBytes;
+   size_t u;
+   size_t uNode;
+   unsigned long ulInsert;
+   unsigned long ulLookup;
+   long long llMisses = 0;
+   int iCounter;
+   int iStatus;
+
+   if (eSource != SOURCE_MALLOC)
+   {
+      /* the hugetlbfs pool must hold the whole region, so it is
+         sized to the tree */
+      oArena = Arena_new(eSource == SOURCE_HUGETLB
+                         ? psBench->uNodes * HUGETLB_BYTES_PER_NODE
+                         : 0, eSource == SOURCE_HUGETLB);
+      if (oArena == NULL)
+      {
+         fprintf(stderr, "tlbbench: cannot reserve an arena\n");
+         return 0;
+      }
+      Arena_getStats(oArena, &sStats);
+      pcBacking = apcBackingNames[sStats.eBacking];
+      (void)FT_setAllocator(Arena_get(oArena));
+   }
+
+   (void)FT_init();
+   (void)FT_setLookupCacheSize(0);
+   ulInsert = now();
+   (void)FT_insertDir("r");
+   for (u = 0; u < psBench->uNodes; u++)
+   {
+      uNode = psBench->puOrder[u];
+      pathOf(psBench, uNode, acPath);
+      if (isLeaf(psBench, uNode))
+         iStatus = FT_insertFile(acPath, NULL, 0);
+      else
+         iStatus = FT_insertDir(acPath);
+      if (iStatus != SUCCESS && iStatus != ALREADY_IN_TREE)
+         uFailed++;
+   }
+   ulInsert = now() - ulInsert;
+
+   /* the paths are written out first, so only lookups are timed */
+   puOffsets = (size_t*)malloc(psBench->uLookups * sizeof(size_t));
+   if (puOffsets == NULL)
+      outOfMemory();
+   for (u = 0, uBytes = 0; u < psBench->uLookups; u++)
+   {
+      pathOf(psBench, psBench->puLookups[u], acPath);
+      puOffsets[u] = uBytes;
+      uBytes += strlen(acPath) + 1;
+   }
+   pcPaths = (char*)malloc(uBytes);
+   if (pcPaths == NULL)
+      outOfMemory();
+   for (u = 0; u < psBench->uLookups; u++)
+      pathOf(psBench, psBench->puLookups[u], pcPaths + puOffsets[u]);
+
+   iCounter = openTlbCounter();
+   if (iCounter >= 0)
+   {
+      (void)ioctl(iCounter, PERF_EVENT_IOC_RESET, 0);
+      (void)ioctl(iCounter, PERF_EVENT_IOC_ENABLE, 0);
+   }
+   ulLookup = now();
+   for (u = 0; u < psBench->uLookups; u++)
+      if (isLeaf(psBench, psBench->puLookups[u])
+          ? !FT_containsFile(pcPaths + puOffsets[u])
+          : !FT_containsDir(pcPaths + puOffsets[u]))
+         uFailed++;
+   ulLookup = now() - ulLookup;
+   if (iCounter >= 0)
+   {
+      (void)ioctl(iCounter, PERF_EVENT_IOC_DISABLE, 0);
+      if (read(iCounter, &llMisses, sizeof(llMisses))
+          != (ssize_t)sizeof(llMisses))
+         llMisses = -1;
+      close(iCounter);
+   }
+   if (iCounter < 0 || llMisses < 0)
+      strcpy(acMisses, "n/a");
+   else
+      sprintf(acMisses, "%.2f",
+              (double)llMisses / (double)psBench->uLookups);
+
+   (void)getrusage(RUSAGE_SELF, &sUsage);
+   printf("%s,%s,%lu,%.1f,%.1f,%s,%ld,%ld\n",
+          apcSourceNames[eSource], pcBacking,
+          (unsigned long)psBench->uNodes,
+          (double)ulInsert / (double)psBench->uNodes,
+          (double)ulLookup / (double)psBench->uLookups, acMisses,
+          anonHugeKb(), sUsage.ru_maxrss);
+
+   (void)FT_destroy();
+   (void)FT_setAllocator(NULL);
+   if (oArena != NULL)
+      Arena_free(oArena);
+   free(pcPaths);
+   free(puOffsets);
+   return uFailed == 0;
+}
+
+/*--------------------------------------------------------------------*/
+
+int main(int argc, char *argv[])
+{
+   struct Bench sBench;
+   size_t u;
+   size_t uSwap;
+   size_t uTemp;
+   int iSource;
+   int iOption;
+   int iStatus;
+   int bPassed = 1;
+   pid_t iChild;
+
+   sBench.uNodes = 10000000;
+   sBench.uFanout = 16;
+   sBench.uLookups = 2000000;
+   while ((iOption = getopt(argc, argv, "n:l:k:s:")) != -1)
+      switch (iOption)
+      {
+         case 'n':
+            sBench.uNodes = (size_t)strtoul(optarg, NULL, 10);
+            break;
+         case 'l':
+            sBench.uLookups = (size_t)strtoul(optarg, NULL, 10);
+            break;
+         case 'k':
+            sBench.uFanout = (size_t)strtoul(optarg, NULL, 10);
+            break;
+         case 's':
+            srand((unsigned)strtoul(optarg, NULL, 10));
+            break;
+         default:
+            fprintf(stderr, "usage: %s [-n nodes] [-l lookups] "
+                    "[-k fanout] [-s seed]\n", argv[0]);
+            return EXIT_FAILURE;
+      }
+   if (sBench.uNodes < 2 || sBench.uLookups < 1 || sBench.uFanout < 2)
+   {
+      fprintf(stderr, "tlbbench: nodes must be at least 2, lookups "
+              "at least 1, and fanout at least 2\n");
+      return EXIT_FAILURE;
+   }
+
+   sBench.puOrder = (size_t*)malloc(sBench.uNodes * sizeof(size_t));
+   sBench.puLookups =
+      (size_t*)malloc(sBench.uLookups * sizeof(size_t));
+   if (sBench.puOrder == NULL || sBench.puLookups == NULL)
+      outOfMemory();
+   for (u = 0; u < sBench.uNodes; u++)
+      sBench.puOrder[u] = u;
+   for (u = sBench.uNodes - 1; u > 0; u--)
+   {
+      uSwap = randomBelow(u + 1);
+      uTemp = sBench.puOrder[u];
+      sBench.puOrder[u] = sBench.puOrder[uSwap];
+      sBench.puOrder[uSwap] = uTemp;
+   }
+   for (u = 0; u < sBench.uLookups; u++)
+      sBench.puLookups[u] = randomBelow(sBench.uNodes);
+
+   printf("source,backing,nodes,insert_ns,lookup_ns,"
+          "dtlb_misses_per_lookup,anon_huge_kb,peak_rss_kb\n");
+   fflush(stdout);
+   for (iSource = 0; iSource < SOURCES; iSource++)
+   {
+      iChild = fork();
+      if (iChild == 0)
+      {
+         iStatus = run(&sBench, (enum Source)iSource);
+         fflush(stdout);
+         _exit(iStatus ? 0 : EXIT_FAILURE);
+      }
+      if (iChild < 0 || waitpid(iChild, &iStatus, 0) < 0
+          || !WIFEXITED(iStatus) || WEXITSTATUS(iStatus) != 0)
+      {
+         fprintf(stderr, "tlbbench: the %s run failed\n",
+                 apcSourceNames[iSource]);
+         bPassed = 0;
+      }
+   }
+
+   free(sBench.puOrder);
+   free(sBench.puLookups);
+   return bPassed ? 0 : EXIT_FAILURE;
+}
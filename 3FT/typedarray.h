@@ -0,0 +1,465 @@
+/*--------------------------------------------------------------------*/
+/* typedarray.h                                                       */
+/* Author: Alina Chen and Nickolas Casalinuovo                        */
+/*--------------------------------------------------------------------*/
+
+#ifndef TYPEDARRAY_INCLUDED
+#define TYPEDARRAY_INCLUDED
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include "allocator.h"
+
+/* TYPEDARRAY_DEFINE(Prefix, Type) defines a type Prefix_T: an array
+   of elements of type Type whose length can expand dynamically, with
+   the functions of a DynArray_T (see dynarray.h) but taking and
+   returning Type rather than void pointers, and a way to read the
+   physical length:
+
+      Prefix_T Prefix_new(size_t uLength);
+      void     Prefix_free(Prefix_T oArray);
+      size_t   Prefix_getLength(Prefix_T oArray);
+      size_t   Prefix_getPhysLength(Prefix_T oArray);
+      Type     Prefix_get(Prefix_T oArray, size_t uIndex);
+      Type     Prefix_set(Prefix_T oArray, size_t uIndex,
+                          Type tElement);
+      int      Prefix_add(Prefix_T oArray, Type tElement);
+      int      Prefix_addAt(Prefix_T oArray, size_t uIndex,
+                            Type tElement);
+      Type     Prefix_removeAt(Prefix_T oArray, size_t uIndex);
+      int      Prefix_reserve(Prefix_T oArray, size_t uPhysLength);
+
+   TYPEDARRAY_DEFINE_ORDER(Prefix, Type, KeyType, compareKey,
+   compareElements) then adds, for that Prefix_T,
+
+      int  Prefix_bsearch(Prefix_T oArray, KeyType tKey,
+                          size_t *puIndex);
+      void Prefix_sort(Prefix_T oArray);
+      void Prefix_sortElements(Type *ptElements, size_t uCount);
+      int  Prefix_addAllSorted(Prefix_T oArray,
+                               const Type *ptElements, size_t uCount);
+
+   which behave as DynArray_bsearch, DynArray_sort and
+   DynArray_addAllSorted do (Prefix_sortElements sorting a plain
+   array of uCount elements), ordering by
+   compareKey(tKey, tElement) and compareElements(tElement1,
+   tElement2), each returning <0, 0, or >0.  These are called
+   directly, not through function pointers, so the compiler can
+   inline them into the search and sort loops.
+
+   TYPEDARRAY_DEFINE_ALLOC(Prefix, Type, psAllocator) defines the
+   same Prefix_T, taking its memory from the struct Allocator that
+   the expression psAllocator yields (see allocator.h) rather than
+   from malloc.  psAllocator is evaluated on each allocation, so it
+   may name a variable, but it must yield the same Allocator for the
+   life of each array.
+
+   Every function is static inline, so each translation unit that
+   uses a Prefix_T defines its own; DynArray_T remains the generic,
+   separately compiled array. */
+
+/*--------------------------------------------------------------------*/
+
+/* The minimum physical length of a typed array. */
+
+enum { TYPEDARRAY_MIN_PHYS_LENGTH = 2 };
+
+/*--------------------------------------------------------------------*/
+
+#define TYPEDARRAY_DEFINE(Prefix, Type)                                \
+   TYPEDARRAY_DEFINE_ALLOC(Prefix, Type, &Allocator_heap)
+
+/*--------------------------------------------------------------------*/
+
+#define TYPEDARRAY_DEFINE_ALLOC(Prefix, Type, psAllocator)             \
+                                                                       \
+/* A Prefix consists of an array, along with its logical and         \
+   physical lengths. */                                                \
+struct Prefix                                                          \
+{                                                                      \
+   /* The number of elements from the client's point of view. */      \
+   size_t uLength;                                                     \
+                                                                       \
+   /* The number of elements in the underlying array. */              \
+   size_t uPhysLength;                                                 \
+                                                                       \
+   /* The underlying array. */                                         \
+   Type *ptArray;                                                      \
+};                                                                     \
+                                                                       \
+typedef struct Prefix *Prefix##_T;                                     \
+                                                                       \
+/* Double the physical length of oArray.  Return 1 (TRUE) if         \
+   successful and 0 (FALSE) if insufficient memory is available. */   \
+static inline int Prefix##_grow(Prefix##_T oArray)                     \
+{                                                                      \
+   Type *ptNewArray;                                                   \
+                                                                       \
+   assert(oArray != NULL);                                             \
+                                                                       \
+   ptNewArray = (Type*)Allocator_realloc(psAllocator, oArray->ptArray, \
+                                         sizeof(Type)                  \
+                                         * oArray->uPhysLength,        \
+                                         sizeof(Type) * 2              \
+                                         * oArray->uPhysLength);       \
+   if (ptNewArray == NULL)                                             \
+      return 0;                                                        \
+                                                                       \
+   oArray->uPhysLength *= 2;                                           \
+   oArray->ptArray = ptNewArray;                                       \
+   return 1;                                                           \
+}                                                                      \
+                                                                       \
+static inline Prefix##_T Prefix##_new(size_t uLength)                  \
+{                                                                      \
+   Prefix##_T oArray;                                                  \
+                                                                       \
+   oArray = (struct Prefix*)Allocator_alloc(psAllocator,               \
+                                            sizeof(struct Prefix));    \
+   if (oArray == NULL)                                                 \
+      return NULL;                                                     \
+                                                                       \
+   oArray->uLength = uLength;                                          \
+   if (uLength > TYPEDARRAY_MIN_PHYS_LENGTH)                           \
+      oArray->uPhysLength = uLength;                                   \
+   else                                                                \
+      oArray->uPhysLength = TYPEDARRAY_MIN_PHYS_LENGTH;                \
+                                                                       \
+   oArray->ptArray = (Type*)Allocator_alloc(psAllocator,               \
+                                            sizeof(Type)               \
+                                            * oArray->uPhysLength);    \
+   if (oArray->ptArray == NULL)                                        \
+   {                                                                   \
+      Allocator_free(psAllocator, oArray, sizeof(struct Prefix));      \
+      return NULL;                                                     \
+   }                                                                   \
+   memset(oArray->ptArray, 0, sizeof(Type) * oArray->uPhysLength);     \
+   return oArray;                                                      \
+}                                                                      \
+                                                                       \
+static inline void Prefix##_free(Prefix##_T oArray)                    \
+{                                                                      \
+   assert(oArray != NULL);                                             \
+                                                                       \
+   Allocator_free(psAllocator, oArray->ptArray,                        \
+                  sizeof(Type) * oArray->uPhysLength);                 \
+   Allocator_free(psAllocator, oArray, sizeof(struct Prefix));         \
+}                                                                      \
+                                                                       \
+static inline size_t Prefix##_getLength(Prefix##_T oArray)             \
+{                                                                      \
+   assert(oArray != NULL);                                             \
+                                                                       \
+   return oArray->uLength;                                             \
+}                                                                      \
+                                                                       \
+static inline size_t Prefix##_getPhysLength(Prefix##_T oArray)         \
+{                                                                      \
+   assert(oArray != NULL);                                             \
+                                                                       \
+   return oArray->uPhysLength;                                         \
+}                                                                      \
+                                                                       \
+static inline Type Prefix##_get(Prefix##_T oArray, size_t uIndex)      \
+{                                                                      \
+   assert(oArray != NULL);                                             \
+   assert(uIndex < oArray->uLength);                                   \
+                                                                       \
+   return oArray->ptArray[uIndex];                                     \
+}                                                                      \
+                                                                       \
+static inline Type Prefix##_set(Prefix##_T oArray, size_t uIndex,      \
+                                Type tElement)                         \
+{                                                                      \
+   Type tOldElement;                                                   \
+                                                                       \
+   assert(oArray != NULL);                                             \
+   assert(uIndex < oArray->uLength);                                   \
+                                                                       \
+   tOldElement = oArray->ptArray[uIndex];                              \
+   oArray->ptArray[uIndex] = tElement;                                 \
+   return tOldElement;                                                 \
+}                                                                      \
+                                                                       \
+static inline int Prefix##_add(Prefix##_T oArray, Type tElement)       \
+{                                                                      \
+   assert(oArray != NULL);                                             \
+                                                                       \
+   if (oArray->uLength == oArray->uPhysLength)                         \
+      if (! Prefix##_grow(oArray))                                     \
+         return 0;                                                     \
+                                                                       \
+   oArray->ptArray[oArray->uLength] = tElement;                        \
+   oArray->uLength++;                                                  \
+   return 1;                                                           \
+}                                                                      \
+                                                                       \
+static inline int Prefix##_addAt(Prefix##_T oArray, size_t uIndex,     \
+                                 Type tElement)                        \
+{                                                                      \
+   assert(oArray != NULL);                                             \
+   assert(uIndex <= oArray->uLength);                                  \
+                                                                       \
+   if (oArray->uLength == oArray->uPhysLength)                         \
+      if (! Prefix##_grow(oArray))                                     \
+         return 0;                                                     \
+                                                                       \
+   memmove(&oArray->ptArray[uIndex + 1], &oArray->ptArray[uIndex],     \
+           sizeof(Type) * (oArray->uLength - uIndex));                 \
+   oArray->ptArray[uIndex] = tElement;                                 \
+   oArray->uLength++;                                                  \
+   return 1;                                                           \
+}                                                                      \
+                                                                       \
+static inline Type Prefix##_removeAt(Prefix##_T oArray, size_t uIndex) \
+{                                                                      \
+   Type tOldElement;                                                   \
+                                                                       \
+   assert(oArray != NULL);                                             \
+   assert(uIndex < oArray->uLength);                                   \
+                                                                       \
+   tOldElement = oArray->ptArray[uIndex];                              \
+   memmove(&oArray->ptArray[uIndex], &oArray->ptArray[uIndex + 1],     \
+           sizeof(Type) * (oArray->uLength - uIndex - 1));             \
+   oArray->uLength--;                                                  \
+   return tOldElement;                                                 \
+}                                                                      \
+                                                                       \
+static inline int Prefix##_reserve(Prefix##_T oArray,                  \
+                                   size_t uPhysLength)                 \
+{                                                                      \
+   Type *ptNewArray;                                                   \
+                                                                       \
+   assert(oArray != NULL);                                             \
+                                                                       \
+   if (uPhysLength <= oArray->uPhysLength)                             \
+      return 1;                                                        \
+                                                                       \
+   ptNewArray = (Type*)Allocator_realloc(psAllocator, oArray->ptArray, \
+                                         sizeof(Type)                  \
+                                         * oArray->uPhysLength,        \
+                                         sizeof(Type) * uPhysLength);  \
+   if (ptNewArray == NULL)                                             \
+      return 0;                                                        \
+                                                                       \
+   oArray->uPhysLength = uPhysLength;                                  \
+   oArray->ptArray = ptNewArray;                                       \
+   return 1;                                                           \
+}
+
+/*--------------------------------------------------------------------*/
+
+#define TYPEDARRAY_DEFINE_ORDER(Prefix, Type, KeyType, compareKey,     \
+                                compareElements)                       \
+                                                                       \
+static inline int Prefix##_bsearch(Prefix##_T oArray, KeyType tKey,    \
+                                   size_t *puIndex)                    \
+{                                                                      \
+   size_t uLo = 0;                                                     \
+   size_t uHi;                                                         \
+   size_t uMid;                                                        \
+   int iCompare;                                                       \
+                                                                       \
+   assert(oArray != NULL);                                             \
+   assert(puIndex != NULL);                                            \
+                                                                       \
+   uHi = oArray->uLength;                                              \
+   while (uLo < uHi)                                                   \
+   {                                                                   \
+      uMid = uLo + (uHi - uLo) / 2;                                    \
+      iCompare = compareKey(tKey, oArray->ptArray[uMid]);              \
+      if (iCompare < 0)                                                \
+         uHi = uMid;                                                   \
+      else if (iCompare > 0)                                           \
+         uLo = uMid + 1;                                               \
+      else                                                             \
+      {                                                                \
+         *puIndex = uMid;                                              \
+         return 1;                                                     \
+      }                                                                \
+   }                                                                   \
+   *puIndex = uLo;                                                     \
+   return 0;                                                           \
+}                                                                      \
+                                                                       \
+/* Sort the uLength elements at ptArray with insertion sort. */       \
+static inline void Prefix##_insertionSort(Type *ptArray,               \
+                                          size_t uLength)              \
+{                                                                      \
+   size_t uNext;                                                       \
+   size_t uHole;                                                       \
+   Type tElement;                                                      \
+                                                                       \
+   for (uNext = 1; uNext < uLength; uNext++)                           \
+   {                                                                   \
+      tElement = ptArray[uNext];                                       \
+      for (uHole = uNext;                                              \
+           uHole > 0                                                   \
+              && compareElements(tElement, ptArray[uHole - 1]) < 0;    \
+           uHole--)                                                    \
+         ptArray[uHole] = ptArray[uHole - 1];                          \
+      ptArray[uHole] = tElement;                                       \
+   }                                                                   \
+}                                                                      \
+                                                                       \
+/* Restore the max-heap order of the uLength elements at ptHeap,     \
+   whose subtrees below uRoot are already heaps. */                   \
+static inline void Prefix##_siftDown(Type *ptHeap, size_t uRoot,       \
+                                     size_t uLength)                   \
+{                                                                      \
+   Type tElement = ptHeap[uRoot];                                      \
+   size_t uChild;                                                      \
+                                                                       \
+   while (uRoot < uLength / 2)                                         \
+   {                                                                   \
+      uChild = 2 * uRoot + 1;                                          \
+      if (uChild + 1 < uLength                                         \
+          && compareElements(ptHeap[uChild], ptHeap[uChild + 1]) < 0)  \
+         uChild++;                                                     \
+      if (compareElements(tElement, ptHeap[uChild]) >= 0)              \
+         break;                                                        \
+      ptHeap[uRoot] = ptHeap[uChild];                                  \
+      uRoot = uChild;                                                  \
+   }                                                                   \
+   ptHeap[uRoot] = tElement;                                           \
+}                                                                      \
+                                                                       \
+/* Sort the uLength elements at ptArray with introsort, as            \
+   DynArray_sort does, allowing uDepthLimit levels of partitioning    \
+   before falling back to heapsort. */                                 \
+static inline void Prefix##_introsort(Type *ptArray, size_t uLength,   \
+                               size_t uDepthLimit)                     \
+{                                                                      \
+   size_t uRight;                                                      \
+   size_t uLeft;                                                       \
+   size_t uMid;                                                        \
+   size_t u;                                                           \
+   Type tPivot;                                                        \
+   Type tTemp;                                                         \
+                                                                       \
+   while (uLength > 16)                                                \
+   {                                                                   \
+      if (uDepthLimit == 0)                                            \
+      {                                                                \
+         for (u = uLength / 2; u > 0; u--)                             \
+            Prefix##_siftDown(ptArray, u - 1, uLength);                \
+         for (u = uLength - 1; u > 0; u--)                             \
+         {                                                             \
+            tTemp = ptArray[0]; ptArray[0] = ptArray[u];               \
+            ptArray[u] = tTemp;                                        \
+            Prefix##_siftDown(ptArray, 0, u);                          \
+         }                                                             \
+         return;                                                       \
+      }                                                                \
+      uDepthLimit--;                                                   \
+                                                                       \
+      /* Median-of-three pivot, with the outer two as sentinels. */   \
+      uMid = uLength / 2;                                              \
+      if (compareElements(ptArray[uMid], ptArray[0]) < 0)              \
+      {                                                                \
+         tTemp = ptArray[uMid]; ptArray[uMid] = ptArray[0];            \
+         ptArray[0] = tTemp;                                           \
+      }                                                                \
+      if (compareElements(ptArray[uLength - 1], ptArray[uMid]) < 0)    \
+      {                                                                \
+         tTemp = ptArray[uLength - 1];                                 \
+         ptArray[uLength - 1] = ptArray[uMid]; ptArray[uMid] = tTemp;  \
+         if (compareElements(ptArray[uMid], ptArray[0]) < 0)           \
+         {                                                             \
+            tTemp = ptArray[uMid]; ptArray[uMid] = ptArray[0];         \
+            ptArray[0] = tTemp;                                        \
+         }                                                             \
+      }                                                                \
+      tPivot = ptArray[uMid];                                          \
+                                                                       \
+      /* Partition so that ptArray[0...uLeft] <= tPivot <=            \
+         ptArray[uRight...uLength-1], with uLeft < uRight. */         \
+      uRight = 1;                                                      \
+      uLeft = uLength - 2;                                             \
+      while (uRight <= uLeft)                                          \
+      {                                                                \
+         while (compareElements(ptArray[uRight], tPivot) < 0)          \
+            uRight++;                                                  \
+         while (compareElements(tPivot, ptArray[uLeft]) < 0)           \
+            uLeft--;                                                   \
+         if (uRight <= uLeft)                                          \
+         {                                                             \
+            tTemp = ptArray[uRight]; ptArray[uRight] = ptArray[uLeft]; \
+            ptArray[uLeft] = tTemp;                                    \
+            uRight++;                                                  \
+            uLeft--;                                                   \
+         }                                                             \
+      }                                                                \
+                                                                       \
+      /* Recurse on the smaller side and loop on the larger. */       \
+      if (uLeft + 1 < uLength - uRight)                                \
+      {                                                                \
+         Prefix##_introsort(ptArray, uLeft + 1, uDepthLimit);          \
+         ptArray += uRight;                                            \
+         uLength -= uRight;                                            \
+      }                                                                \
+      else                                                             \
+      {                                                                \
+         Prefix##_introsort(ptArray + uRight, uLength - uRight,        \
+                            uDepthLimit);                              \
+         uLength = uLeft + 1;                                          \
+      }                                                                \
+   }                                                                   \
+   Prefix##_insertionSort(ptArray, uLength);                           \
+}                                                                      \
+                                                                       \
+static inline void Prefix##_sortElements(Type *ptElements,             \
+                                         size_t uCount)                \
+{                                                                      \
+   size_t uDepthLimit = 0;                                             \
+   size_t uLength;                                                     \
+                                                                       \
+   assert(ptElements != NULL || uCount == 0);                          \
+                                                                       \
+   for (uLength = uCount; uLength > 1; uLength /= 2)                   \
+      uDepthLimit += 2;                                                \
+   Prefix##_introsort(ptElements, uCount, uDepthLimit);                \
+}                                                                      \
+                                                                       \
+static inline void Prefix##_sort(Prefix##_T oArray)                    \
+{                                                                      \
+   assert(oArray != NULL);                                             \
+                                                                       \
+   Prefix##_sortElements(oArray->ptArray, oArray->uLength);            \
+}                                                                      \
+                                                                       \
+static inline int Prefix##_addAllSorted(Prefix##_T oArray,             \
+                                        const Type *ptElements,        \
+                                        size_t uCount)                 \
+{                                                                      \
+   size_t uOld;                                                        \
+   size_t uNew;                                                        \
+   size_t uOut;                                                        \
+                                                                       \
+   assert(oArray != NULL);                                             \
+   assert(ptElements != NULL || uCount == 0);                          \
+                                                                       \
+   if (uCount == 0)                                                    \
+      return 1;                                                        \
+   if (! Prefix##_reserve(oArray, oArray->uLength + uCount))           \
+      return 0;                                                        \
+                                                                       \
+   /* Merge from the back; on ties the old element stays first. */    \
+   uOld = oArray->uLength;                                             \
+   uNew = uCount;                                                      \
+   uOut = uOld + uNew;                                                 \
+   while (uNew > 0)                                                    \
+   {                                                                   \
+      if (uOld > 0                                                     \
+          && compareElements(oArray->ptArray[uOld - 1],                \
+                             ptElements[uNew - 1]) > 0)                \
+         oArray->ptArray[--uOut] = oArray->ptArray[--uOld];            \
+      else                                                             \
+         oArray->ptArray[--uOut] = ptElements[--uNew];                 \
+   }                                                                   \
+   oArray->uLength += uCount;                                          \
+   return 1;                                                           \
+}
+
+#endif